@@ -0,0 +1,297 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "ObjGenerator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+namespace obj2ramses
+{
+    namespace
+    {
+        /* splitmix64, so files are identical on every platform */
+        class Random
+        {
+        public:
+            explicit Random(uint64_t seed)
+                : m_state(seed)
+            {
+            }
+
+            uint64_t next()
+            {
+                uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                return z ^ (z >> 31);
+            }
+
+            /* uniform in [0, 1) */
+            double nextDouble()
+            {
+                return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+            }
+
+        private:
+            uint64_t m_state;
+        };
+
+        class BufferedWriter
+        {
+        public:
+            explicit BufferedWriter(std::FILE* file)
+                : m_file(file)
+            {
+                m_buffer.reserve(BufferSize);
+            }
+
+            ~BufferedWriter()
+            {
+                flush();
+            }
+
+            void put(char c)
+            {
+                m_buffer.push_back(c);
+                if (m_buffer.size() >= BufferSize)
+                    flush();
+            }
+
+            void put(const char* text)
+            {
+                while (*text)
+                    put(*text++);
+            }
+
+            void putUnsigned(uint64_t value)
+            {
+                char digits[20];
+                size_t count = 0;
+                do
+                {
+                    digits[count++] = static_cast<char>('0' + value % 10);
+                    value /= 10;
+                } while (value > 0);
+                while (count > 0)
+                    put(digits[--count]);
+            }
+
+            /* fixed point with 4 decimals */
+            void putFloat(double value)
+            {
+                if (value < 0.0)
+                {
+                    put('-');
+                    value = -value;
+                }
+                const uint64_t scaled = static_cast<uint64_t>(value * 10000.0 + 0.5);
+                putUnsigned(scaled / 10000);
+                put('.');
+                const uint64_t fraction = scaled % 10000;
+                for (uint64_t divisor = 1000; divisor > 0; divisor /= 10)
+                    put(static_cast<char>('0' + (fraction / divisor) % 10));
+            }
+
+            void flush()
+            {
+                if (!m_buffer.empty())
+                    m_written += std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+                m_buffer.clear();
+            }
+
+            uint64_t getWritten() const
+            {
+                return m_written;
+            }
+
+        private:
+            static const size_t BufferSize = 1u << 20;
+
+            std::FILE* m_file;
+            std::vector<char> m_buffer;
+            uint64_t m_written = 0;
+        };
+
+        enum ECornerFormat
+        {
+            ECornerFormat_Position = 0,
+            ECornerFormat_TexCoord,
+            ECornerFormat_Normal,
+            ECornerFormat_TexCoordNormal
+        };
+
+        void writeCorner(BufferedWriter& writer, uint64_t vertex, ECornerFormat format)
+        {
+            // all attributes are stored per grid point, so one index works for all of them
+            const uint64_t index = vertex + 1;
+            writer.put(' ');
+            writer.putUnsigned(index);
+            switch (format)
+            {
+            case ECornerFormat_Position:
+                break;
+            case ECornerFormat_TexCoord:
+                writer.put('/');
+                writer.putUnsigned(index);
+                break;
+            case ECornerFormat_Normal:
+                writer.put("//");
+                writer.putUnsigned(index);
+                break;
+            case ECornerFormat_TexCoordNormal:
+                writer.put('/');
+                writer.putUnsigned(index);
+                writer.put('/');
+                writer.putUnsigned(index);
+                break;
+            }
+        }
+    }
+
+    ObjGenerator::ObjGenerator(const ObjGeneratorConfig& config)
+        : m_config(config)
+    {
+    }
+
+    uint64_t ObjGenerator::write(const std::string& fileName) const
+    {
+        const unsigned weights[] = { m_config.weightPosition, m_config.weightTexCoord, m_config.weightNormal, m_config.weightTexCoordNormal };
+        const unsigned totalWeight = weights[0] + weights[1] + weights[2] + weights[3];
+        if (0 == totalWeight)
+        {
+            std::cerr << "At least one face format needs a weight" << std::endl;
+            return 0;
+        }
+
+        std::FILE* file = std::fopen(fileName.c_str(), "wb");
+        if (nullptr == file)
+        {
+            std::cerr << "Cannot create " << fileName << std::endl;
+            return 0;
+        }
+
+        // roughly square grid of cells, one face per cell; hexagons span two cells
+        const uint64_t faceCount = std::max<uint64_t>(m_config.faceCount, 1u);
+        const uint64_t columns = std::max<uint64_t>(2u, static_cast<uint64_t>(std::ceil(std::sqrt(static_cast<double>(faceCount)))));
+        const uint64_t rows = (faceCount + columns - 1) / columns;
+        const uint64_t pointsPerRow = columns + 1;
+
+        Random random(m_config.seed);
+        uint64_t bytesWritten = 0;
+        {
+            BufferedWriter writer(file);
+            writer.put("# obj2ramses-bench synthetic mesh, ");
+            writer.putUnsigned(faceCount);
+            writer.put(" faces\n");
+
+            for (uint64_t row = 0; row <= rows; ++row)
+                for (uint64_t column = 0; column <= columns; ++column)
+                {
+                    writer.put("v ");
+                    writer.putFloat(0.01 * static_cast<double>(column));
+                    writer.put(' ');
+                    writer.putFloat(0.05 * random.nextDouble());
+                    writer.put(' ');
+                    writer.putFloat(0.01 * static_cast<double>(row));
+                    writer.put('\n');
+                }
+
+            for (uint64_t row = 0; row <= rows; ++row)
+                for (uint64_t column = 0; column <= columns; ++column)
+                {
+                    writer.put("vt ");
+                    writer.putFloat(static_cast<double>(column) / static_cast<double>(columns));
+                    writer.put(' ');
+                    writer.putFloat(static_cast<double>(row) / static_cast<double>(rows));
+                    writer.put('\n');
+                }
+
+            for (uint64_t row = 0; row <= rows; ++row)
+                for (uint64_t column = 0; column <= columns; ++column)
+                {
+                    const double dx = 0.2 * (random.nextDouble() - 0.5);
+                    const double dz = 0.2 * (random.nextDouble() - 0.5);
+                    const double length = std::sqrt(dx * dx + 1.0 + dz * dz);
+                    writer.put("vn ");
+                    writer.putFloat(dx / length);
+                    writer.put(' ');
+                    writer.putFloat(1.0 / length);
+                    writer.put(' ');
+                    writer.putFloat(dz / length);
+                    writer.put('\n');
+                }
+
+            for (uint64_t face = 0; face < faceCount; ++face)
+            {
+                if (random.nextDouble() < m_config.commentRatio)
+                {
+                    writer.put("# face ");
+                    writer.putUnsigned(face);
+                    writer.put('\n');
+                }
+
+                unsigned pick = static_cast<unsigned>(random.next() % totalWeight);
+                unsigned format = 0;
+                while (pick >= weights[format])
+                    pick -= weights[format++];
+
+                const uint64_t row = face / columns;
+                // hexagons need the neighbor cell as well
+                const uint64_t column = std::min(face % columns, columns - 2);
+                const uint64_t p00 = row * pointsPerRow + column;
+                const uint64_t p10 = p00 + 1;
+                const uint64_t p20 = p00 + 2;
+                const uint64_t p01 = p00 + pointsPerRow;
+                const uint64_t p11 = p01 + 1;
+                const uint64_t p21 = p01 + 2;
+
+                const uint64_t triangle[] = { p00, p10, p11 };
+                const uint64_t quad[] = { p00, p10, p11, p01 };
+                const uint64_t hexagon[] = { p00, p10, p20, p21, p11, p01 };
+
+                const uint64_t* corners = triangle;
+                size_t cornerCount = 3;
+                if (random.nextDouble() < m_config.ngonRatio)
+                {
+                    if (random.next() & 1u)
+                    {
+                        corners = quad;
+                        cornerCount = 4;
+                    }
+                    else
+                    {
+                        corners = hexagon;
+                        cornerCount = 6;
+                    }
+                }
+
+                writer.put('f');
+                for (size_t i = 0; i < cornerCount; ++i)
+                    writeCorner(writer, corners[i], static_cast<ECornerFormat>(format));
+                writer.put('\n');
+            }
+
+            writer.flush();
+            bytesWritten = writer.getWritten();
+        }
+
+        const bool failed = 0 != std::ferror(file);
+        std::fclose(file);
+        if (failed)
+        {
+            std::cerr << "Writing " << fileName << " failed" << std::endl;
+            return 0;
+        }
+
+        return bytesWritten;
+    }
+}
@@ -0,0 +1,56 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_OBJGENERATOR
+#define OBJ2RAMSES_OBJGENERATOR
+
+#include <string>
+#include <cstdint>
+
+namespace obj2ramses
+{
+    struct ObjGeneratorConfig
+    {
+        uint64_t faceCount = 1000;
+
+        /* relative weights of the face corner formats v, v/vt, v//vn and v/vt/vn */
+        unsigned weightPosition = 1;
+        unsigned weightTexCoord = 0;
+        unsigned weightNormal = 0;
+        unsigned weightTexCoordNormal = 1;
+
+        /* fraction of faces which are quads or hexagons instead of triangles */
+        double ngonRatio = 0.0;
+        /* comment lines per face */
+        double commentRatio = 0.0;
+
+        uint32_t seed = 1u;
+    };
+
+    /**
+     * @brief Writes synthetic OBJ files of arbitrary size for benchmarks.
+     *
+     * The mesh is a height field grid with one position, texture coordinate and normal per grid
+     * point, faces cover neighboring grid cells, so vertices are shared like in real meshes.
+     * The output only depends on the configuration: the generator uses its own random numbers
+     * and number formatting, independent of the standard library and the locale.
+     */
+    class ObjGenerator
+    {
+    public:
+        explicit ObjGenerator(const ObjGeneratorConfig& config);
+
+        /* returns the number of bytes written, 0 on failure */
+        uint64_t write(const std::string& fileName) const;
+
+    private:
+        const ObjGeneratorConfig m_config;
+    };
+}
+
+#endif
@@ -0,0 +1,392 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "ObjGenerator.h"
+#include "ObjImporter.h"
+#include "ObjParser.h"
+#include "MappedFile.h"
+#include "FileUtils.h"
+#include "JsonWriter.h"
+#include "MemoryArena.h"
+#include "Profiler.h"
+
+#include "ramses-client-api/Scene.h"
+#include "ramses-client-api/RamsesClient.h"
+#include "ramses-framework-api/RamsesFramework.h"
+#include "ramses-framework-api/RamsesVersion.h"
+#include "Utils/RamsesLogger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct BenchmarkOptions
+    {
+        std::vector<uint64_t> faceCounts = { 1000u, 10000u, 100000u, 1000000u };
+        unsigned iterations = 3;
+        /* threads used by importFromFile */
+        unsigned threadCount = 1;
+        std::string dataDirectory = "bench-data";
+        std::string outputFile = "bench-results.json";
+        obj2ramses::ObjGeneratorConfig generator;
+    };
+
+    struct Measurement
+    {
+        std::string benchmark;
+        uint64_t faceCount = 0;
+        uint64_t fileBytes = 0;
+        /* processed elements per iteration, e.g. faces, tokens or indices */
+        uint64_t items = 0;
+        std::vector<double> milliseconds;
+        /* peak resident set size of the process after the measurement */
+        uint64_t peakRssBytes = 0;
+    };
+
+    /* parses counts like 1000, 10K or 50M */
+    bool parseCount(const char* text, uint64_t& count)
+    {
+        char* end = nullptr;
+        const unsigned long long parsed = std::strtoull(text, &end, 10);
+        if (end == text || '-' == text[0])
+            return false;
+
+        uint64_t multiplier = 1u;
+        if ('K' == *end || 'k' == *end)
+            multiplier = 1000u;
+        else if ('M' == *end || 'm' == *end)
+            multiplier = 1000000u;
+        if (multiplier > 1u)
+            ++end;
+
+        count = parsed * multiplier;
+        return '\0' == *end;
+    }
+
+    bool parseRatio(const char* text, double& ratio)
+    {
+        char* end = nullptr;
+        ratio = std::strtod(text, &end);
+        return end != text && '\0' == *end && ratio >= 0.0 && ratio <= 1.0;
+    }
+
+    bool parseList(const std::string& text, std::vector<std::string>& items)
+    {
+        size_t begin = 0;
+        while (begin <= text.size())
+        {
+            const size_t end = std::min(text.find(',', begin), text.size());
+            if (end == begin)
+                return false;
+            items.push_back(text.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        return true;
+    }
+
+    /* v:1,vt:0,vn:0,vtvn:1 */
+    bool parseMix(const std::string& text, obj2ramses::ObjGeneratorConfig& config)
+    {
+        std::vector<std::string> items;
+        if (!parseList(text, items))
+            return false;
+
+        config.weightPosition = config.weightTexCoord = config.weightNormal = config.weightTexCoordNormal = 0;
+        for (const auto& item : items)
+        {
+            const size_t colon = item.find(':');
+            uint64_t weight = 0;
+            if (std::string::npos == colon || !parseCount(item.c_str() + colon + 1, weight))
+                return false;
+
+            const std::string format = item.substr(0, colon);
+            if ("v" == format)
+                config.weightPosition = static_cast<unsigned>(weight);
+            else if ("vt" == format)
+                config.weightTexCoord = static_cast<unsigned>(weight);
+            else if ("vn" == format)
+                config.weightNormal = static_cast<unsigned>(weight);
+            else if ("vtvn" == format)
+                config.weightTexCoordNormal = static_cast<unsigned>(weight);
+            else
+                return false;
+        }
+        return true;
+    }
+
+    bool parseOptions(int argc, char* argv[], BenchmarkOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            const char* value = argv[++i];
+
+            bool valid = true;
+            uint64_t count = 0;
+            if ("--faces" == arg)
+            {
+                std::vector<std::string> items;
+                options.faceCounts.clear();
+                valid = parseList(value, items);
+                for (const auto& item : items)
+                {
+                    valid = valid && parseCount(item.c_str(), count) && count > 0;
+                    options.faceCounts.push_back(count);
+                }
+            }
+            else if ("--mix" == arg)
+                valid = parseMix(value, options.generator);
+            else if ("--ngons" == arg)
+                valid = parseRatio(value, options.generator.ngonRatio);
+            else if ("--comments" == arg)
+                valid = parseRatio(value, options.generator.commentRatio);
+            else if ("--seed" == arg)
+            {
+                valid = parseCount(value, count);
+                options.generator.seed = static_cast<uint32_t>(count);
+            }
+            else if ("--iterations" == arg)
+            {
+                valid = parseCount(value, count) && count > 0;
+                options.iterations = static_cast<unsigned>(count);
+            }
+            else if ("--threads" == arg)
+            {
+                valid = parseCount(value, count);
+                options.threadCount = static_cast<unsigned>(count);
+            }
+            else if ("--data-dir" == arg)
+                options.dataDirectory = value;
+            else if ("--output" == arg || "-o" == arg)
+                options.outputFile = value;
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl
+                          << "Usage: obj2ramses-bench [--faces 1K,10K,1M] [--mix v:1,vt:0,vn:0,vtvn:1] [--ngons ratio] [--comments ratio]" << std::endl
+                          << "                        [--seed n] [--iterations n] [--threads n] [--data-dir dir] [--output file.json]" << std::endl;
+                return false;
+            }
+
+            if (!valid)
+            {
+                std::cerr << "Invalid value '" << value << "' for " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /* the importer reports its progress on std::cout, which is not part of the measurement */
+    class SilencedOutput
+    {
+    public:
+        SilencedOutput()
+            : m_previous(std::cout.rdbuf(nullptr))
+        {
+        }
+
+        ~SilencedOutput()
+        {
+            std::cout.rdbuf(m_previous);
+        }
+
+    private:
+        std::streambuf* m_previous;
+    };
+
+    Measurement measure(const std::string& benchmark, unsigned iterations, const std::function<uint64_t()>& run)
+    {
+        Measurement measurement;
+        measurement.benchmark = benchmark;
+        for (unsigned i = 0; i < iterations; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            measurement.items = run();
+            measurement.milliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        measurement.peakRssBytes = obj2ramses::Profiler::GetPeakResidentSetSize();
+        return measurement;
+    }
+
+    double getMedian(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        const size_t middle = values.size() / 2;
+        return (values.size() % 2 == 1) ? values[middle] : 0.5 * (values[middle - 1] + values[middle]);
+    }
+
+    void writeMeasurement(obj2ramses::JsonWriter& json, const Measurement& measurement)
+    {
+        const double minimum = *std::min_element(measurement.milliseconds.begin(), measurement.milliseconds.end());
+        const double mean = std::accumulate(measurement.milliseconds.begin(), measurement.milliseconds.end(), 0.0) / static_cast<double>(measurement.milliseconds.size());
+        const double median = getMedian(measurement.milliseconds);
+
+        json.beginObject();
+        json.key("benchmark").value(measurement.benchmark);
+        json.key("faces").value(measurement.faceCount);
+        json.key("fileBytes").value(measurement.fileBytes);
+        json.key("items").value(measurement.items);
+        json.key("iterations").value(static_cast<uint64_t>(measurement.milliseconds.size()));
+        json.key("minMs").value(minimum);
+        json.key("medianMs").value(median);
+        json.key("meanMs").value(mean);
+        json.key("itemsPerSecond").value(median > 0.0 ? 1000.0 * static_cast<double>(measurement.items) / median : 0.0);
+        json.key("megabytesPerSecond").value(median > 0.0 ? 1000.0 * static_cast<double>(measurement.fileBytes) / median / (1024.0 * 1024.0) : 0.0);
+        json.key("peakRssBytes").value(measurement.peakRssBytes);
+        json.endObject();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    if (!obj2ramses::FileUtils::createDirectory(options.dataDirectory))
+        return 1;
+
+    // the importer needs a client and scene, even if importFromFile does not touch them
+    ramses::RamsesFrameworkConfig config(argc, argv);
+    ramses::RamsesFramework framework(config);
+    ramses::RamsesClient client("obj2ramses-bench", framework);
+    ramses::Scene* scene = client.createScene(1u);
+    ramses_internal::GetRamsesLogger().setLogLevelForAppenderType(ramses_internal::ELogAppenderType::Console, ramses_internal::ELogLevel::Error);
+
+    obj2ramses::ImportOptions importOptions;
+    importOptions.threadCount = options.threadCount;
+
+    // reused by all imports, like the arenas of the pool threads in a batch conversion
+    obj2ramses::MemoryArena arena;
+
+    std::vector<Measurement> measurements;
+    for (auto faceCount : options.faceCounts)
+    {
+        obj2ramses::ObjGeneratorConfig generatorConfig = options.generator;
+        generatorConfig.faceCount = faceCount;
+
+        const std::string objFile = obj2ramses::FileUtils::joinPath(options.dataDirectory, "bench_" + std::to_string(faceCount) + ".obj");
+        std::cout << "Generating " << objFile << std::endl;
+        const uint64_t fileBytes = obj2ramses::ObjGenerator(generatorConfig).write(objFile);
+        if (0 == fileBytes)
+            return 1;
+
+        std::vector<Measurement> results;
+
+        std::unique_ptr<obj2ramses::ObjImporter> importer;
+        results.push_back(measure("importFromFile", options.iterations, [&]() -> uint64_t
+        {
+            SilencedOutput silenced;
+            importer.reset(new obj2ramses::ObjImporter(client, *scene, importOptions, &arena));
+            if (!importer->importFromFile(objFile))
+                return 0u;
+            return faceCount;
+        }));
+
+        if (importer->getMeshes().empty())
+        {
+            std::cerr << "Importing " << objFile << " failed" << std::endl;
+            return 1;
+        }
+
+        obj2ramses::MappedFile file;
+        if (!file.open(objFile))
+            return 1;
+
+        results.push_back(measure("tokenize", options.iterations, [&]() -> uint64_t
+        {
+            obj2ramses::StringRange tokens[16];
+            uint64_t tokenCount = 0;
+            const char* lineBegin = file.data();
+            const char* const fileEnd = file.data() + file.size();
+            while (lineBegin < fileEnd)
+            {
+                const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', static_cast<size_t>(fileEnd - lineBegin)));
+                if (nullptr == lineEnd)
+                    lineEnd = fileEnd;
+                tokenCount += obj2ramses::ObjParser::tokenize(obj2ramses::StringRange(lineBegin, lineEnd), tokens, 16);
+                lineBegin = lineEnd + 1;
+            }
+            return tokenCount;
+        }));
+
+        const auto& meshes = importer->getMeshes();
+        results.push_back(measure("getIndexArray", options.iterations, [&]() -> uint64_t
+        {
+            uint64_t indexCount = 0;
+            for (const auto& mesh : meshes)
+                indexCount += obj2ramses::ObjImporter::getIndexArray(mesh).size();
+            return indexCount;
+        }));
+
+        results.push_back(measure("getVertexArray", options.iterations, [&]() -> uint64_t
+        {
+            uint64_t vertexCount = 0;
+            for (const auto& mesh : meshes)
+                vertexCount += obj2ramses::ObjImporter::getVertexArray(mesh).size() / 3;
+            return vertexCount;
+        }));
+
+        for (auto& result : results)
+        {
+            result.faceCount = faceCount;
+            result.fileBytes = ("importFromFile" == result.benchmark || "tokenize" == result.benchmark) ? fileBytes : 0u;
+            std::cout << "  " << result.benchmark << ": " << getMedian(result.milliseconds) << " ms" << std::endl;
+            measurements.push_back(result);
+        }
+    }
+
+    std::ofstream output(options.outputFile);
+    obj2ramses::JsonWriter json(output);
+    json.beginObject();
+    json.key("tool").value("obj2ramses-bench");
+    json.key("ramsesVersion").value(ramses::GetRamsesVersion().string);
+    json.key("iterations").value(options.iterations);
+    json.key("threads").value(options.threadCount);
+
+    json.key("generator").beginObject();
+    json.key("seed").value(options.generator.seed);
+    json.key("weightV").value(options.generator.weightPosition);
+    json.key("weightVVt").value(options.generator.weightTexCoord);
+    json.key("weightVVn").value(options.generator.weightNormal);
+    json.key("weightVVtVn").value(options.generator.weightTexCoordNormal);
+    json.key("ngonRatio").value(options.generator.ngonRatio);
+    json.key("commentRatio").value(options.generator.commentRatio);
+    json.endObject();
+
+    json.key("results").beginArray();
+    for (const auto& measurement : measurements)
+        writeMeasurement(json, measurement);
+    json.endArray();
+    json.endObject();
+    output << std::endl;
+
+    if (!output)
+    {
+        std::cerr << "Writing " << options.outputFile << " failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Results written to " << options.outputFile << std::endl;
+    return 0;
+}
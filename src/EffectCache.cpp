@@ -0,0 +1,178 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "EffectCache.h"
+#include "GeometryCache.h"
+#include "FileUtils.h"
+
+#include <iostream>
+
+#include "ramses-client-api/RamsesClient.h"
+#include "ramses-client-api/Effect.h"
+#include "ramses-client-api/EffectDescription.h"
+#include "ramses-client-api/ResourceFileDescription.h"
+#include "ramses-framework-api/RamsesVersion.h"
+#include "ramses-utils.h"
+
+namespace obj2ramses
+{
+    namespace
+    {
+        const char EntryExtension[] = ".o2re";
+
+        /* the length is hashed as well, so "ab" + "c" and "a" + "bc" give different keys */
+        uint64_t hashString(const std::string& value, uint64_t seed)
+        {
+            const uint64_t length = value.size();
+            return GeometryCache::Hash(value.data(), value.size(), GeometryCache::Hash(&length, sizeof(length), seed));
+        }
+
+        std::string toHex(uint64_t value)
+        {
+            static const char Digits[] = "0123456789abcdef";
+            std::string hex(16, '0');
+            for (size_t i = 0; i < 16; ++i)
+                hex[15 - i] = Digits[(value >> (4 * i)) & 0xf];
+            return hex;
+        }
+    }
+
+    EffectCache::EffectCache(ramses::RamsesClient& client, const std::string& directory)
+        : m_client(client)
+        , m_directory(directory)
+    {
+    }
+
+    uint64_t EffectCache::ComputeKey(const EffectSource& source)
+    {
+        // compiled effects of another RAMSES version may not be loadable
+        uint64_t key = hashString(ramses::GetRamsesVersion().string, 0u);
+        key = hashString(source.vertexShader, key);
+        key = hashString(source.fragmentShader, key);
+        for (const auto& semantic : source.uniformSemantics)
+        {
+            const uint32_t value = static_cast<uint32_t>(semantic.second);
+            key = GeometryCache::Hash(&value, sizeof(value), hashString(semantic.first, key));
+        }
+        for (const auto& define : source.compilerDefines)
+            key = hashString(define, key);
+        return key;
+    }
+
+    const ramses::Effect* EffectCache::acquireEffect(const EffectSource& source, bool& cacheHit)
+    {
+        const std::string key = toHex(ComputeKey(source));
+        auto shared = m_effects.find(key);
+        if (shared != m_effects.end())
+        {
+            ++shared->second.users;
+            cacheHit = true;
+            return shared->second.effect;
+        }
+
+        // the name identifies the effect in the client after loading it
+        const std::string name = "effect_" + key;
+        const std::string entryFile = m_directory.empty() ? std::string() : FileUtils::joinPath(m_directory, key + EntryExtension);
+        const ramses::Effect* effect = entryFile.empty() ? nullptr : load(entryFile, name);
+        cacheHit = (nullptr != effect);
+        if (nullptr == effect)
+        {
+            effect = compile(source, name);
+            if (nullptr == effect)
+                return nullptr;
+            if (!entryFile.empty())
+                store(*effect, entryFile);
+        }
+
+        SharedEffect& added = m_effects[key];
+        added.effect = effect;
+        added.users = 1;
+        return effect;
+    }
+
+    void EffectCache::releaseEffect(const ramses::Effect& effect)
+    {
+        for (auto shared = m_effects.begin(); shared != m_effects.end(); ++shared)
+        {
+            if (shared->second.effect != &effect)
+                continue;
+
+            if (0 == --shared->second.users)
+            {
+                m_client.destroy(effect);
+                m_effects.erase(shared);
+            }
+            return;
+        }
+    }
+
+    const ramses::Effect* EffectCache::compile(const EffectSource& source, const std::string& name) const
+    {
+        ramses::EffectDescription effectDesc;
+        effectDesc.setVertexShader(source.vertexShader.c_str());
+        effectDesc.setFragmentShader(source.fragmentShader.c_str());
+        for (const auto& semantic : source.uniformSemantics)
+            effectDesc.setUniformSemantic(semantic.first.c_str(), semantic.second);
+        for (const auto& define : source.compilerDefines)
+            effectDesc.addCompilerDefine(define.c_str());
+
+        const ramses::Effect* effect = m_client.createEffect(effectDesc, ramses::ResourceCacheFlag_DoNotCache, name.c_str());
+        if (nullptr == effect)
+            std::cerr << "Cannot compile effect " << name << std::endl;
+        return effect;
+    }
+
+    const ramses::Effect* EffectCache::find(const std::string& name) const
+    {
+        const ramses::RamsesObject* object = m_client.findObjectByName(name.c_str());
+        return (nullptr != object) ? ramses::RamsesUtils::TryConvert<ramses::Effect>(*object) : nullptr;
+    }
+
+    const ramses::Effect* EffectCache::load(const std::string& entryFile, const std::string& name) const
+    {
+        if (0 == FileUtils::getFileSize(entryFile))
+            return nullptr;
+
+        ramses::ResourceFileDescription resourceFile(entryFile.c_str());
+        const ramses::Effect* effect = (ramses::StatusOK == m_client.loadResources(resourceFile)) ? find(name) : nullptr;
+        if (nullptr == effect)
+        {
+            std::cerr << "Ignoring invalid effect cache entry " << entryFile << std::endl;
+            return nullptr;
+        }
+
+        // the modification time is the last use, like for geometry cache entries
+        FileUtils::touchFile(entryFile);
+        return effect;
+    }
+
+    void EffectCache::store(const ramses::Effect& effect, const std::string& entryFile) const
+    {
+        if (!FileUtils::createDirectory(m_directory))
+            return;
+
+        // write to a private file and rename it, so concurrent runs never load a partial entry
+        const std::string temporaryFile = FileUtils::getTemporaryFile(entryFile);
+        ramses::ResourceFileDescription resourceFile(temporaryFile.c_str());
+        resourceFile.add(&effect);
+
+        const ramses::status_t status = m_client.saveResources(resourceFile, false);
+        if (ramses::StatusOK != status)
+        {
+            std::cerr << "Cannot write effect cache entry " << temporaryFile << ": " << m_client.getStatusMessage(status) << std::endl;
+            FileUtils::removeFile(temporaryFile);
+            return;
+        }
+
+        if (!FileUtils::renameFile(temporaryFile, entryFile))
+        {
+            std::cerr << "Cannot write effect cache entry " << entryFile << std::endl;
+            FileUtils::removeFile(temporaryFile);
+        }
+    }
+}
@@ -0,0 +1,214 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "FileUtils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <functional>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <dirent.h>
+#include <utime.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#endif
+
+namespace obj2ramses
+{
+    namespace FileUtils
+    {
+        namespace
+        {
+            bool endsWith(const std::string& text, const std::string& suffix)
+            {
+                return text.size() >= suffix.size() && 0 == text.compare(text.size() - suffix.size(), suffix.size(), suffix);
+            }
+        }
+
+        bool isDirectory(const std::string& path)
+        {
+#if defined(_WIN32)
+            const DWORD attributes = GetFileAttributesA(path.c_str());
+            return INVALID_FILE_ATTRIBUTES != attributes && 0 != (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+            struct stat status;
+            return 0 == stat(path.c_str(), &status) && S_ISDIR(status.st_mode);
+#endif
+        }
+
+        uint64_t getFileSize(const std::string& path)
+        {
+#if defined(_WIN32)
+            WIN32_FILE_ATTRIBUTE_DATA data;
+            if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data))
+                return 0;
+            return (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+#else
+            struct stat status;
+            if (0 != stat(path.c_str(), &status))
+                return 0;
+            return static_cast<uint64_t>(status.st_size);
+#endif
+        }
+
+        int64_t getModificationTime(const std::string& path)
+        {
+#if defined(_WIN32)
+            WIN32_FILE_ATTRIBUTE_DATA data;
+            if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data))
+                return 0;
+            // 100 ns intervals since 1601
+            const uint64_t ticks = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+            return static_cast<int64_t>(ticks / 10000000u) - 11644473600ll;
+#else
+            struct stat status;
+            if (0 != stat(path.c_str(), &status))
+                return 0;
+            return static_cast<int64_t>(status.st_mtime);
+#endif
+        }
+
+        bool touchFile(const std::string& path)
+        {
+#if defined(_WIN32)
+            HANDLE file = CreateFileA(path.c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (INVALID_HANDLE_VALUE == file)
+                return false;
+            FILETIME now;
+            GetSystemTimeAsFileTime(&now);
+            const bool touched = 0 != SetFileTime(file, nullptr, nullptr, &now);
+            CloseHandle(file);
+            return touched;
+#else
+            return 0 == utime(path.c_str(), nullptr);
+#endif
+        }
+
+        bool createDirectory(const std::string& path)
+        {
+#if defined(_WIN32)
+            if (CreateDirectoryA(path.c_str(), nullptr) || isDirectory(path))
+                return true;
+#else
+            if (0 == mkdir(path.c_str(), 0755) || (EEXIST == errno && isDirectory(path)))
+                return true;
+#endif
+            std::cerr << "Cannot create directory " << path << std::endl;
+            return false;
+        }
+
+        bool removeFile(const std::string& path)
+        {
+#if defined(_WIN32)
+            return 0 != DeleteFileA(path.c_str());
+#else
+            return 0 == std::remove(path.c_str());
+#endif
+        }
+
+        bool renameFile(const std::string& source, const std::string& destination)
+        {
+#if defined(_WIN32)
+            return 0 != MoveFileExA(source.c_str(), destination.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+            return 0 == std::rename(source.c_str(), destination.c_str());
+#endif
+        }
+
+        std::string getTemporaryFile(const std::string& path)
+        {
+#if defined(_WIN32)
+            const unsigned long processId = GetCurrentProcessId();
+#else
+            const long processId = static_cast<long>(getpid());
+#endif
+            return path + ".tmp" + std::to_string(processId) + "-" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        }
+
+        bool listFiles(const std::string& directory, const std::string& extension, std::vector<std::string>& files)
+        {
+            std::vector<std::string> found;
+
+#if defined(_WIN32)
+            WIN32_FIND_DATAA data;
+            HANDLE search = FindFirstFileA(joinPath(directory, "*").c_str(), &data);
+            if (INVALID_HANDLE_VALUE == search)
+            {
+                std::cerr << "Cannot list directory " << directory << std::endl;
+                return false;
+            }
+            do
+            {
+                if (0 == (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && endsWith(data.cFileName, extension))
+                    found.push_back(joinPath(directory, data.cFileName));
+            } while (FindNextFileA(search, &data));
+            FindClose(search);
+#else
+            DIR* dir = opendir(directory.c_str());
+            if (nullptr == dir)
+            {
+                std::cerr << "Cannot list directory " << directory << std::endl;
+                return false;
+            }
+            while (const dirent* entry = readdir(dir))
+            {
+                const std::string path = joinPath(directory, entry->d_name);
+                struct stat status;
+                if (endsWith(entry->d_name, extension) && 0 == stat(path.c_str(), &status) && S_ISREG(status.st_mode))
+                    found.push_back(path);
+            }
+            closedir(dir);
+#endif
+
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+            return true;
+        }
+
+        std::string getStem(const std::string& path)
+        {
+            const size_t nameBegin = path.find_last_of("/\\") + 1;
+            const size_t dot = path.rfind('.');
+            const size_t stemEnd = (dot == std::string::npos || dot < nameBegin) ? path.size() : dot;
+            return path.substr(nameBegin, stemEnd - nameBegin);
+        }
+
+        std::string replaceExtension(const std::string& path, const std::string& extension)
+        {
+            const size_t nameBegin = path.find_last_of("/\\") + 1;
+            const size_t dot = path.rfind('.');
+            const size_t stemEnd = (dot == std::string::npos || dot < nameBegin) ? path.size() : dot;
+            return path.substr(0, stemEnd) + extension;
+        }
+
+        std::string joinPath(const std::string& directory, const std::string& fileName)
+        {
+            if (directory.empty() || '/' == directory.back() || '\\' == directory.back())
+                return directory + fileName;
+            return directory + '/' + fileName;
+        }
+
+        std::string getDirectory(const std::string& path)
+        {
+            const size_t separator = path.find_last_of("/\\");
+            return (separator == std::string::npos) ? std::string() : path.substr(0, separator + 1);
+        }
+
+        std::string resolvePath(const std::string& directory, const std::string& path)
+        {
+            const bool absolute = (!path.empty() && ('/' == path[0] || '\\' == path[0])) || (path.size() > 1 && ':' == path[1]);
+            return absolute ? path : joinPath(directory, path);
+        }
+    }
+}
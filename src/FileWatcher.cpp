@@ -0,0 +1,88 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "FileWatcher.h"
+#include "FileUtils.h"
+
+#include <iostream>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace obj2ramses
+{
+    FileWatcher::FileWatcher(const std::string& file)
+        : m_file(file)
+        , m_modificationTime(FileUtils::getModificationTime(file))
+        , m_size(FileUtils::getFileSize(file))
+    {
+#if defined(__linux__)
+        const size_t nameBegin = file.find_last_of('/') + 1;
+        m_fileName = file.substr(nameBegin);
+        const std::string directory = (0 == nameBegin) ? std::string(".") : file.substr(0, nameBegin);
+
+        // only complete files: written and closed in place, or renamed over the file; not created but still empty
+        m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_inotify >= 0 && inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            close(m_inotify);
+            m_inotify = -1;
+        }
+        if (m_inotify < 0)
+            std::cerr << "Cannot watch " << directory << " with inotify (" << std::strerror(errno) << "), checking the modification time instead" << std::endl;
+#endif
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+#if defined(__linux__)
+        if (m_inotify >= 0)
+            close(m_inotify);
+#endif
+    }
+
+    bool FileWatcher::poll()
+    {
+#if defined(__linux__)
+        if (m_inotify >= 0)
+        {
+            // drain all pending events, a save usually produces several
+            bool changed = false;
+            alignas(inotify_event) char buffer[4096];
+            for (;;)
+            {
+                const ssize_t size = read(m_inotify, buffer, sizeof(buffer));
+                if (size <= 0)
+                    break;
+
+                for (ssize_t offset = 0; offset < size; )
+                {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                    if (event->len > 0 && m_fileName == event->name)
+                        changed = true;
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                }
+            }
+            return changed;
+        }
+#endif
+
+        const int64_t modificationTime = FileUtils::getModificationTime(m_file);
+        const uint64_t size = FileUtils::getFileSize(m_file);
+        if (modificationTime == m_modificationTime && size == m_size)
+            return false;
+
+        m_modificationTime = modificationTime;
+        m_size = size;
+        return true;
+    }
+}
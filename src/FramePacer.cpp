@@ -0,0 +1,39 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "FramePacer.h"
+
+#include <thread>
+
+namespace obj2ramses
+{
+    FramePacer::FramePacer(float framesPerSecond)
+        : m_period(framesPerSecond > 0.0f ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond)) : Clock::duration::zero())
+        , m_nextFrame(Clock::now())
+    {
+    }
+
+    void FramePacer::waitForNextFrame()
+    {
+        if (Clock::duration::zero() == m_period)
+        {
+            std::this_thread::yield();
+            return;
+        }
+
+        m_nextFrame += m_period;
+        const Clock::time_point now = Clock::now();
+        if (now >= m_nextFrame)
+        {
+            ++m_lateFrames;
+            m_nextFrame = now;
+            return;
+        }
+        std::this_thread::sleep_until(m_nextFrame);
+    }
+}
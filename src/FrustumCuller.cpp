@@ -0,0 +1,149 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "LodSwitcher.h"
+
+#include "ramses-client-api/MeshNode.h"
+#include "ramses-client-api/PerspectiveCamera.h"
+
+namespace obj2ramses
+{
+    FrustumCuller::FrustumCuller(const std::vector<ObjGeometry::indexed_mesh>& meshes, const std::vector<ramses::MeshNode*>& nodes)
+        : m_nodes(nodes)
+    {
+        m_nodes.resize(std::min(meshes.size(), nodes.size()));
+        m_bounds.resize(m_nodes.size());
+        m_visible.resize(m_nodes.size());
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            const ObjGeometry::indexed_mesh& mesh = meshes[i];
+            Bounds& bounds = m_bounds[i];
+            for (size_t k = 0; k < 3; ++k)
+                bounds.minimum[k] = bounds.maximum[k] = mesh.positions.empty() ? 0.0f : mesh.positions[k];
+            for (size_t k = 0; k < mesh.positions.size(); ++k)
+            {
+                bounds.minimum[k % 3] = std::min(bounds.minimum[k % 3], mesh.positions[k]);
+                bounds.maximum[k % 3] = std::max(bounds.maximum[k % 3], mesh.positions[k]);
+            }
+            // getRamsesRenderGroup hides all levels of detail except the full mesh
+            m_visible[i] = (0 == mesh.lod) ? 1u : 0u;
+        }
+    }
+
+    bool FrustumCuller::update(const ramses::PerspectiveCamera& camera, const LodSwitcher& lodSwitcher, bool selectionChanged)
+    {
+        float state[10];
+        camera.getTranslation(state[0], state[1], state[2]);
+        camera.getRotation(state[3], state[4], state[5]);
+        state[6] = camera.getVerticalFieldOfView();
+        state[7] = camera.getAspectRatio();
+        state[8] = camera.getNearPlane();
+        state[9] = camera.getFarPlane();
+        if (m_culled && !selectionChanged && 0 == std::memcmp(state, m_cameraState, sizeof(state)))
+            return false;
+
+        const auto start = std::chrono::steady_clock::now();
+        std::memcpy(m_cameraState, state, sizeof(state));
+        m_culled = true;
+        computeFrustum(camera);
+
+        m_statistics = CullStatistics();
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            if (!lodSwitcher.isSelected(i))
+            {
+                if (m_visible[i])
+                {
+                    m_nodes[i]->setVisibility(false);
+                    m_visible[i] = 0u;
+                    ++m_statistics.changedMeshes;
+                }
+                continue;
+            }
+
+            const bool inside = isInside(m_bounds[i]);
+            if (inside)
+                ++m_statistics.visibleMeshes;
+            else
+                ++m_statistics.culledMeshes;
+
+            if (inside != (0 != m_visible[i]))
+            {
+                m_nodes[i]->setVisibility(inside);
+                m_visible[i] = inside ? 1u : 0u;
+                ++m_statistics.changedMeshes;
+            }
+        }
+
+        m_statistics.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    void FrustumCuller::computeFrustum(const ramses::PerspectiveCamera& camera)
+    {
+        const float degreesToRadians = 3.14159265f / 180.0f;
+        float translation[3];
+        float rotation[3];
+        camera.getTranslation(translation[0], translation[1], translation[2]);
+        camera.getRotation(rotation[0], rotation[1], rotation[2]);
+
+        // camera to world rotation Rz * Ry * Rx
+        const float cx = std::cos(rotation[0] * degreesToRadians), sx = std::sin(rotation[0] * degreesToRadians);
+        const float cy = std::cos(rotation[1] * degreesToRadians), sy = std::sin(rotation[1] * degreesToRadians);
+        const float cz = std::cos(rotation[2] * degreesToRadians), sz = std::sin(rotation[2] * degreesToRadians);
+        const float r[3][3] = {
+            { cz * cy, cz * sy * sx - sz * cx, cz * sy * cx + sz * sx },
+            { sz * cy, sz * sy * sx + cz * cx, sz * sy * cx - cz * sx },
+            { -sy, cy * sx, cy * cx }
+        };
+
+        // the camera looks along -z, planes in camera space
+        const float tanVertical = std::tan(0.5f * camera.getVerticalFieldOfView() * degreesToRadians);
+        const float tanHorizontal = tanVertical * camera.getAspectRatio();
+        const Plane local[6] = {
+            { { 0.0f, 0.0f, -1.0f }, -camera.getNearPlane() },
+            { { 0.0f, 0.0f, 1.0f }, camera.getFarPlane() },
+            { { 1.0f, 0.0f, -tanHorizontal }, 0.0f },
+            { { -1.0f, 0.0f, -tanHorizontal }, 0.0f },
+            { { 0.0f, 1.0f, -tanVertical }, 0.0f },
+            { { 0.0f, -1.0f, -tanVertical }, 0.0f }
+        };
+
+        for (size_t i = 0; i < 6; ++i)
+        {
+            Plane& plane = m_planes[i];
+            plane.d = local[i].d;
+            for (size_t k = 0; k < 3; ++k)
+            {
+                plane.normal[k] = r[k][0] * local[i].normal[0] + r[k][1] * local[i].normal[1] + r[k][2] * local[i].normal[2];
+                plane.d -= plane.normal[k] * translation[k];
+            }
+        }
+    }
+
+    bool FrustumCuller::isInside(const Bounds& bounds) const
+    {
+        // the box is outside if its corner furthest along the inward normal is behind any plane
+        for (const auto& plane : m_planes)
+        {
+            float distance = plane.d;
+            for (size_t k = 0; k < 3; ++k)
+                distance += plane.normal[k] * ((plane.normal[k] >= 0.0f) ? bounds.maximum[k] : bounds.minimum[k]);
+            if (distance < 0.0f)
+                return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,392 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "GeometryCache.h"
+#include "MappedFile.h"
+#include "FileUtils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace obj2ramses
+{
+    namespace
+    {
+        const char EntryExtension[] = ".o2rg";
+        const char Magic[4] = { 'O', '2', 'R', 'G' };
+        const uint32_t FormatVersion = 3u;
+        const uint32_t ByteOrderMark = 0x01020304u;
+        const uint64_t Alignment = 16u;
+
+        enum EEntryFlag
+        {
+            EEntryFlag_UInt32Indices = 1u
+        };
+
+        struct EntryHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t byteOrder;
+            uint32_t flags;
+            uint64_t key;
+            uint64_t fileSize;
+            uint64_t meshCount;
+        };
+
+        /* offsets are relative to the file begin, 0 if the mesh has no such attribute */
+        struct MeshEntry
+        {
+            uint64_t vertexCount;
+            uint64_t indexCount;
+            uint64_t positionsOffset;
+            uint64_t texCoordsOffset;
+            uint64_t normalsOffset;
+            uint64_t indicesOffset;
+            /* mesh name and material, not null terminated */
+            uint64_t nameOffset;
+            uint64_t nameLength;
+            uint64_t materialOffset;
+            uint64_t materialLength;
+            uint32_t lod;
+            float lodError;
+        };
+
+        static_assert(sizeof(EntryHeader) == 40, "cache layout must not contain padding");
+        static_assert(sizeof(MeshEntry) == 88, "cache layout must not contain padding");
+
+        uint64_t align(uint64_t offset)
+        {
+            return (offset + Alignment - 1) & ~(Alignment - 1);
+        }
+
+        /* reserves an aligned block for an array of the given size and returns its offset */
+        uint64_t allocate(uint64_t& fileSize, uint64_t bytes)
+        {
+            if (0 == bytes)
+                return 0;
+            const uint64_t offset = fileSize;
+            fileSize = align(fileSize + bytes);
+            return offset;
+        }
+
+        void writeArray(std::ofstream& stream, uint64_t& position, uint64_t offset, const void* data, uint64_t bytes)
+        {
+            if (0 == bytes)
+                return;
+
+            static const char padding[Alignment] = {};
+            stream.write(padding, static_cast<std::streamsize>(offset - position));
+            stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            position = offset + bytes;
+        }
+
+        template <typename T>
+        bool readArray(const MappedFile& file, uint64_t offset, uint64_t count, std::vector<T>& values)
+        {
+            values.clear();
+            if (0 == offset)
+                return 0 == count;
+
+            if (offset % Alignment != 0 || offset > file.size() || count > (file.size() - offset) / sizeof(T))
+                return false;
+
+            const T* begin = reinterpret_cast<const T*>(file.data() + offset);
+            values.assign(begin, begin + count);
+            return true;
+        }
+
+        bool readString(const MappedFile& file, uint64_t offset, uint64_t length, std::string& value)
+        {
+            value.clear();
+            if (0 == offset)
+                return 0 == length;
+
+            if (offset > file.size() || length > file.size() - offset)
+                return false;
+
+            value.assign(file.data() + offset, static_cast<size_t>(length));
+            return true;
+        }
+
+        const uint64_t Prime1 = 11400714785074694791ull;
+        const uint64_t Prime2 = 14029467366897019727ull;
+        const uint64_t Prime3 = 1609587929392839161ull;
+        const uint64_t Prime4 = 9650029242287828579ull;
+        const uint64_t Prime5 = 2870177450012600261ull;
+
+        uint64_t rotateLeft(uint64_t value, unsigned bits)
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        uint64_t read64(const unsigned char* data)
+        {
+            uint64_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        uint32_t read32(const unsigned char* data)
+        {
+            uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        uint64_t hashRound(uint64_t accumulator, uint64_t input)
+        {
+            accumulator += input * Prime2;
+            accumulator = rotateLeft(accumulator, 31);
+            return accumulator * Prime1;
+        }
+
+        uint64_t mergeRound(uint64_t accumulator, uint64_t value)
+        {
+            accumulator ^= hashRound(0, value);
+            return accumulator * Prime1 + Prime4;
+        }
+    }
+
+    GeometryCache::GeometryCache(const std::string& directory, uint64_t sizeLimit, std::ostream& log)
+        : m_directory(directory)
+        , m_sizeLimit(sizeLimit)
+        , m_log(log)
+    {
+    }
+
+    uint64_t GeometryCache::Hash(const void* data, size_t size, uint64_t seed)
+    {
+        const unsigned char* input = static_cast<const unsigned char*>(data);
+        const unsigned char* const end = input + size;
+        uint64_t hash;
+
+        if (size >= 32)
+        {
+            // four independent lanes keep the multipliers busy
+            uint64_t lanes[4] = { seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 };
+            const unsigned char* const lastStripe = end - 32;
+            do
+            {
+                for (size_t i = 0; i < 4; ++i)
+                    lanes[i] = hashRound(lanes[i], read64(input + 8 * i));
+                input += 32;
+            } while (input <= lastStripe);
+
+            hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+            for (size_t i = 0; i < 4; ++i)
+                hash = mergeRound(hash, lanes[i]);
+        }
+        else
+        {
+            hash = seed + Prime5;
+        }
+
+        hash += size;
+
+        for (; input + 8 <= end; input += 8)
+        {
+            hash ^= hashRound(0, read64(input));
+            hash = rotateLeft(hash, 27) * Prime1 + Prime4;
+        }
+        if (input + 4 <= end)
+        {
+            hash ^= read32(input) * Prime1;
+            hash = rotateLeft(hash, 23) * Prime2 + Prime3;
+            input += 4;
+        }
+        for (; input < end; ++input)
+        {
+            hash ^= *input * Prime5;
+            hash = rotateLeft(hash, 11) * Prime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= Prime2;
+        hash ^= hash >> 29;
+        hash *= Prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    bool GeometryCache::load(uint64_t key, std::vector<ObjGeometry::indexed_mesh>& meshes, bool& use32BitIndices) const
+    {
+        const std::string entryFile = getEntryFile(key);
+        if (0 == FileUtils::getFileSize(entryFile))
+            return false;
+
+        MappedFile file;
+        if (!file.open(entryFile) || file.size() < sizeof(EntryHeader))
+            return false;
+
+        EntryHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (0 != std::memcmp(header.magic, Magic, sizeof(Magic)) || FormatVersion != header.version || ByteOrderMark != header.byteOrder
+            || key != header.key || file.size() != header.fileSize || header.meshCount > (file.size() - sizeof(header)) / sizeof(MeshEntry))
+        {
+            std::cerr << "Ignoring invalid geometry cache entry " << entryFile << std::endl;
+            return false;
+        }
+
+        std::vector<ObjGeometry::indexed_mesh> loaded(static_cast<size_t>(header.meshCount));
+        for (size_t i = 0; i < loaded.size(); ++i)
+        {
+            MeshEntry entry;
+            std::memcpy(&entry, file.data() + sizeof(header) + i * sizeof(MeshEntry), sizeof(entry));
+
+            ObjGeometry::indexed_mesh& mesh = loaded[i];
+            if (!readArray(file, entry.positionsOffset, 3 * entry.vertexCount, mesh.positions)
+                || !readArray(file, entry.texCoordsOffset, 0 == entry.texCoordsOffset ? 0 : 2 * entry.vertexCount, mesh.tex_coords)
+                || !readArray(file, entry.normalsOffset, 0 == entry.normalsOffset ? 0 : 3 * entry.vertexCount, mesh.normals)
+                || !readArray(file, entry.indicesOffset, entry.indexCount, mesh.indices)
+                || !readString(file, entry.nameOffset, entry.nameLength, mesh.name)
+                || !readString(file, entry.materialOffset, entry.materialLength, mesh.material))
+            {
+                std::cerr << "Ignoring invalid geometry cache entry " << entryFile << std::endl;
+                return false;
+            }
+            mesh.lod = entry.lod;
+            mesh.lod_error = entry.lodError;
+        }
+
+        meshes.swap(loaded);
+        use32BitIndices = 0 != (header.flags & EEntryFlag_UInt32Indices);
+
+        // the modification time is the last use for eviction
+        FileUtils::touchFile(entryFile);
+        return true;
+    }
+
+    bool GeometryCache::store(uint64_t key, const std::vector<ObjGeometry::indexed_mesh>& meshes, bool use32BitIndices) const
+    {
+        if (!FileUtils::createDirectory(m_directory))
+            return false;
+
+        EntryHeader header;
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = FormatVersion;
+        header.byteOrder = ByteOrderMark;
+        header.flags = use32BitIndices ? static_cast<uint32_t>(EEntryFlag_UInt32Indices) : 0u;
+        header.key = key;
+        header.meshCount = meshes.size();
+
+        uint64_t fileSize = align(sizeof(EntryHeader) + meshes.size() * sizeof(MeshEntry));
+        std::vector<MeshEntry> entries(meshes.size());
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            const ObjGeometry::indexed_mesh& mesh = meshes[i];
+            MeshEntry& entry = entries[i];
+            entry.vertexCount = mesh.vertex_count();
+            entry.indexCount = mesh.indices.size();
+            entry.positionsOffset = allocate(fileSize, mesh.positions.size() * sizeof(float));
+            entry.texCoordsOffset = allocate(fileSize, mesh.tex_coords.size() * sizeof(float));
+            entry.normalsOffset = allocate(fileSize, mesh.normals.size() * sizeof(float));
+            entry.indicesOffset = allocate(fileSize, mesh.indices.size() * sizeof(unsigned));
+            entry.nameOffset = allocate(fileSize, mesh.name.size());
+            entry.nameLength = mesh.name.size();
+            entry.materialOffset = allocate(fileSize, mesh.material.size());
+            entry.materialLength = mesh.material.size();
+            entry.lod = mesh.lod;
+            entry.lodError = mesh.lod_error;
+        }
+        header.fileSize = fileSize;
+
+        // write to a private file and rename it, so concurrent imports never see a partial entry
+        const std::string entryFile = getEntryFile(key);
+        const std::string temporaryFile = FileUtils::getTemporaryFile(entryFile);
+        {
+            std::ofstream stream(temporaryFile, std::ios::binary | std::ios::trunc);
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(MeshEntry)));
+
+            uint64_t position = sizeof(header) + entries.size() * sizeof(MeshEntry);
+            for (size_t i = 0; i < meshes.size(); ++i)
+            {
+                const ObjGeometry::indexed_mesh& mesh = meshes[i];
+                const MeshEntry& entry = entries[i];
+                writeArray(stream, position, entry.positionsOffset, mesh.positions.data(), mesh.positions.size() * sizeof(float));
+                writeArray(stream, position, entry.texCoordsOffset, mesh.tex_coords.data(), mesh.tex_coords.size() * sizeof(float));
+                writeArray(stream, position, entry.normalsOffset, mesh.normals.data(), mesh.normals.size() * sizeof(float));
+                writeArray(stream, position, entry.indicesOffset, mesh.indices.data(), mesh.indices.size() * sizeof(unsigned));
+                writeArray(stream, position, entry.nameOffset, mesh.name.data(), mesh.name.size());
+                writeArray(stream, position, entry.materialOffset, mesh.material.data(), mesh.material.size());
+            }
+            static const char padding[Alignment] = {};
+            stream.write(padding, static_cast<std::streamsize>(fileSize - position));
+
+            if (!stream)
+            {
+                std::cerr << "Cannot write geometry cache entry " << temporaryFile << std::endl;
+                stream.close();
+                FileUtils::removeFile(temporaryFile);
+                return false;
+            }
+        }
+
+        if (!FileUtils::renameFile(temporaryFile, entryFile))
+        {
+            std::cerr << "Cannot write geometry cache entry " << entryFile << std::endl;
+            FileUtils::removeFile(temporaryFile);
+            return false;
+        }
+
+        evict();
+        return true;
+    }
+
+    void GeometryCache::evict() const
+    {
+        if (0 == m_sizeLimit)
+            return;
+
+        struct Entry
+        {
+            std::string file;
+            uint64_t size;
+            int64_t lastUse;
+        };
+
+        std::vector<std::string> files;
+        if (!FileUtils::listFiles(m_directory, EntryExtension, files))
+            return;
+
+        std::vector<Entry> entries;
+        uint64_t cacheSize = 0;
+        for (const auto& file : files)
+        {
+            Entry entry = { file, FileUtils::getFileSize(file), FileUtils::getModificationTime(file) };
+            cacheSize += entry.size;
+            entries.push_back(entry);
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+
+        for (const auto& entry : entries)
+        {
+            if (cacheSize <= m_sizeLimit)
+                break;
+
+            if (FileUtils::removeFile(entry.file))
+            {
+                cacheSize -= entry.size;
+                m_log << "Evicted geometry cache entry " << entry.file << std::endl;
+            }
+        }
+    }
+
+    std::string GeometryCache::getEntryFile(uint64_t key) const
+    {
+        static const char Digits[] = "0123456789abcdef";
+        std::string name(16, '0');
+        for (size_t i = 0; i < 16; ++i)
+            name[15 - i] = Digits[(key >> (4 * i)) & 0xf];
+        return FileUtils::joinPath(m_directory, name + EntryExtension);
+    }
+}
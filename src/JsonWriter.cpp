@@ -0,0 +1,203 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "JsonWriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace obj2ramses
+{
+    JsonWriter::JsonWriter(std::ostream& stream, unsigned indent)
+        : m_stream(stream)
+        , m_indent(indent)
+    {
+    }
+
+    JsonWriter& JsonWriter::beginObject()
+    {
+        beginValue();
+        m_stream << '{';
+        m_scopes.push_back({ true, true });
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::endObject()
+    {
+        const bool isEmpty = m_scopes.back().isEmpty;
+        m_scopes.pop_back();
+        if (!isEmpty)
+            newLine();
+        m_stream << '}';
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::beginArray()
+    {
+        beginValue();
+        m_stream << '[';
+        m_scopes.push_back({ false, true });
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::endArray()
+    {
+        const bool isEmpty = m_scopes.back().isEmpty;
+        m_scopes.pop_back();
+        if (!isEmpty)
+            newLine();
+        m_stream << ']';
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::key(const std::string& name)
+    {
+        beginValue();
+        writeString(name);
+        m_stream << (m_indent > 0 ? ": " : ":");
+        m_afterKey = true;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(const std::string& text)
+    {
+        beginValue();
+        writeString(text);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(const char* text)
+    {
+        return value(std::string(text));
+    }
+
+    JsonWriter& JsonWriter::value(bool flag)
+    {
+        beginValue();
+        m_stream << (flag ? "true" : "false");
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(int64_t number)
+    {
+        beginValue();
+        m_stream << number;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(uint64_t number)
+    {
+        beginValue();
+        m_stream << number;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(int number)
+    {
+        return value(static_cast<int64_t>(number));
+    }
+
+    JsonWriter& JsonWriter::value(unsigned number)
+    {
+        return value(static_cast<uint64_t>(number));
+    }
+
+    JsonWriter& JsonWriter::value(double number)
+    {
+        // JSON has no representation for infinity and NaN
+        if (!std::isfinite(number))
+            return null();
+
+        // independent of the stream state
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.*g", static_cast<int>(m_precision), number);
+        beginValue();
+        m_stream << buffer;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::null()
+    {
+        beginValue();
+        m_stream << "null";
+        return *this;
+    }
+
+    void JsonWriter::setPrecision(unsigned digits)
+    {
+        m_precision = std::min(std::max(digits, 1u), 17u);
+    }
+
+    void JsonWriter::beginValue()
+    {
+        if (m_afterKey)
+        {
+            // the key already placed separator and indentation
+            m_afterKey = false;
+            return;
+        }
+
+        if (m_scopes.empty())
+            return;
+
+        Scope& scope = m_scopes.back();
+        if (!scope.isEmpty)
+            m_stream << ',';
+        scope.isEmpty = false;
+        newLine();
+    }
+
+    void JsonWriter::newLine()
+    {
+        if (0 == m_indent)
+            return;
+
+        m_stream << '\n';
+        for (size_t i = 0; i < m_scopes.size() * m_indent; ++i)
+            m_stream << ' ';
+    }
+
+    void JsonWriter::writeString(const std::string& text)
+    {
+        m_stream << '"';
+        for (char c : text)
+        {
+            switch (c)
+            {
+            case '"':
+                m_stream << "\\\"";
+                break;
+            case '\\':
+                m_stream << "\\\\";
+                break;
+            case '\n':
+                m_stream << "\\n";
+                break;
+            case '\r':
+                m_stream << "\\r";
+                break;
+            case '\t':
+                m_stream << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    m_stream << escaped;
+                }
+                else
+                {
+                    m_stream << c;
+                }
+            }
+        }
+        m_stream << '"';
+    }
+}
@@ -0,0 +1,97 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "LodSwitcher.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ramses-client-api/PerspectiveCamera.h"
+
+namespace obj2ramses
+{
+    LodSwitcher::LodSwitcher(const std::vector<ObjGeometry::indexed_mesh>& meshes, float pixelError)
+        : m_pixelError(pixelError)
+        , m_selected(meshes.size(), 0u)
+    {
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            const ObjGeometry::indexed_mesh& mesh = meshes[i];
+            if (0 != mesh.lod)
+            {
+                if (!m_meshes.empty())
+                    m_meshes.back().levels.push_back({ i, mesh.lod_error });
+                continue;
+            }
+            m_selected[i] = 1u;
+
+            // drop the previous mesh again if it has no coarser levels
+            if (!m_meshes.empty() && 1u == m_meshes.back().levels.size())
+                m_meshes.pop_back();
+
+            Mesh entry;
+            float minimum[3] = { 0.0f, 0.0f, 0.0f };
+            float maximum[3] = { 0.0f, 0.0f, 0.0f };
+            if (!mesh.positions.empty())
+            {
+                std::copy(mesh.positions.begin(), mesh.positions.begin() + 3, minimum);
+                std::copy(mesh.positions.begin(), mesh.positions.begin() + 3, maximum);
+            }
+            for (size_t k = 0; k < mesh.positions.size(); ++k)
+            {
+                minimum[k % 3] = std::min(minimum[k % 3], mesh.positions[k]);
+                maximum[k % 3] = std::max(maximum[k % 3], mesh.positions[k]);
+            }
+            for (size_t k = 0; k < 3; ++k)
+                entry.center[k] = 0.5f * (minimum[k] + maximum[k]);
+            entry.radius = 0.5f * std::sqrt((maximum[0] - minimum[0]) * (maximum[0] - minimum[0]) + (maximum[1] - minimum[1]) * (maximum[1] - minimum[1])
+                + (maximum[2] - minimum[2]) * (maximum[2] - minimum[2]));
+            entry.levels.push_back({ i, 0.0f });
+            entry.selectedLevel = 0;
+            m_meshes.push_back(entry);
+        }
+
+        if (!m_meshes.empty() && 1u == m_meshes.back().levels.size())
+            m_meshes.pop_back();
+    }
+
+    size_t LodSwitcher::update(const ramses::PerspectiveCamera& camera)
+    {
+        if (m_meshes.empty())
+            return 0;
+
+        float position[3];
+        camera.getTranslation(position[0], position[1], position[2]);
+
+        // pixels covered by one unit at distance one
+        const float fieldOfView = camera.getVerticalFieldOfView() * 3.14159265f / 180.0f;
+        const float pixelsPerUnit = static_cast<float>(camera.getViewportHeight()) / (2.0f * std::tan(0.5f * fieldOfView));
+        const float nearPlane = camera.getNearPlane();
+
+        size_t switchedMeshes = 0;
+        for (auto& mesh : m_meshes)
+        {
+            const float offset[3] = { mesh.center[0] - position[0], mesh.center[1] - position[1], mesh.center[2] - position[2] };
+            const float centerDistance = std::sqrt(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+            const float distance = std::max(centerDistance - mesh.radius, nearPlane);
+
+            size_t level = mesh.levels.size() - 1;
+            while (level > 0 && mesh.levels[level].error * pixelsPerUnit > m_pixelError * distance)
+                --level;
+
+            if (level != mesh.selectedLevel)
+            {
+                m_selected[mesh.levels[mesh.selectedLevel].mesh] = 0u;
+                m_selected[mesh.levels[level].mesh] = 1u;
+                mesh.selectedLevel = level;
+                ++switchedMeshes;
+            }
+        }
+        return switchedMeshes;
+    }
+}
@@ -0,0 +1,165 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "MappedFile.h"
+#include "FileUtils.h"
+
+#include <fstream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace obj2ramses
+{
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool MappedFile::read(const std::string& fileName)
+    {
+        close();
+
+        const int64_t modificationTime = FileUtils::getModificationTime(fileName);
+        const uint64_t size = FileUtils::getFileSize(fileName);
+        std::ifstream stream(fileName.c_str(), std::ios::binary);
+        if (!stream)
+            return false;
+
+        m_buffer.resize(static_cast<size_t>(size));
+        stream.read(m_buffer.data(), static_cast<std::streamsize>(size));
+        const bool complete = static_cast<uint64_t>(stream.gcount()) == size && std::ifstream::traits_type::eof() == stream.peek();
+
+        // an editor saving meanwhile leaves a mix of the old and new content
+        if (!complete || modificationTime != FileUtils::getModificationTime(fileName) || size != FileUtils::getFileSize(fileName))
+        {
+            std::vector<char>().swap(m_buffer);
+            return false;
+        }
+
+        m_size = m_buffer.size();
+        m_data = m_buffer.empty() ? nullptr : m_buffer.data();
+        return true;
+    }
+
+#if defined(_WIN32)
+
+    bool MappedFile::open(const std::string& fileName)
+    {
+        close();
+
+        HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (INVALID_HANDLE_VALUE == file)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize))
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file = file;
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+        if (0 == m_size)
+            return true;
+
+        m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (nullptr == m_mapping)
+        {
+            close();
+            return false;
+        }
+
+        m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (nullptr == m_data)
+        {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (nullptr != m_data && m_buffer.empty())
+            UnmapViewOfFile(m_data);
+        if (nullptr != m_mapping)
+            CloseHandle(m_mapping);
+        if (nullptr != m_file)
+            CloseHandle(m_file);
+
+        m_data = nullptr;
+        m_mapping = nullptr;
+        m_file = nullptr;
+        m_size = 0;
+        std::vector<char>().swap(m_buffer);
+    }
+
+#else
+
+    bool MappedFile::open(const std::string& fileName)
+    {
+        close();
+
+        const int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat fileStat;
+        if (0 != fstat(fd, &fileStat) || !S_ISREG(fileStat.st_mode))
+        {
+            ::close(fd);
+            return false;
+        }
+
+        m_size = static_cast<size_t>(fileStat.st_size);
+        if (0 == m_size)
+        {
+            ::close(fd);
+            return true;
+        }
+
+        void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+
+        if (MAP_FAILED == mapping)
+        {
+            m_size = 0;
+            return false;
+        }
+
+        // files are parsed front to back exactly once
+        madvise(mapping, m_size, MADV_SEQUENTIAL);
+
+        m_data = static_cast<const char*>(mapping);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (nullptr != m_data && m_buffer.empty())
+            munmap(const_cast<char*>(m_data), m_size);
+
+        m_data = nullptr;
+        m_size = 0;
+        std::vector<char>().swap(m_buffer);
+    }
+
+#endif
+}
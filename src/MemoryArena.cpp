@@ -0,0 +1,110 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "MemoryArena.h"
+
+#include <algorithm>
+
+namespace obj2ramses
+{
+    namespace
+    {
+        /* alignment of operator new, enough for everything stored in the arena */
+        const size_t BlockAlignment = alignof(std::max_align_t);
+
+        size_t alignUp(size_t value, size_t alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    MemoryArena::MemoryArena(size_t minimumBlockSize)
+        : m_minimumBlockSize(minimumBlockSize)
+        , m_firstBlockSize(minimumBlockSize)
+    {
+    }
+
+    MemoryArena::~MemoryArena()
+    {
+        freeBlocks();
+    }
+
+    void* MemoryArena::allocate(size_t size, size_t alignment)
+    {
+        if (!m_blocks.empty())
+        {
+            Block& block = m_blocks.back();
+            const size_t offset = alignUp(block.used, alignment);
+            if (offset <= block.size && size <= block.size - offset)
+            {
+                block.used = offset + size;
+                return block.memory + offset;
+            }
+        }
+
+        // a new block; allocations which do not fit the regular size get a block of their own size
+        const size_t regularSize = m_blocks.empty() ? m_firstBlockSize : m_minimumBlockSize;
+        const size_t blockSize = std::max(regularSize, alignUp(size, BlockAlignment));
+        Block block = { static_cast<char*>(::operator new(blockSize)), blockSize, size };
+        m_blocks.push_back(block);
+        return block.memory;
+    }
+
+    void MemoryArena::deallocate(void* memory, size_t size)
+    {
+        if (m_blocks.empty())
+            return;
+
+        // only the most recent allocation can be taken back, everything else is freed by reset()
+        Block& block = m_blocks.back();
+        if (static_cast<char*>(memory) + size == block.memory + block.used)
+            block.used -= size;
+    }
+
+    void MemoryArena::reset()
+    {
+        if (1u == m_blocks.size())
+        {
+            m_blocks.front().used = 0;
+            return;
+        }
+
+        // the next import most likely needs as much as this one, give it a single block
+        m_firstBlockSize = std::max(m_firstBlockSize, alignUp(getUsedBytes(), BlockAlignment));
+        freeBlocks();
+    }
+
+    void MemoryArena::release()
+    {
+        freeBlocks();
+        m_firstBlockSize = m_minimumBlockSize;
+    }
+
+    size_t MemoryArena::getUsedBytes() const
+    {
+        size_t used = 0;
+        for (const auto& block : m_blocks)
+            used += block.used;
+        return used;
+    }
+
+    size_t MemoryArena::getCapacity() const
+    {
+        size_t capacity = 0;
+        for (const auto& block : m_blocks)
+            capacity += block.size;
+        return capacity;
+    }
+
+    void MemoryArena::freeBlocks()
+    {
+        for (const auto& block : m_blocks)
+            ::operator delete(block.memory);
+        m_blocks.clear();
+    }
+}
@@ -0,0 +1,129 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "MeshChunker.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+namespace obj2ramses
+{
+    using ObjGeometry::invalid_index;
+
+    MeshChunker::MeshChunker(size_t maxTrianglesPerChunk)
+        : m_maxTriangles(maxTrianglesPerChunk)
+    {
+        assert(m_maxTriangles >= 1);
+    }
+
+    void MeshChunker::partition(const ObjGeometry::indexed_mesh& mesh, std::vector<ObjGeometry::indexed_mesh>& chunks)
+    {
+        const size_t triangleCount = mesh.indices.size() / 3;
+        computeCentroids(mesh);
+        m_triangles.resize(triangleCount);
+        for (size_t i = 0; i < triangleCount; ++i)
+            m_triangles[i] = static_cast<unsigned>(i);
+
+        m_localIndex.assign(mesh.vertex_count(), 0u);
+        m_vertexChunk.assign(mesh.vertex_count(), invalid_index);
+
+        // ranges still to be split, the left half is popped first to keep the leaves in depth first order
+        std::vector<std::pair<size_t, size_t>> ranges;
+        ranges.push_back(std::make_pair(static_cast<size_t>(0u), triangleCount));
+        while (!ranges.empty())
+        {
+            const size_t begin = ranges.back().first;
+            const size_t end = ranges.back().second;
+            ranges.pop_back();
+
+            if (end - begin <= m_maxTriangles)
+            {
+                appendChunk(mesh, begin, end, chunks);
+                continue;
+            }
+
+            const unsigned axis = getSplitAxis(begin, end);
+            const size_t middle = begin + (end - begin) / 2;
+            const float* centroids = m_centroids.data();
+            std::nth_element(m_triangles.begin() + begin, m_triangles.begin() + middle, m_triangles.begin() + end, [centroids, axis](unsigned a, unsigned b)
+            {
+                return centroids[3 * a + axis] < centroids[3 * b + axis];
+            });
+
+            ranges.push_back(std::make_pair(middle, end));
+            ranges.push_back(std::make_pair(begin, middle));
+        }
+    }
+
+    void MeshChunker::computeCentroids(const ObjGeometry::indexed_mesh& mesh)
+    {
+        const size_t triangleCount = mesh.indices.size() / 3;
+        m_centroids.resize(3 * triangleCount);
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            const unsigned* corners = &mesh.indices[3 * triangle];
+            for (size_t k = 0; k < 3; ++k)
+                m_centroids[3 * triangle + k] = (mesh.positions[3 * corners[0] + k] + mesh.positions[3 * corners[1] + k] + mesh.positions[3 * corners[2] + k]) / 3.0f;
+        }
+    }
+
+    unsigned MeshChunker::getSplitAxis(size_t begin, size_t end) const
+    {
+        float minimum[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+        float maximum[3] = { -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+        for (size_t i = begin; i < end; ++i)
+        {
+            const float* centroid = &m_centroids[3 * m_triangles[i]];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                minimum[k] = std::min(minimum[k], centroid[k]);
+                maximum[k] = std::max(maximum[k], centroid[k]);
+            }
+        }
+
+        unsigned axis = 0;
+        for (unsigned k = 1; k < 3; ++k)
+        {
+            if (maximum[k] - minimum[k] > maximum[axis] - minimum[axis])
+                axis = k;
+        }
+        return axis;
+    }
+
+    void MeshChunker::appendChunk(const ObjGeometry::indexed_mesh& mesh, size_t begin, size_t end, std::vector<ObjGeometry::indexed_mesh>& chunks)
+    {
+        const unsigned chunk = static_cast<unsigned>(chunks.size());
+        chunks.push_back(ObjGeometry::indexed_mesh());
+        ObjGeometry::indexed_mesh& out = chunks.back();
+
+        out.indices.reserve(3 * (end - begin));
+        unsigned vertexCount = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const unsigned* corners = &mesh.indices[3 * m_triangles[i]];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const unsigned vertex = corners[k];
+                if (m_vertexChunk[vertex] != chunk)
+                {
+                    m_vertexChunk[vertex] = chunk;
+                    m_localIndex[vertex] = vertexCount++;
+
+                    out.positions.insert(out.positions.end(), &mesh.positions[3 * vertex], &mesh.positions[3 * vertex] + 3);
+                    if (!mesh.tex_coords.empty())
+                        out.tex_coords.insert(out.tex_coords.end(), &mesh.tex_coords[2 * vertex], &mesh.tex_coords[2 * vertex] + 2);
+                    if (!mesh.normals.empty())
+                        out.normals.insert(out.normals.end(), &mesh.normals[3 * vertex], &mesh.normals[3 * vertex] + 3);
+                }
+                out.indices.push_back(m_localIndex[vertex]);
+            }
+        }
+    }
+}
@@ -0,0 +1,291 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace obj2ramses
+{
+    using ObjGeometry::invalid_index;
+
+    namespace
+    {
+        struct Cluster
+        {
+            size_t firstTriangle;
+            size_t lastTriangle;
+            float sortKey;
+        };
+    }
+
+    MeshOptimizer::MeshOptimizer(unsigned cacheSize)
+        : m_cacheSize(cacheSize)
+    {
+    }
+
+    void MeshOptimizer::optimize(ObjGeometry::indexed_mesh& mesh, bool reorderForOverdraw)
+    {
+        if (mesh.indices.empty())
+            return;
+
+        reorderForVertexCache(mesh);
+        if (reorderForOverdraw)
+            reorderClustersForOverdraw(mesh);
+        reorderVertices(mesh);
+    }
+
+    VertexCacheStatistics MeshOptimizer::analyze(const ObjGeometry::indexed_mesh& mesh) const
+    {
+        // a vertex is cached if it was transformed during the last m_cacheSize misses
+        std::vector<size_t> missStamp(mesh.vertex_count(), 0u);
+        size_t missCounter = m_cacheSize;
+
+        for (auto vertex : mesh.indices)
+        {
+            if (missCounter - missStamp[vertex] >= m_cacheSize)
+                missStamp[vertex] = missCounter++;
+        }
+
+        VertexCacheStatistics statistics;
+        statistics.triangleCount = mesh.indices.size() / 3;
+        statistics.vertexCount = mesh.vertex_count();
+        statistics.cacheMisses = missCounter - m_cacheSize;
+        return statistics;
+    }
+
+    void MeshOptimizer::reorderForVertexCache(ObjGeometry::indexed_mesh& mesh)
+    {
+        const std::vector<unsigned>& indices = mesh.indices;
+        const size_t vertexCount = mesh.vertex_count();
+        const size_t triangleCount = indices.size() / 3;
+
+        // triangles around each vertex
+        std::vector<unsigned> adjacencyOffsets(vertexCount + 1, 0u);
+        for (auto vertex : indices)
+            ++adjacencyOffsets[vertex + 1];
+        for (size_t i = 0; i < vertexCount; ++i)
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+
+        std::vector<unsigned> adjacency(indices.size());
+        std::vector<unsigned> liveTriangles(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i)
+            liveTriangles[i] = adjacencyOffsets[i + 1] - adjacencyOffsets[i];
+        {
+            std::vector<unsigned> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+                for (size_t i = 0; i < 3; ++i)
+                    adjacency[fill[indices[3 * triangle + i]]++] = static_cast<unsigned>(triangle);
+        }
+
+        std::vector<size_t> cacheTime(vertexCount, 0u);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<unsigned> deadEnds;
+        std::vector<unsigned> candidates;
+        std::vector<unsigned> output;
+        output.reserve(indices.size());
+
+        m_clusterStarts.assign(1, 0u);
+
+        size_t timestamp = m_cacheSize + 1;
+        size_t cursor = 0;
+        size_t fanningVertex = indices[0];
+
+        for (;;)
+        {
+            candidates.clear();
+
+            // emit all remaining triangles around the fanning vertex
+            for (unsigned j = adjacencyOffsets[fanningVertex]; j < adjacencyOffsets[fanningVertex + 1]; ++j)
+            {
+                const unsigned triangle = adjacency[j];
+                if (emitted[triangle])
+                    continue;
+
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    const unsigned vertex = indices[3 * triangle + i];
+                    output.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    --liveTriangles[vertex];
+
+                    if (timestamp - cacheTime[vertex] > m_cacheSize)
+                        cacheTime[vertex] = timestamp++;
+                }
+                emitted[triangle] = true;
+            }
+
+            // continue with the 1-ring vertex which is still in the cache and will stay there the longest
+            size_t next = invalid_index;
+            long bestPriority = -1;
+            for (auto vertex : candidates)
+            {
+                if (0 == liveTriangles[vertex])
+                    continue;
+
+                long priority = 0;
+                if (timestamp - cacheTime[vertex] + 2 * liveTriangles[vertex] <= m_cacheSize)
+                    priority = static_cast<long>(timestamp - cacheTime[vertex]);
+
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    next = vertex;
+                }
+            }
+
+            if (invalid_index == next)
+            {
+                // dead end: fall back to recently used vertices, then to the input order
+                while (!deadEnds.empty() && invalid_index == next)
+                {
+                    const unsigned vertex = deadEnds.back();
+                    deadEnds.pop_back();
+                    if (liveTriangles[vertex] > 0)
+                        next = vertex;
+                }
+
+                while (invalid_index == next && cursor < vertexCount)
+                {
+                    if (liveTriangles[cursor] > 0)
+                        next = cursor;
+                    ++cursor;
+                }
+
+                if (invalid_index == next)
+                    break;
+
+                m_clusterStarts.push_back(output.size() / 3);
+            }
+
+            fanningVertex = next;
+        }
+
+        mesh.indices.swap(output);
+    }
+
+    void MeshOptimizer::reorderClustersForOverdraw(ObjGeometry::indexed_mesh& mesh) const
+    {
+        const std::vector<unsigned>& indices = mesh.indices;
+        const std::vector<float>& positions = mesh.positions;
+        const size_t triangleCount = indices.size() / 3;
+
+        std::vector<Cluster> clusters;
+        std::vector<float> clusterData;
+
+        // area weighted centroid and normal of each cluster, plus the centroid of the whole mesh
+        double meshCentroid[3] = { 0.0, 0.0, 0.0 };
+        double meshArea = 0.0;
+
+        for (size_t c = 0; c < m_clusterStarts.size(); ++c)
+        {
+            Cluster cluster;
+            cluster.firstTriangle = m_clusterStarts[c];
+            cluster.lastTriangle = (c + 1 < m_clusterStarts.size()) ? m_clusterStarts[c + 1] : triangleCount;
+
+            double centroid[3] = { 0.0, 0.0, 0.0 };
+            double normal[3] = { 0.0, 0.0, 0.0 };
+            double area = 0.0;
+
+            for (size_t triangle = cluster.firstTriangle; triangle < cluster.lastTriangle; ++triangle)
+            {
+                const float* p0 = &positions[3 * indices[3 * triangle]];
+                const float* p1 = &positions[3 * indices[3 * triangle + 1]];
+                const float* p2 = &positions[3 * indices[3 * triangle + 2]];
+
+                const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                const double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+                const double triangleArea = 0.5 * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    centroid[i] += triangleArea * (p0[i] + p1[i] + p2[i]) / 3.0;
+                    normal[i] += n[i];
+                }
+                area += triangleArea;
+            }
+
+            if (area > 0.0)
+            {
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    meshCentroid[i] += centroid[i];
+                    centroid[i] /= area;
+                }
+                meshArea += area;
+            }
+
+            clusters.push_back(cluster);
+            clusterData.insert(clusterData.end(), { float(centroid[0]), float(centroid[1]), float(centroid[2]), float(normal[0]), float(normal[1]), float(normal[2]) });
+        }
+
+        if (meshArea > 0.0)
+            for (size_t i = 0; i < 3; ++i)
+                meshCentroid[i] /= meshArea;
+
+        // clusters facing away from the center are likely to occlude others, so draw them first
+        for (size_t c = 0; c < clusters.size(); ++c)
+        {
+            const float* data = &clusterData[6 * c];
+            const double length = std::sqrt(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+            double key = 0.0;
+            if (length > 0.0)
+                for (size_t i = 0; i < 3; ++i)
+                    key += (data[i] - meshCentroid[i]) * data[3 + i] / length;
+            clusters[c].sortKey = static_cast<float>(key);
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+        std::vector<unsigned> output;
+        output.reserve(indices.size());
+        for (const auto& cluster : clusters)
+            output.insert(output.end(), indices.begin() + 3 * cluster.firstTriangle, indices.begin() + 3 * cluster.lastTriangle);
+
+        mesh.indices.swap(output);
+    }
+
+    void MeshOptimizer::reorderVertices(ObjGeometry::indexed_mesh& mesh) const
+    {
+        const size_t vertexCount = mesh.vertex_count();
+        std::vector<unsigned> remap(vertexCount, invalid_index);
+        std::vector<unsigned> order;
+        order.reserve(vertexCount);
+
+        for (auto& index : mesh.indices)
+        {
+            if (invalid_index == remap[index])
+            {
+                remap[index] = static_cast<unsigned>(order.size());
+                order.push_back(index);
+            }
+            index = remap[index];
+        }
+
+        ObjGeometry::indexed_mesh reordered;
+        reordered.positions.reserve(3 * order.size());
+        reordered.tex_coords.reserve(mesh.tex_coords.empty() ? 0 : 2 * order.size());
+        reordered.normals.reserve(mesh.normals.empty() ? 0 : 3 * order.size());
+
+        for (auto vertex : order)
+        {
+            reordered.positions.insert(reordered.positions.end(), &mesh.positions[3 * vertex], &mesh.positions[3 * vertex] + 3);
+            if (!mesh.tex_coords.empty())
+                reordered.tex_coords.insert(reordered.tex_coords.end(), &mesh.tex_coords[2 * vertex], &mesh.tex_coords[2 * vertex] + 2);
+            if (!mesh.normals.empty())
+                reordered.normals.insert(reordered.normals.end(), &mesh.normals[3 * vertex], &mesh.normals[3 * vertex] + 3);
+        }
+
+        mesh.positions.swap(reordered.positions);
+        mesh.tex_coords.swap(reordered.tex_coords);
+        mesh.normals.swap(reordered.normals);
+    }
+}
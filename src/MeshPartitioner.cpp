@@ -0,0 +1,155 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "MeshPartitioner.h"
+
+#include <cassert>
+
+namespace obj2ramses
+{
+    using ObjGeometry::invalid_index;
+
+    MeshPartitioner::MeshPartitioner(size_t maxVerticesPerPart)
+        : m_maxVertices(maxVerticesPerPart)
+    {
+        assert(m_maxVertices >= 3);
+    }
+
+    void MeshPartitioner::partition(const ObjGeometry::indexed_mesh& mesh, std::vector<ObjGeometry::indexed_mesh>& parts)
+    {
+        const size_t triangleCount = mesh.indices.size() / 3;
+        const size_t vertexCount = mesh.vertex_count();
+
+        buildAdjacency(mesh);
+        m_localIndex.assign(vertexCount, 0u);
+        m_vertexPart.assign(vertexCount, invalid_index);
+
+        std::vector<bool> assigned(triangleCount, false);
+        std::vector<unsigned> queuedInPart(triangleCount, invalid_index);
+        std::vector<unsigned> queue;
+        std::vector<unsigned> partTriangles;
+        std::vector<unsigned> partVertices;
+
+        size_t assignedCount = 0;
+        size_t firstUnassigned = 0;
+
+        for (unsigned part = 0; assignedCount < triangleCount; ++part)
+        {
+            queue.clear();
+            partTriangles.clear();
+            partVertices.clear();
+            size_t head = 0;
+
+            while (firstUnassigned < triangleCount && assigned[firstUnassigned])
+                ++firstUnassigned;
+            size_t seedCursor = firstUnassigned;
+
+            for (;;)
+            {
+                if (head == queue.size())
+                {
+                    // the patch cannot grow any further, start another one inside the same part while there is room
+                    if (partVertices.size() + 3 > m_maxVertices)
+                        break;
+                    while (seedCursor < triangleCount && (assigned[seedCursor] || queuedInPart[seedCursor] == part))
+                        ++seedCursor;
+                    if (seedCursor == triangleCount)
+                        break;
+
+                    queuedInPart[seedCursor] = part;
+                    queue.push_back(static_cast<unsigned>(seedCursor));
+                }
+
+                const unsigned triangle = queue[head++];
+                const unsigned* corners = &mesh.indices[3 * triangle];
+
+                size_t newVertices = 0;
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    const bool repeated = (i > 0 && corners[i] == corners[0]) || (i > 1 && corners[i] == corners[1]);
+                    if (m_vertexPart[corners[i]] != part && !repeated)
+                        ++newVertices;
+                }
+
+                // triangles that do not fit anymore are left for one of the next parts
+                if (partVertices.size() + newVertices > m_maxVertices)
+                    continue;
+
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    const unsigned vertex = corners[i];
+                    if (m_vertexPart[vertex] != part)
+                    {
+                        m_vertexPart[vertex] = part;
+                        m_localIndex[vertex] = static_cast<unsigned>(partVertices.size());
+                        partVertices.push_back(vertex);
+                    }
+                }
+
+                assigned[triangle] = true;
+                ++assignedCount;
+                partTriangles.push_back(triangle);
+
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    const unsigned vertex = corners[i];
+                    for (unsigned j = m_vertexTriangleOffsets[vertex]; j < m_vertexTriangleOffsets[vertex + 1]; ++j)
+                    {
+                        const unsigned neighbor = m_vertexTriangles[j];
+                        if (!assigned[neighbor] && queuedInPart[neighbor] != part)
+                        {
+                            queuedInPart[neighbor] = part;
+                            queue.push_back(neighbor);
+                        }
+                    }
+                }
+            }
+
+            parts.push_back(ObjGeometry::indexed_mesh());
+            ObjGeometry::indexed_mesh& out = parts.back();
+
+            out.positions.reserve(3 * partVertices.size());
+            if (!mesh.tex_coords.empty())
+                out.tex_coords.reserve(2 * partVertices.size());
+            if (!mesh.normals.empty())
+                out.normals.reserve(3 * partVertices.size());
+
+            for (auto vertex : partVertices)
+            {
+                out.positions.insert(out.positions.end(), &mesh.positions[3 * vertex], &mesh.positions[3 * vertex] + 3);
+                if (!mesh.tex_coords.empty())
+                    out.tex_coords.insert(out.tex_coords.end(), &mesh.tex_coords[2 * vertex], &mesh.tex_coords[2 * vertex] + 2);
+                if (!mesh.normals.empty())
+                    out.normals.insert(out.normals.end(), &mesh.normals[3 * vertex], &mesh.normals[3 * vertex] + 3);
+            }
+
+            out.indices.reserve(3 * partTriangles.size());
+            for (auto triangle : partTriangles)
+                for (size_t i = 0; i < 3; ++i)
+                    out.indices.push_back(m_localIndex[mesh.indices[3 * triangle + i]]);
+        }
+    }
+
+    void MeshPartitioner::buildAdjacency(const ObjGeometry::indexed_mesh& mesh)
+    {
+        const size_t vertexCount = mesh.vertex_count();
+        const size_t triangleCount = mesh.indices.size() / 3;
+
+        m_vertexTriangleOffsets.assign(vertexCount + 1, 0u);
+        for (auto vertex : mesh.indices)
+            ++m_vertexTriangleOffsets[vertex + 1];
+        for (size_t i = 0; i < vertexCount; ++i)
+            m_vertexTriangleOffsets[i + 1] += m_vertexTriangleOffsets[i];
+
+        m_vertexTriangles.resize(mesh.indices.size());
+        std::vector<unsigned> fill(m_vertexTriangleOffsets.begin(), m_vertexTriangleOffsets.end() - 1);
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+            for (size_t i = 0; i < 3; ++i)
+                m_vertexTriangles[fill[mesh.indices[3 * triangle + i]]++] = static_cast<unsigned>(triangle);
+    }
+}
@@ -0,0 +1,485 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace obj2ramses
+{
+    using ObjGeometry::invalid_index;
+
+    namespace
+    {
+        /* collapses with more than this times the error of the last collapse needed to reach the target wait for the next pass */
+        const float PassErrorSlack = 1.5f;
+        const size_t MaxPasses = 100;
+        /* collapses may turn the normals of the triangles around the moved vertex by at most acos of this */
+        const float FlipCosine = 0.25f;
+        /* collapses must not make triangles thinner than this, unless they were already */
+        const float MinCompactness = 0.05f;
+
+        void cross(const float* a, const float* b, const float* c, float* normal)
+        {
+            const float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            const float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+            normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+            normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+        }
+
+        float dot(const float* a, const float* b)
+        {
+            return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+
+        float squaredDistance(const float* a, const float* b)
+        {
+            const float d[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            return dot(d, d);
+        }
+
+        /* area relative to the squared edge lengths, 1 for an equilateral triangle and 0 for a degenerate one */
+        float getCompactness(const float* const* positions, const float* normal)
+        {
+            const float edges = squaredDistance(positions[0], positions[1]) + squaredDistance(positions[1], positions[2]) + squaredDistance(positions[2], positions[0]);
+            // the cross product is twice the area
+            return (edges > 0.0f) ? 2.0f * std::sqrt(3.0f) * std::sqrt(dot(normal, normal)) / edges : 0.0f;
+        }
+    }
+
+    SimplifyStatistics MeshSimplifier::simplify(const ObjGeometry::indexed_mesh& mesh, size_t targetTriangles, float maxError, ObjGeometry::indexed_mesh& out)
+    {
+        const size_t vertexCount = mesh.vertex_count();
+        m_indices.assign(mesh.indices.begin(), mesh.indices.end());
+        m_remap.resize(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i)
+            m_remap[i] = static_cast<unsigned>(i);
+
+        normalizePositions(mesh);
+        // degenerate input triangles would count as extra edge neighbors
+        removeCollapsedTriangles();
+        buildAdjacency(vertexCount);
+        lockBorderVertices();
+        computeQuadrics();
+
+        // errors are squared distances in the unit cube
+        const float normalizedError = maxError / m_scale;
+        const float errorLimit = normalizedError * normalizedError;
+
+        // a level without triangles would not draw anything, keep at least one
+        targetTriangles = std::max<size_t>(targetTriangles, 1u);
+
+        SimplifyStatistics statistics;
+        float largestError = 0.0f;
+        while (m_indices.size() / 3 > targetTriangles && statistics.passes < MaxPasses)
+        {
+            const size_t triangleCount = m_indices.size() / 3;
+            if (statistics.passes > 0)
+                buildAdjacency(vertexCount);
+
+            largestError = std::max(largestError, collapseEdges(targetTriangles, errorLimit));
+            removeCollapsedTriangles();
+            ++statistics.passes;
+
+            // nothing left which can be collapsed within the error limit
+            if (m_indices.size() / 3 == triangleCount)
+                break;
+        }
+
+        // only the vertices still used are copied, in order of first use
+        std::vector<unsigned> newIndex(vertexCount, invalid_index);
+        out.positions.clear();
+        out.tex_coords.clear();
+        out.normals.clear();
+        out.indices.resize(m_indices.size());
+        unsigned usedVertices = 0;
+        for (size_t i = 0; i < m_indices.size(); ++i)
+        {
+            const unsigned vertex = m_indices[i];
+            if (invalid_index == newIndex[vertex])
+            {
+                newIndex[vertex] = usedVertices++;
+                out.positions.insert(out.positions.end(), &mesh.positions[3 * vertex], &mesh.positions[3 * vertex] + 3);
+                if (!mesh.tex_coords.empty())
+                    out.tex_coords.insert(out.tex_coords.end(), &mesh.tex_coords[2 * vertex], &mesh.tex_coords[2 * vertex] + 2);
+                if (!mesh.normals.empty())
+                    out.normals.insert(out.normals.end(), &mesh.normals[3 * vertex], &mesh.normals[3 * vertex] + 3);
+            }
+            out.indices[i] = newIndex[vertex];
+        }
+
+        statistics.triangleCount = out.indices.size() / 3;
+        statistics.error = std::sqrt(largestError) * m_scale;
+        return statistics;
+    }
+
+    void MeshSimplifier::normalizePositions(const ObjGeometry::indexed_mesh& mesh)
+    {
+        const size_t vertexCount = mesh.vertex_count();
+        m_positions.resize(3 * vertexCount);
+        m_scale = 1.0f;
+        if (0 == vertexCount)
+            return;
+
+        float minimum[3] = { mesh.positions[0], mesh.positions[1], mesh.positions[2] };
+        float maximum[3] = { minimum[0], minimum[1], minimum[2] };
+        for (size_t i = 0; i < vertexCount; ++i)
+            for (size_t k = 0; k < 3; ++k)
+            {
+                minimum[k] = std::min(minimum[k], mesh.positions[3 * i + k]);
+                maximum[k] = std::max(maximum[k], mesh.positions[3 * i + k]);
+            }
+
+        const float extent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+        if (extent > 0.0f)
+            m_scale = extent;
+
+        const float inverseScale = 1.0f / m_scale;
+        for (size_t i = 0; i < 3 * vertexCount; ++i)
+            m_positions[i] = (mesh.positions[i] - minimum[i % 3]) * inverseScale;
+    }
+
+    void MeshSimplifier::buildAdjacency(size_t vertexCount)
+    {
+        // counting sort of the triangle corners by vertex
+        m_adjacencyOffsets.assign(vertexCount + 1, 0u);
+        for (auto vertex : m_indices)
+            ++m_adjacencyOffsets[vertex + 1];
+        for (size_t i = 0; i < vertexCount; ++i)
+            m_adjacencyOffsets[i + 1] += m_adjacencyOffsets[i];
+
+        m_adjacency.resize(m_indices.size());
+        std::vector<unsigned> cursor(m_adjacencyOffsets.begin(), m_adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < m_indices.size(); ++i)
+            m_adjacency[cursor[m_indices[i]]++] = static_cast<unsigned>(i / 3);
+    }
+
+    void MeshSimplifier::lockBorderVertices()
+    {
+        // an edge shared by exactly two triangles is inside a manifold surface, every other one
+        // is on a border, an attribute seam (different vertices at the same position) or non-manifold
+        m_locked.assign(m_adjacencyOffsets.size() - 1, 0u);
+        for (size_t triangle = 0; triangle < m_indices.size() / 3; ++triangle)
+        {
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const unsigned a = m_indices[3 * triangle + corner];
+                const unsigned b = m_indices[3 * triangle + (corner + 1) % 3];
+
+                size_t sharingTriangles = 0;
+                for (unsigned i = m_adjacencyOffsets[a]; i < m_adjacencyOffsets[a + 1]; ++i)
+                {
+                    const unsigned* other = &m_indices[3 * m_adjacency[i]];
+                    if (other[0] == b || other[1] == b || other[2] == b)
+                        ++sharingTriangles;
+                }
+
+                if (2 != sharingTriangles)
+                    m_locked[a] = m_locked[b] = 1u;
+            }
+        }
+    }
+
+    void MeshSimplifier::computeQuadrics()
+    {
+        const Quadric zero = {};
+        m_quadrics.assign(m_adjacencyOffsets.size() - 1, zero);
+
+        for (size_t triangle = 0; triangle < m_indices.size() / 3; ++triangle)
+        {
+            const unsigned* corners = &m_indices[3 * triangle];
+            const float* p0 = &m_positions[3 * corners[0]];
+            float normal[3];
+            cross(p0, &m_positions[3 * corners[1]], &m_positions[3 * corners[2]], normal);
+
+            const float length = std::sqrt(dot(normal, normal));
+            if (0.0f == length)
+                continue;
+
+            // plane of the triangle weighted by its area, so the error is an area weighted mean squared distance
+            const double area = 0.5 * length;
+            const double n[3] = { normal[0] / length, normal[1] / length, normal[2] / length };
+            const double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+            const Quadric plane = {
+                area * n[0] * n[0], area * n[1] * n[1], area * n[2] * n[2],
+                area * n[0] * n[1], area * n[0] * n[2], area * n[1] * n[2],
+                area * n[0] * d, area * n[1] * d, area * n[2] * d,
+                area * d * d,
+                area
+            };
+
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                Quadric& q = m_quadrics[corners[corner]];
+                q.a00 += plane.a00; q.a11 += plane.a11; q.a22 += plane.a22;
+                q.a01 += plane.a01; q.a02 += plane.a02; q.a12 += plane.a12;
+                q.b0 += plane.b0; q.b1 += plane.b1; q.b2 += plane.b2;
+                q.c += plane.c;
+                q.weight += plane.weight;
+            }
+        }
+    }
+
+    float MeshSimplifier::getCollapseError(unsigned from, unsigned to) const
+    {
+        const Quadric& q0 = m_quadrics[from];
+        const Quadric& q1 = m_quadrics[to];
+        const double x = m_positions[3 * to];
+        const double y = m_positions[3 * to + 1];
+        const double z = m_positions[3 * to + 2];
+
+        // v^T A v + 2 b^T v + c of the summed quadrics at the position the edge collapses to
+        const double a00 = q0.a00 + q1.a00, a11 = q0.a11 + q1.a11, a22 = q0.a22 + q1.a22;
+        const double a01 = q0.a01 + q1.a01, a02 = q0.a02 + q1.a02, a12 = q0.a12 + q1.a12;
+        const double error = x * (a00 * x + a01 * y + a02 * z) + y * (a01 * x + a11 * y + a12 * z) + z * (a02 * x + a12 * y + a22 * z)
+            + 2.0 * ((q0.b0 + q1.b0) * x + (q0.b1 + q1.b1) * y + (q0.b2 + q1.b2) * z) + q0.c + q1.c;
+
+        const double weight = q0.weight + q1.weight;
+        return weight > 0.0 ? static_cast<float>(std::fabs(error) / weight) : 0.0f;
+    }
+
+    bool MeshSimplifier::flipsTriangle(unsigned from, unsigned to) const
+    {
+        const float* target = &m_positions[3 * to];
+        for (unsigned i = m_adjacencyOffsets[from]; i < m_adjacencyOffsets[from + 1]; ++i)
+        {
+            const unsigned* corners = &m_indices[3 * m_adjacency[i]];
+            // triangles with both vertices degenerate and are removed
+            if (corners[0] == to || corners[1] == to || corners[2] == to)
+                continue;
+
+            const float* positions[3];
+            for (size_t k = 0; k < 3; ++k)
+                positions[k] = &m_positions[3 * corners[k]];
+
+            float before[3];
+            cross(positions[0], positions[1], positions[2], before);
+            const float compactnessBefore = getCompactness(positions, before);
+            for (size_t k = 0; k < 3; ++k)
+                if (corners[k] == from)
+                    positions[k] = target;
+            float after[3];
+            cross(positions[0], positions[1], positions[2], after);
+
+            // turning by almost 90 degrees or becoming a sliver leaves a triangle standing on the
+            // surface, whose normal the next collapse around it can flip without noticing
+            if (dot(before, after) <= FlipCosine * std::sqrt(dot(before, before) * dot(after, after)))
+                return true;
+            const float compactnessAfter = getCompactness(positions, after);
+            if (compactnessAfter < MinCompactness && compactnessAfter < compactnessBefore)
+                return true;
+        }
+        return false;
+    }
+
+    size_t MeshSimplifier::countEdgeTriangles(unsigned from, unsigned to) const
+    {
+        size_t count = 0;
+        for (unsigned i = m_adjacencyOffsets[from]; i < m_adjacencyOffsets[from + 1]; ++i)
+        {
+            const unsigned* triangle = &m_indices[3 * m_adjacency[i]];
+            if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+                ++count;
+        }
+        return count;
+    }
+
+    bool MeshSimplifier::violatesLinkCondition(unsigned from, unsigned to, size_t edgeTriangles)
+    {
+        // each triangle on the edge adds its third corner to both rings; any further common
+        // neighbor means the collapse folds two parts of the surface onto each other, e.g. it
+        // closes a tunnel or creates a second triangle with the same corners
+        collectNeighbors(from, m_fromNeighbors);
+        collectNeighbors(to, m_toNeighbors);
+
+        size_t commonNeighbors = 0;
+        auto fromNeighbor = m_fromNeighbors.begin();
+        auto toNeighbor = m_toNeighbors.begin();
+        while (fromNeighbor != m_fromNeighbors.end() && toNeighbor != m_toNeighbors.end())
+        {
+            if (*fromNeighbor < *toNeighbor)
+                ++fromNeighbor;
+            else if (*toNeighbor < *fromNeighbor)
+                ++toNeighbor;
+            else
+            {
+                ++commonNeighbors;
+                ++fromNeighbor;
+                ++toNeighbor;
+            }
+        }
+        if (commonNeighbors != edgeTriangles)
+            return true;
+
+        // the common neighbors must not be connected either, otherwise a triangle of from and one
+        // of to have the same corners after the collapse, e.g. on a tetrahedron
+        for (unsigned i = m_adjacencyOffsets[from]; i < m_adjacencyOffsets[from + 1]; ++i)
+        {
+            const unsigned* corners = &m_indices[3 * m_adjacency[i]];
+            if (corners[0] == to || corners[1] == to || corners[2] == to)
+                continue;
+
+            const unsigned a = (corners[0] == from) ? corners[1] : corners[0];
+            const unsigned b = (corners[2] == from) ? corners[1] : corners[2];
+            for (unsigned j = m_adjacencyOffsets[to]; j < m_adjacencyOffsets[to + 1]; ++j)
+            {
+                const unsigned* other = &m_indices[3 * m_adjacency[j]];
+                const bool hasA = other[0] == a || other[1] == a || other[2] == a;
+                const bool hasB = other[0] == b || other[1] == b || other[2] == b;
+                if (hasA && hasB)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    void MeshSimplifier::collectNeighbors(unsigned vertex, std::vector<unsigned>& neighbors) const
+    {
+        neighbors.clear();
+        for (unsigned i = m_adjacencyOffsets[vertex]; i < m_adjacencyOffsets[vertex + 1]; ++i)
+        {
+            const unsigned* corners = &m_indices[3 * m_adjacency[i]];
+            for (size_t k = 0; k < 3; ++k)
+                if (corners[k] != vertex)
+                    neighbors.push_back(corners[k]);
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+
+    void MeshSimplifier::sortCollapses()
+    {
+        // counting sort by the upper bits of the error: for positive floats the bit pattern is
+        // ordered like the value, 11 bits are the exponent and a few mantissa bits
+        const size_t BucketBits = 11;
+        std::vector<unsigned> buckets((1u << BucketBits) + 1, 0u);
+        std::vector<unsigned> keys(m_collapses.size());
+        for (size_t i = 0; i < m_collapses.size(); ++i)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &m_collapses[i].error, sizeof(bits));
+            keys[i] = (bits >> (31 - BucketBits)) & ((1u << BucketBits) - 1);
+            ++buckets[keys[i] + 1];
+        }
+        for (size_t i = 0; i + 1 < buckets.size(); ++i)
+            buckets[i + 1] += buckets[i];
+
+        // the collapses themselves are moved, they are visited in this order
+        m_sortedCollapses.resize(m_collapses.size());
+        for (size_t i = 0; i < m_collapses.size(); ++i)
+            m_sortedCollapses[buckets[keys[i]]++] = m_collapses[i];
+    }
+
+    float MeshSimplifier::collapseEdges(size_t targetTriangles, float errorLimit)
+    {
+        // every edge is collapsed onto the end point for which it is cheaper; edges with a movable
+        // vertex are shared by two triangles, the one seeing it from the lower vertex adds it
+        m_collapses.clear();
+        m_collapses.reserve(m_indices.size() / 2);
+        for (size_t triangle = 0; triangle < m_indices.size() / 3; ++triangle)
+        {
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const unsigned a = m_indices[3 * triangle + corner];
+                const unsigned b = m_indices[3 * triangle + (corner + 1) % 3];
+                if (a > b || (m_locked[a] && m_locked[b]))
+                    continue;
+
+                const float errorAB = m_locked[a] ? std::numeric_limits<float>::max() : getCollapseError(a, b);
+                const float errorBA = m_locked[b] ? std::numeric_limits<float>::max() : getCollapseError(b, a);
+                const Collapse collapse = (errorAB <= errorBA) ? Collapse{ a, b, errorAB } : Collapse{ b, a, errorBA };
+                m_collapses.push_back(collapse);
+            }
+        }
+        if (m_collapses.empty())
+            return 0.0f;
+
+        sortCollapses();
+
+        // a manifold collapse removes two triangles; collapses much more expensive than needed to
+        // reach the target are left for later passes, the cheap ones may have moved by then
+        const size_t triangleCount = m_indices.size() / 3;
+        const size_t collapseGoal = std::max<size_t>(1u, (triangleCount - targetTriangles) / 2);
+        const float passLimit = (collapseGoal < m_sortedCollapses.size())
+            ? std::min(errorLimit, PassErrorSlack * m_sortedCollapses[collapseGoal].error)
+            : errorLimit;
+
+        m_collapsed.assign(m_remap.size(), 0u);
+        float largestError = 0.0f;
+        // when all collapses below the pass limit are blocked, e.g. because the limit is 0 and
+        // every collapse without error would flip a triangle, the pass tries the others
+        if (0 == collapseSortedEdges(targetTriangles, passLimit, largestError) && passLimit < errorLimit)
+            collapseSortedEdges(targetTriangles, errorLimit, largestError);
+        return largestError;
+    }
+
+    size_t MeshSimplifier::collapseSortedEdges(size_t targetTriangles, float passLimit, float& largestError)
+    {
+        const size_t triangleCount = m_indices.size() / 3;
+        size_t removedTriangles = 0;
+        for (const auto& collapse : m_sortedCollapses)
+        {
+            // buckets are only roughly sorted, cheaper collapses may still follow
+            if (collapse.error > passLimit)
+                continue;
+            if (m_collapsed[collapse.from] || m_collapsed[collapse.to] || flipsTriangle(collapse.from, collapse.to))
+                continue;
+            // the triangles around the edge disappear, the last ones must stay
+            const size_t edgeTriangles = countEdgeTriangles(collapse.from, collapse.to);
+            if (triangleCount <= removedTriangles + edgeTriangles || violatesLinkCondition(collapse.from, collapse.to, edgeTriangles))
+                continue;
+
+            m_remap[collapse.from] = collapse.to;
+            // every triangle of from changes, later collapses of the pass must not move their corners
+            for (unsigned i = m_adjacencyOffsets[collapse.from]; i < m_adjacencyOffsets[collapse.from + 1]; ++i)
+            {
+                const unsigned* corners = &m_indices[3 * m_adjacency[i]];
+                m_collapsed[corners[0]] = m_collapsed[corners[1]] = m_collapsed[corners[2]] = 1u;
+            }
+
+            Quadric& target = m_quadrics[collapse.to];
+            const Quadric& source = m_quadrics[collapse.from];
+            target.a00 += source.a00; target.a11 += source.a11; target.a22 += source.a22;
+            target.a01 += source.a01; target.a02 += source.a02; target.a12 += source.a12;
+            target.b0 += source.b0; target.b1 += source.b1; target.b2 += source.b2;
+            target.c += source.c;
+            target.weight += source.weight;
+
+            largestError = std::max(largestError, collapse.error);
+            removedTriangles += edgeTriangles;
+            if (triangleCount <= targetTriangles + removedTriangles)
+                break;
+        }
+
+        return removedTriangles;
+    }
+
+    void MeshSimplifier::removeCollapsedTriangles()
+    {
+        // a vertex collapses at most once per pass and never onto a vertex which collapses itself,
+        // so one lookup resolves it
+        size_t written = 0;
+        for (size_t i = 0; i < m_indices.size(); i += 3)
+        {
+            const unsigned a = m_remap[m_indices[i]];
+            const unsigned b = m_remap[m_indices[i + 1]];
+            const unsigned c = m_remap[m_indices[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+
+            m_indices[written++] = a;
+            m_indices[written++] = b;
+            m_indices[written++] = c;
+        }
+        m_indices.resize(written);
+    }
+}
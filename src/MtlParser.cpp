@@ -0,0 +1,123 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "MtlParser.h"
+#include "MappedFile.h"
+#include "NumberParser.h"
+#include "FileUtils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace obj2ramses
+{
+    namespace
+    {
+        bool parseFloat(StringRange token, float& value)
+        {
+            const ParseResult result = NumberParser::parseFloat(token.begin, token.end, value);
+            return EParseError_None == result.error && result.ptr == token.end;
+        }
+    }
+
+    bool MtlParser::parseFile(const std::string& mtlFile, std::vector<Material>& materials)
+    {
+        MappedFile file;
+        if (!file.open(mtlFile))
+            return false;
+
+        parse(file.data(), file.data() + file.size(), FileUtils::getDirectory(mtlFile), materials);
+        return true;
+    }
+
+    void MtlParser::parse(const char* begin, const char* end, const std::string& directory, std::vector<Material>& materials)
+    {
+        Material* material = nullptr;
+        const char* lineBegin = begin;
+        while (lineBegin < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', static_cast<size_t>(end - lineBegin)));
+            if (nullptr == lineEnd)
+                lineEnd = end;
+
+            StringRange line(lineBegin, lineEnd);
+            lineBegin = lineEnd + 1;
+
+            const char* comment = static_cast<const char*>(std::memchr(line.begin, '#', line.size()));
+            if (nullptr != comment)
+                line.end = comment;
+
+            StringRange tokens[16];
+            const size_t tokenCount = ObjParser::tokenize(line, tokens, 16);
+            if (0 == tokenCount)
+                continue;
+
+            const StringRange& type = tokens[0];
+            if (type.equals("newmtl"))
+            {
+                materials.push_back(Material());
+                material = &materials.back();
+                if (tokenCount > 1)
+                    material->name.assign(tokens[1].begin, line.end);
+                // the name is the rest of the line, like the usemtl record referencing it
+                while (!material->name.empty() && (' ' == material->name.back() || '\t' == material->name.back() || '\r' == material->name.back()))
+                    material->name.pop_back();
+                continue;
+            }
+
+            // statements before the first newmtl have no material to apply to
+            if (nullptr == material)
+            {
+                ++m_skippedCount;
+                continue;
+            }
+
+            float value = 0.0f;
+            if (type.equals("Kd"))
+            {
+                if (tokenCount < 4 || !parseFloat(tokens[1], material->diffuse[0]) || !parseFloat(tokens[2], material->diffuse[1]) || !parseFloat(tokens[3], material->diffuse[2]))
+                    ++m_errorCount;
+            }
+            else if (type.equals("d"))
+            {
+                // "d -halo 0.5" is rare, only the factor is used
+                if (tokenCount < 2 || !parseFloat(tokens[std::min<size_t>(tokenCount, 16u) - 1], value))
+                    ++m_errorCount;
+                else
+                    material->opacity = value;
+            }
+            else if (type.equals("Tr"))
+            {
+                if (tokenCount < 2 || !parseFloat(tokens[1], value))
+                    ++m_errorCount;
+                else
+                    material->opacity = 1.0f - value;
+            }
+            else if (type.equals("map_Kd"))
+            {
+                if (tokenCount < 2 || tokenCount > 16)
+                {
+                    ++m_errorCount;
+                    continue;
+                }
+
+                std::string path(tokens[tokenCount - 1].begin, tokens[tokenCount - 1].end);
+#if !defined(_WIN32)
+                // exporters on Windows write backslashes
+                std::replace(path.begin(), path.end(), '\\', '/');
+#endif
+                material->diffuseTexture = FileUtils::resolvePath(directory, path);
+            }
+            else
+            {
+                ++m_skippedCount;
+            }
+        }
+    }
+}
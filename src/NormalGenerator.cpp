@@ -0,0 +1,299 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "NormalGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace obj2ramses
+{
+    using ObjGeometry::vertex3f;
+    using ObjGeometry::vertex_normal_3f;
+
+    namespace
+    {
+        /* ranges below this size are not worth a thread of their own */
+        const size_t MinimumItemsPerThread = 16384;
+
+        const vertex_normal_3f FallbackNormal = { 0.0f, 0.0f, 1.0f };
+
+        /* calls function(first, last) for consecutive ranges of [0, count) on up to threadCount threads */
+        template <typename Function>
+        void parallelFor(size_t count, unsigned threadCount, const Function& function)
+        {
+            const size_t rangeCount = std::max<size_t>(1, std::min<size_t>(threadCount, count / MinimumItemsPerThread));
+            if (1 == rangeCount)
+            {
+                function(0, count);
+                return;
+            }
+
+            std::vector<std::thread> threads;
+            for (size_t i = 1; i < rangeCount; ++i)
+                threads.emplace_back([&function, count, rangeCount, i]() { function(count * i / rangeCount, count * (i + 1) / rangeCount); });
+            function(0, count / rangeCount);
+
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        inline float dot(const vertex_normal_3f& a, const vertex_normal_3f& b)
+        {
+            return a.x * b.x + a.y * b.y + a.z * b.z;
+        }
+
+        inline void addScaled(vertex_normal_3f& sum, const vertex_normal_3f& normal, float weight)
+        {
+            sum.x += normal.x * weight;
+            sum.y += normal.y * weight;
+            sum.z += normal.z * weight;
+        }
+
+        inline vertex_normal_3f normalize(const vertex_normal_3f& sum, const vertex_normal_3f& fallback)
+        {
+            const float length = std::sqrt(dot(sum, sum));
+            if (!(length > 0.0f))
+                return fallback;
+
+            const vertex_normal_3f normal = { sum.x / length, sum.y / length, sum.z / length };
+            return normal;
+        }
+
+        inline vertex_normal_3f difference(const vertex3f& a, const vertex3f& b)
+        {
+            const vertex_normal_3f d = { a.x - b.x, a.y - b.y, a.z - b.z };
+            return d;
+        }
+
+        /* angle between the edges from a corner to its neighbors, 0 for degenerate edges */
+        float cornerAngle(const vertex3f& previous, const vertex3f& corner, const vertex3f& next)
+        {
+            const vertex_normal_3f a = difference(previous, corner);
+            const vertex_normal_3f b = difference(next, corner);
+            const float lengths = std::sqrt(dot(a, a) * dot(b, b));
+            if (!(lengths > 0.0f))
+                return 0.0f;
+            return std::acos(std::max(-1.0f, std::min(1.0f, dot(a, b) / lengths)));
+        }
+    }
+
+    NormalGenerator::NormalGenerator(ENormalWeighting weighting, float creaseAngleDegrees, unsigned threadCount)
+        : m_weighting(weighting)
+        , m_useCreaseAngle(creaseAngleDegrees < 180.0f)
+        , m_creaseCosine(static_cast<float>(std::cos(static_cast<double>(creaseAngleDegrees) * 3.14159265358979323846 / 180.0)))
+        , m_threadCount(std::max(1u, threadCount))
+    {
+    }
+
+    NormalStatistics NormalGenerator::generate(ObjGeometry::mesh_data& mesh)
+    {
+        const size_t faceCount = mesh.faces.size();
+        const size_t cornerCount = mesh.faces.corner_count();
+        const size_t vertexCount = mesh.vertices.size();
+
+        // phase 1: face normals and the weight of every corner, each thread writes its own faces
+        m_faceNormals.resize(faceCount);
+        m_cornerFaces.resize(cornerCount);
+        m_cornerWeights.resize(cornerCount);
+        parallelFor(faceCount, m_threadCount, [this, &mesh](size_t first, size_t last) { computeFaceNormals(mesh, first, last); });
+
+        NormalStatistics statistics;
+        statistics.vertexCount = buildVertexCorners(mesh);
+
+        // phase 2: every thread gathers the corners of its own positions, nothing is written twice
+        mesh.normals.clear();
+        mesh.faces.vn.resize(cornerCount);
+        if (!m_useCreaseAngle)
+        {
+            // one normal per position, so the normal indices equal the position indices
+            mesh.normals.resize(vertexCount);
+            parallelFor(vertexCount, m_threadCount, [this, &mesh](size_t first, size_t last) { gatherSmoothNormals(mesh, first, last); });
+            statistics.normalCount = statistics.vertexCount;
+            return statistics;
+        }
+
+        // creases give positions a varying number of normals: count them, then write them at their offsets
+        m_vertexNormalOffsets.assign(vertexCount + 1, 0u);
+        parallelFor(vertexCount, m_threadCount, [this, &mesh](size_t first, size_t last) { countCreasedNormals(mesh, first, last); });
+        for (size_t i = 0; i < vertexCount; ++i)
+            m_vertexNormalOffsets[i + 1] += m_vertexNormalOffsets[i];
+
+        mesh.normals.resize(m_vertexNormalOffsets.back());
+        parallelFor(vertexCount, m_threadCount, [this, &mesh](size_t first, size_t last) { writeCreasedNormals(mesh, first, last); });
+        statistics.normalCount = mesh.normals.size();
+        return statistics;
+    }
+
+    void NormalGenerator::computeFaceNormals(const ObjGeometry::mesh_data& mesh, size_t firstFace, size_t lastFace)
+    {
+        const ObjGeometry::face_store& faces = mesh.faces;
+        const vertex3f* positions = mesh.vertices.data();
+
+        for (size_t f = firstFace; f < lastFace; ++f)
+        {
+            const unsigned first = faces.offsets[f];
+            const unsigned last = faces.offsets[f + 1];
+
+            // sum of the fan triangles' cross products: twice the area times the normal, also for non-planar polygons
+            const vertex3f& origin = positions[faces.v[first]];
+            vertex_normal_3f sum = { 0.0f, 0.0f, 0.0f };
+            for (unsigned c = first + 1; c + 1 < last; ++c)
+            {
+                const vertex_normal_3f a = difference(positions[faces.v[c]], origin);
+                const vertex_normal_3f b = difference(positions[faces.v[c + 1]], origin);
+                sum.x += a.y * b.z - a.z * b.y;
+                sum.y += a.z * b.x - a.x * b.z;
+                sum.z += a.x * b.y - a.y * b.x;
+            }
+
+            const float length = std::sqrt(dot(sum, sum));
+            const vertex_normal_3f zero = { 0.0f, 0.0f, 0.0f };
+            m_faceNormals[f] = normalize(sum, zero);
+
+            for (unsigned c = first; c < last; ++c)
+            {
+                m_cornerFaces[c] = static_cast<unsigned>(f);
+                if (ENormalWeighting_Area == m_weighting)
+                {
+                    m_cornerWeights[c] = length;
+                }
+                else
+                {
+                    const unsigned previous = (c == first) ? last - 1 : c - 1;
+                    const unsigned next = (c + 1 == last) ? first : c + 1;
+                    m_cornerWeights[c] = cornerAngle(positions[faces.v[previous]], positions[faces.v[c]], positions[faces.v[next]]);
+                }
+            }
+        }
+    }
+
+    size_t NormalGenerator::buildVertexCorners(const ObjGeometry::mesh_data& mesh)
+    {
+        const ObjGeometry::index_vector& cornerVertices = mesh.faces.v;
+        const size_t vertexCount = mesh.vertices.size();
+
+        // counting sort of the corners by position, corners of a position stay in ascending order
+        m_vertexCornerOffsets.assign(vertexCount + 1, 0u);
+        for (auto v : cornerVertices)
+            ++m_vertexCornerOffsets[v + 1];
+
+        size_t usedVertexCount = 0;
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            usedVertexCount += (0 != m_vertexCornerOffsets[i + 1]) ? 1u : 0u;
+            m_vertexCornerOffsets[i + 1] += m_vertexCornerOffsets[i];
+        }
+
+        std::vector<unsigned> next(m_vertexCornerOffsets.begin(), m_vertexCornerOffsets.end() - 1);
+        m_vertexCorners.resize(cornerVertices.size());
+        for (size_t c = 0; c < cornerVertices.size(); ++c)
+            m_vertexCorners[next[cornerVertices[c]]++] = static_cast<unsigned>(c);
+
+        return usedVertexCount;
+    }
+
+    void NormalGenerator::gatherSmoothNormals(ObjGeometry::mesh_data& mesh, size_t firstVertex, size_t lastVertex)
+    {
+        ObjGeometry::index_vector& cornerNormals = mesh.faces.vn;
+
+        for (size_t v = firstVertex; v < lastVertex; ++v)
+        {
+            const unsigned begin = m_vertexCornerOffsets[v];
+            const unsigned end = m_vertexCornerOffsets[v + 1];
+
+            vertex_normal_3f sum = { 0.0f, 0.0f, 0.0f };
+            for (unsigned i = begin; i < end; ++i)
+            {
+                const unsigned corner = m_vertexCorners[i];
+                addScaled(sum, m_faceNormals[m_cornerFaces[corner]], m_cornerWeights[corner]);
+                cornerNormals[corner] = static_cast<unsigned>(v);
+            }
+
+            // e.g. a position only used by degenerate faces
+            const vertex_normal_3f fallback = (begin != end) ? normalize(m_faceNormals[m_cornerFaces[m_vertexCorners[begin]]], FallbackNormal) : FallbackNormal;
+            mesh.normals[v] = normalize(sum, fallback);
+        }
+    }
+
+    vertex_normal_3f NormalGenerator::computeCreasedNormal(unsigned begin, unsigned end, unsigned corner) const
+    {
+        const unsigned face = m_cornerFaces[corner];
+        const vertex_normal_3f& faceNormal = m_faceNormals[face];
+
+        // average the faces which are smooth with respect to this corner's face
+        vertex_normal_3f sum = { 0.0f, 0.0f, 0.0f };
+        for (unsigned j = begin; j < end; ++j)
+        {
+            const unsigned otherCorner = m_vertexCorners[j];
+            const unsigned otherFace = m_cornerFaces[otherCorner];
+            if (otherFace == face || dot(faceNormal, m_faceNormals[otherFace]) >= m_creaseCosine)
+                addScaled(sum, m_faceNormals[otherFace], m_cornerWeights[otherCorner]);
+        }
+        return normalize(sum, normalize(faceNormal, FallbackNormal));
+    }
+
+    void NormalGenerator::countCreasedNormals(ObjGeometry::mesh_data& mesh, size_t firstVertex, size_t lastVertex)
+    {
+        ObjGeometry::index_vector& cornerNormals = mesh.faces.vn;
+        std::vector<vertex_normal_3f> distinctNormals;
+
+        for (size_t v = firstVertex; v < lastVertex; ++v)
+        {
+            const unsigned begin = m_vertexCornerOffsets[v];
+            const unsigned end = m_vertexCornerOffsets[v + 1];
+            distinctNormals.clear();
+
+            for (unsigned i = begin; i < end; ++i)
+            {
+                const unsigned corner = m_vertexCorners[i];
+                const vertex_normal_3f normal = computeCreasedNormal(begin, end, corner);
+
+                // corners averaging the same faces end up with bit identical normals and share them
+                size_t index = 0;
+                while (index < distinctNormals.size() &&
+                       (distinctNormals[index].x != normal.x || distinctNormals[index].y != normal.y || distinctNormals[index].z != normal.z))
+                    ++index;
+                if (index == distinctNormals.size())
+                    distinctNormals.push_back(normal);
+
+                // the index among the normals of this position for now, made global by writeCreasedNormals
+                cornerNormals[corner] = static_cast<unsigned>(index);
+            }
+
+            m_vertexNormalOffsets[v + 1] = static_cast<unsigned>(distinctNormals.size());
+        }
+    }
+
+    void NormalGenerator::writeCreasedNormals(ObjGeometry::mesh_data& mesh, size_t firstVertex, size_t lastVertex)
+    {
+        ObjGeometry::index_vector& cornerNormals = mesh.faces.vn;
+
+        for (size_t v = firstVertex; v < lastVertex; ++v)
+        {
+            const unsigned begin = m_vertexCornerOffsets[v];
+            const unsigned end = m_vertexCornerOffsets[v + 1];
+            const unsigned base = m_vertexNormalOffsets[v];
+
+            // local indices were handed out in corner order, so each normal is computed again only at its first corner
+            unsigned nextIndex = 0;
+            for (unsigned i = begin; i < end; ++i)
+            {
+                const unsigned corner = m_vertexCorners[i];
+                const unsigned index = cornerNormals[corner];
+                if (index == nextIndex)
+                {
+                    mesh.normals[base + index] = computeCreasedNormal(begin, end, corner);
+                    ++nextIndex;
+                }
+                cornerNormals[corner] = base + index;
+            }
+        }
+    }
+}
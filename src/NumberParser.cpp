@@ -0,0 +1,278 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "NumberParser.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OBJ2RAMSES_HAS_SSE2
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define OBJ2RAMSES_LITTLE_ENDIAN
+#endif
+
+namespace obj2ramses
+{
+    namespace
+    {
+        /* doubles represent all integers up to 2^53 and all powers of ten up to 10^22 exactly */
+        const uint64_t MaxExactMantissa = 1ull << 53;
+        const int MaxExactPowerOfTen = 22;
+        const double PowersOfTen[MaxExactPowerOfTen + 1] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        /* accumulating one more digit cannot overflow below this */
+        const uint64_t MaxMantissaForDigit = 1000000000000000000ull;
+        /* accumulating eight more digits cannot overflow below this */
+        const uint64_t MaxMantissaForEightDigits = 100000000000ull;
+
+#if defined(OBJ2RAMSES_LITTLE_ENDIAN)
+        /* converts eight ASCII digits at once (SWAR), the first digit is the lowest byte */
+        uint32_t parseEightDigits(const char* digits)
+        {
+            uint64_t value;
+            std::memcpy(&value, digits, sizeof(value));
+            value = ((value & 0x0F0F0F0F0F0F0F0Full) * 2561u) >> 8;
+            value = ((value & 0x00FF00FF00FF00FFull) * 6553601u) >> 16;
+            return static_cast<uint32_t>(((value & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32);
+        }
+#endif
+
+        /**
+         * Appends count digits to the mantissa. Digits which do not fit are dropped, the
+         * return value is their number; inexact is set if any of them was not zero.
+         */
+        size_t accumulateDigits(const char* digits, size_t count, uint64_t& mantissa, bool& inexact)
+        {
+            size_t i = 0;
+#if defined(OBJ2RAMSES_LITTLE_ENDIAN)
+            for (; i + 8 <= count && mantissa < MaxMantissaForEightDigits; i += 8)
+                mantissa = mantissa * 100000000u + parseEightDigits(digits + i);
+#endif
+            for (; i < count && mantissa < MaxMantissaForDigit; ++i)
+                mantissa = mantissa * 10u + static_cast<unsigned>(digits[i] - '0');
+
+            const size_t dropped = count - i;
+            for (; i < count; ++i)
+                inexact = inexact || '0' != digits[i];
+            return dropped;
+        }
+
+        bool isFloatMidpoint(double value)
+        {
+            // a double between two adjacent normal floats has exactly the bit below the float mantissa set
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            const uint64_t droppedBits = bits & ((1ull << 29) - 1u);
+            return droppedBits == (1ull << 28);
+        }
+
+        bool matchesIgnoringCase(const char* begin, const char* end, const char* word)
+        {
+            for (; *word; ++begin, ++word)
+                if (begin == end || (*begin | 0x20) != *word)
+                    return false;
+            return true;
+        }
+
+        ParseResult parseSpecialFloat(const char* begin, const char* p, const char* end, bool negative, float& value)
+        {
+            if (matchesIgnoringCase(p, end, "nan"))
+            {
+                value = negative ? -std::numeric_limits<float>::quiet_NaN() : std::numeric_limits<float>::quiet_NaN();
+                return { p + 3, EParseError_None };
+            }
+            if (matchesIgnoringCase(p, end, "inf"))
+            {
+                value = negative ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+                return { matchesIgnoringCase(p, end, "infinity") ? p + 8 : p + 3, EParseError_None };
+            }
+            return { begin, EParseError_InvalidArgument };
+        }
+
+        /**
+         * Correct rounding for everything the fast path cannot do, independent of the global locale.
+         * Like strtof, numbers beyond the float range give infinity and numbers too small for it zero,
+         * aboveOne tells which of the two a failed conversion was.
+         */
+        ParseResult parseFloatSlow(const char* begin, const char* end, bool negative, bool aboveOne, float& value)
+        {
+            std::istringstream stream(std::string(begin, end));
+            stream.imbue(std::locale::classic());
+
+            float parsed = 0.0f;
+            stream >> parsed;
+            if (stream.fail())
+                parsed = aboveOne ? std::numeric_limits<float>::infinity() : 0.0f;
+            else
+                parsed = std::fabs(parsed);
+
+            value = negative ? -parsed : parsed;
+            return { end, EParseError_None };
+        }
+    }
+
+    namespace NumberParser
+    {
+        size_t scanDigits(const char* begin, const char* end)
+        {
+            const char* p = begin;
+#if defined(OBJ2RAMSES_HAS_SSE2)
+            const __m128i zero = _mm_set1_epi8('0');
+            const __m128i nine = _mm_set1_epi8(9);
+            while (end - p >= 16)
+            {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                // digit - '0' is at most 9, everything else wraps around to larger unsigned values
+                const __m128i offset = _mm_sub_epi8(chunk, zero);
+                const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(offset, nine), offset);
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(isDigit));
+                if (0xFFFFu != mask)
+                {
+#if defined(_MSC_VER)
+                    unsigned long firstNonDigit;
+                    _BitScanForward(&firstNonDigit, ~mask);
+                    return static_cast<size_t>(p - begin) + firstNonDigit;
+#else
+                    return static_cast<size_t>(p - begin) + static_cast<size_t>(__builtin_ctz(~mask));
+#endif
+                }
+                p += 16;
+            }
+#endif
+            while (p != end && static_cast<unsigned>(*p - '0') <= 9u)
+                ++p;
+            return static_cast<size_t>(p - begin);
+        }
+
+        ParseResult parseFloat(const char* begin, const char* end, float& value)
+        {
+            const char* p = begin;
+            bool negative = false;
+            if (p != end && ('-' == *p || '+' == *p))
+            {
+                negative = '-' == *p;
+                ++p;
+            }
+            const char* const digitsBegin = p;
+
+            uint64_t mantissa = 0;
+            int64_t exponent = 0;
+            bool inexact = false;
+
+            const size_t integerDigits = scanDigits(p, end);
+            exponent += static_cast<int64_t>(accumulateDigits(p, integerDigits, mantissa, inexact));
+            p += integerDigits;
+
+            size_t fractionDigits = 0;
+            if (p != end && '.' == *p)
+            {
+                ++p;
+                fractionDigits = scanDigits(p, end);
+                const size_t dropped = accumulateDigits(p, fractionDigits, mantissa, inexact);
+                exponent -= static_cast<int64_t>(fractionDigits - dropped);
+                p += fractionDigits;
+            }
+
+            if (0 == integerDigits && 0 == fractionDigits)
+                return parseSpecialFloat(begin, digitsBegin, end, negative, value);
+
+            // the exponent only belongs to the number if it has digits
+            if (p != end && ('e' == *p || 'E' == *p))
+            {
+                const char* exponentBegin = p + 1;
+                bool negativeExponent = false;
+                if (exponentBegin != end && ('-' == *exponentBegin || '+' == *exponentBegin))
+                {
+                    negativeExponent = '-' == *exponentBegin;
+                    ++exponentBegin;
+                }
+
+                const size_t exponentDigits = scanDigits(exponentBegin, end);
+                if (exponentDigits > 0)
+                {
+                    int64_t exponentValue = 0;
+                    for (size_t i = 0; i < exponentDigits; ++i)
+                        if (exponentValue < 100000)
+                            exponentValue = exponentValue * 10 + (exponentBegin[i] - '0');
+                    exponent += negativeExponent ? -exponentValue : exponentValue;
+                    p = exponentBegin + exponentDigits;
+                }
+            }
+
+            if (0 == mantissa && !inexact)
+            {
+                value = negative ? -0.0f : 0.0f;
+                return { p, EParseError_None };
+            }
+
+            // Clinger's fast path: mantissa and power of ten are exact doubles, so one
+            // multiplication or division gives the correctly rounded double
+            if (!inexact && mantissa <= MaxExactMantissa && exponent >= -MaxExactPowerOfTen && exponent <= MaxExactPowerOfTen)
+            {
+                double number = static_cast<double>(mantissa);
+                number = (exponent < 0) ? number / PowersOfTen[-exponent] : number * PowersOfTen[exponent];
+
+                // rounding the double to float again is only wrong if the double lies exactly between
+                // two floats; subnormal and overflowing floats are left to the slow path as well
+                if (number >= static_cast<double>(std::numeric_limits<float>::min()) &&
+                    number <= static_cast<double>(std::numeric_limits<float>::max()) &&
+                    !isFloatMidpoint(number))
+                {
+                    const float rounded = static_cast<float>(number);
+                    value = negative ? -rounded : rounded;
+                    return { p, EParseError_None };
+                }
+            }
+
+            // the number has mantissaDigits + exponent digits before the point
+            int64_t mantissaDigits = 0;
+            for (uint64_t rest = mantissa; 0 != rest; rest /= 10u)
+                ++mantissaDigits;
+            return parseFloatSlow(begin, p, negative, mantissaDigits + exponent > 0, value);
+        }
+
+        ParseResult parseUnsigned(const char* begin, const char* end, uint32_t& value)
+        {
+            const char* p = begin;
+            if (p != end && '+' == *p)
+                ++p;
+
+            const size_t digits = scanDigits(p, end);
+            if (0 == digits)
+                return { begin, EParseError_InvalidArgument };
+
+            uint64_t parsed = 0;
+            bool overflow = false;
+            for (size_t i = 0; i < digits && !overflow; ++i)
+            {
+                parsed = parsed * 10u + static_cast<unsigned>(p[i] - '0');
+                overflow = parsed > std::numeric_limits<uint32_t>::max();
+            }
+
+            if (overflow)
+                return { p + digits, EParseError_OutOfRange };
+
+            value = static_cast<uint32_t>(parsed);
+            return { p + digits, EParseError_None };
+        }
+    }
+}
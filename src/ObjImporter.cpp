@@ -9,139 +9,642 @@
 #include "ObjImporter.h"
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
-#include <iterator>
 #include <array>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <cassert>
 
 #include "ramses-client.h"
 #include "ObjGeometry.h"
+#include "ObjParser.h"
+#include "MappedFile.h"
+#include "VertexWelder.h"
+#include "MeshPartitioner.h"
+#include "MeshChunker.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "NormalGenerator.h"
+#include "FileUtils.h"
+#include "GeometryCache.h"
+#include "Profiler.h"
 
 namespace obj2ramses
 {
-    ObjImporter::ObjImporter(ramses::RamsesClient& client, ramses::Scene& scene)
+    namespace
+    {
+        /* faces of one object, group and material combination, the OBJ file may list them in several places */
+        struct SubMesh
+        {
+            std::string name;
+            std::string material;
+            std::vector<VertexWelder::FaceRange> faceRanges;
+        };
+
+        std::string getSubMeshName(const std::string& object, const std::string& group, const std::string& material, const std::string& fileName)
+        {
+            std::string name = object;
+            if (!group.empty() && group != object)
+                name = name.empty() ? group : name + "/" + group;
+            if (name.empty())
+                name = fileName;
+            if (!material.empty())
+                name += "_" + material;
+            return name;
+        }
+
+        /**
+         * Resolves the o, g and usemtl records into one sub-mesh per distinct combination, in
+         * order of first use. Without any of these records all faces form one sub-mesh named
+         * after the file. Combinations whose names coincide, e.g. object "a/b" and object "a"
+         * with group "b", get a number appended, so the names identify the meshes on reload.
+         */
+        std::vector<SubMesh> collectSubMeshes(const ObjGeometry::mesh_data& mesh, const std::string& fileName)
+        {
+            std::vector<SubMesh> subMeshes;
+            std::map<std::tuple<std::string, std::string, std::string>, size_t> subMeshByCombination;
+            std::set<std::string> usedNames;
+
+            std::string object;
+            std::string group;
+            std::string material;
+            const size_t faceCount = mesh.faces.size();
+            size_t firstFace = 0;
+
+            for (size_t i = 0; i <= mesh.name_changes.size(); ++i)
+            {
+                const bool last = i == mesh.name_changes.size();
+                const size_t lastFace = last ? faceCount : std::min(mesh.name_changes[i].first_face, faceCount);
+                if (lastFace > firstFace)
+                {
+                    // a group named like its object is no group of its own
+                    const std::string ownGroup = (group == object) ? std::string() : group;
+                    auto inserted = subMeshByCombination.insert(std::make_pair(std::make_tuple(object, ownGroup, material), subMeshes.size()));
+                    if (inserted.second)
+                    {
+                        SubMesh subMesh;
+                        subMesh.name = getSubMeshName(object, group, material, fileName);
+                        const std::string baseName = subMesh.name;
+                        for (unsigned suffix = 1; !usedNames.insert(subMesh.name).second; ++suffix)
+                            subMesh.name = baseName + "_" + std::to_string(suffix);
+                        subMesh.material = material;
+                        subMeshes.push_back(subMesh);
+                    }
+                    subMeshes[inserted.first->second].faceRanges.push_back(std::make_pair(firstFace, lastFace));
+                    firstFace = lastFace;
+                }
+                if (last)
+                    break;
+
+                const ObjGeometry::name_change& change = mesh.name_changes[i];
+                switch (change.kind)
+                {
+                case ObjGeometry::name_object:
+                    object = change.name;
+                    // a new object starts without group
+                    group.clear();
+                    break;
+                case ObjGeometry::name_group:
+                    group = change.name;
+                    break;
+                case ObjGeometry::name_material:
+                    material = change.name;
+                    break;
+                }
+            }
+
+            if (subMeshes.empty())
+            {
+                SubMesh subMesh;
+                subMesh.name = fileName;
+                subMeshes.push_back(subMesh);
+            }
+            return subMeshes;
+        }
+
+        /* diagonal of the bounding box */
+        float getMeshSize(const ObjGeometry::indexed_mesh& mesh)
+        {
+            if (mesh.positions.empty())
+                return 0.0f;
+
+            float minimum[3] = { mesh.positions[0], mesh.positions[1], mesh.positions[2] };
+            float maximum[3] = { minimum[0], minimum[1], minimum[2] };
+            for (size_t i = 0; i < mesh.positions.size(); ++i)
+            {
+                minimum[i % 3] = std::min(minimum[i % 3], mesh.positions[i]);
+                maximum[i % 3] = std::max(maximum[i % 3], mesh.positions[i]);
+            }
+
+            const float extent[3] = { maximum[0] - minimum[0], maximum[1] - minimum[1], maximum[2] - minimum[2] };
+            return std::sqrt(extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2]);
+        }
+    }
+
+    ObjImporter::ObjImporter(ramses::RamsesClient& client, ramses::Scene& scene, const ImportOptions& options, MemoryArena* arena, std::ostream& log,
+        EffectCache* effectCache)
         : m_client(client)
         , m_scene(scene)
+        , m_options(options)
+        , m_log(log)
+        , m_ownEffectCache(client, options.cacheDirectory)
+        , m_effectCache(nullptr != effectCache ? *effectCache : m_ownEffectCache)
+        , m_arena(nullptr != arena ? *arena : m_ownArena)
+        , m_textureLoader(options.threadCount)
     {
     }
 
     /**
      * @brief Imports geometry from a .obj file, loading it into the importer.
      *
+     * The file is memory-mapped and parsed in place, see ObjParser. With more than one
+     * thread configured the file is parsed in chunks concurrently. The parsed data lives in
+     * the arena and is dropped at once when the GPU meshes are built.
+     *
      * @param objFile
-     * @return false if the file cannot be opened e.g. if the stream's bad bit is set.
+     * @return false if the file cannot be opened or contains malformed records.
      */
     bool ObjImporter::importFromFile(const std::string& objFile)
     {
-        // Import OBJ data and put into ramses scene
-        std::ifstream f{objFile};
-        string line;
+        ScopedTimer timer("import");
 
-        if (f.bad())
+        MappedFile file;
+        if (!(m_options.mapFile ? file.open(objFile) : file.read(objFile)))
+        {
+            std::cerr << "Cannot open " << objFile << std::endl;
             return false;
+        }
+        Profiler::Get().addCounter("bytesRead", file.size());
 
-        while (std::getline(f, line)) {
-            std::istringstream iss{line};
-            vector<string> tokens = this->tokenize(line,' ');
+        // name the meshes after the file, without directory and extension
+        m_name = FileUtils::getStem(objFile);
 
-            string dtype = tokens[0];
+        // textures decode in the background while the geometry is parsed or loaded from the cache
+        if (m_options.loadMaterials)
+            loadMaterials(objFile, file.data(), file.size());
 
-            if (dtype == "v") {
+        const bool useCache = !m_options.cacheDirectory.empty();
+        GeometryCache cache(m_options.cacheDirectory, m_options.cacheSizeLimit, m_log);
+        uint64_t cacheKey = 0;
+        if (useCache)
+        {
+            ScopedTimer cacheTimer("import.cacheLoad");
+            cacheKey = computeCacheKey(file.data(), file.size());
+            if (cache.load(cacheKey, m_meshes, m_use32BitIndices))
+            {
+                Profiler::Get().addCounter("cacheHits", 1u);
+                m_log << "Loaded " << objFile << " from the geometry cache" << std::endl;
+                return true;
+            }
+        }
 
-                vertex3f v;
-                v.x = std::stof(tokens[1]);
-                v.y = std::stof(tokens[2]);
-                v.z = std::stof(tokens[3]);
-                this->vertices.push_back(v);
+        m_mesh = ObjGeometry::mesh_data(&m_arena);
+        const bool parsed = parse(objFile, file.data(), file.size());
+        // the mapping is not needed anymore, release it before building the meshes
+        file.close();
+        if (parsed)
+        {
+            if (m_options.generateNormals && m_mesh.faces.vn.empty())
+                generateNormals();
+            buildIndexedMesh();
+        }
+        releaseParsedData();
 
-            } else if (dtype == "vt") {
-                tex_coord_3f vt;
-                vt.u = std::stof(tokens[1]);
+        if (!parsed)
+            return false;
 
-                if (tokens.size() >= 3 ){
-                    vt.v = std::stof(tokens[2]);
-                }
+        if (useCache)
+        {
+            ScopedTimer cacheTimer("import.cacheStore");
+            cache.store(cacheKey, m_meshes, m_use32BitIndices);
+        }
 
-                if(tokens.size() >= 4){
-                    vt.w = std::stof(tokens[3]);
-                }
+        return true;
+    }
 
-                this->tex_coords.push_back(vt);
+    /**
+     * @brief Parses the MTL files of all mtllib records and requests the decoding of their diffuse textures.
+     */
+    void ObjImporter::loadMaterials(const std::string& objFile, const char* data, size_t size)
+    {
+        ScopedTimer timer("import.materials");
+        m_materials.clear();
+        m_materialByName.clear();
+
+        const std::vector<std::string> libraries = ObjParser::findMaterialLibraries(data, data + size);
+        const std::string directory = FileUtils::getDirectory(objFile);
+        MtlParser parser;
+        for (const auto& library : libraries)
+        {
+            const std::string path = FileUtils::resolvePath(directory, library);
+            if (!parser.parseFile(path, m_materials))
+                std::cerr << objFile << ": cannot read material library " << path << std::endl;
+        }
+        if (0 != parser.getErrorCount())
+            std::cerr << objFile << ": " << parser.getErrorCount() << " malformed material statement(s)" << std::endl;
 
+        // a later definition of the same name wins, like in most viewers
+        for (size_t i = 0; i < m_materials.size(); ++i)
+            m_materialByName[m_materials[i].name] = i;
 
-            } else if (dtype == "vn") {
-                vertex_normal_3f vn;
-                vn.x = std::stof(tokens[1]);
-                vn.y = std::stof(tokens[2]);
-                vn.z = std::stof(tokens[3]);
-                this->normals.push_back(vn);
+        for (const auto& material : m_materials)
+        {
+            if (!material.diffuseTexture.empty())
+                m_textureLoader.request(material.diffuseTexture);
+        }
 
-            } else if (dtype == "f") {
-                bool has_double_slash = line.find("//") != std::string::npos;
-                bool has_slash = line.find("/") != std::string::npos;
-                face f;
-                vector<unsigned> v, vt, vn;
+        Profiler::Get().addCounter("materials", m_materials.size());
+        if (!m_materials.empty())
+        {
+            m_log << "Loaded " << m_materials.size() << " material(s) from " << libraries.size() << " material librar" << (1 == libraries.size() ? "y" : "ies")
+                      << ", decoding " << m_textureLoader.getTextureCount() << " texture(s)" << std::endl;
+        }
+    }
 
-                if(has_double_slash){
-                    auto pos = line.find("//");
-                    line.erase(pos); /* get rid of it and keep processing */
-                }
+    const Material* ObjImporter::findMaterial(const std::string& name) const
+    {
+        auto it = m_materialByName.find(name);
+        return (it == m_materialByName.end()) ? nullptr : &m_materials[it->second];
+    }
 
-                if (has_slash) {
-                    vector<string> face_tokens = this->tokenize(line, ' ');
-                    face f;
-                    f.len = face_tokens.size() - 1; /* do not count the 'f' char */
+    bool ObjImporter::parse(const std::string& objFile, const char* data, size_t size)
+    {
+        ObjParser parser(m_mesh);
+        const unsigned threadCount = getThreadCount();
+        {
+            ScopedTimer parseTimer("import.parse");
+            if (threadCount > 1)
+                parser.parseParallel(data, data + size, threadCount);
+            else
+                parser.parse(data, data + size);
+        }
+
+        Profiler& profiler = Profiler::Get();
+        const size_t recordLines = m_mesh.vertices.size() + m_mesh.tex_coords.size() + m_mesh.normals.size() + m_mesh.faces.size();
+        profiler.addCounter("lines.total", parser.getLineCount());
+        profiler.addCounter("lines.v", m_mesh.vertices.size());
+        profiler.addCounter("lines.vt", m_mesh.tex_coords.size());
+        profiler.addCounter("lines.vn", m_mesh.normals.size());
+        profiler.addCounter("lines.f", m_mesh.faces.size());
+        profiler.addCounter("lines.other", parser.getLineCount() > recordLines ? parser.getLineCount() - recordLines : 0u);
+
+        // once per type, a line per record is slow on large files
+        const std::vector<SkippedRecords>& skipped = parser.getSkippedRecords();
+        if (!skipped.empty())
+        {
+            std::cerr << objFile << ": skipped unsupported records:";
+            for (size_t i = 0; i < skipped.size(); ++i)
+                std::cerr << (0 == i ? " " : ", ") << skipped[i].count << " " << skipped[i].type;
+            std::cerr << std::endl;
+        }
+
+        if (0 != parser.getErrorCount())
+        {
+            std::cerr << objFile << ": " << parser.getErrorCount() << " malformed record(s), first: "
+                      << parser.getFirstError() << " in line " << parser.getFirstErrorLine() << std::endl;
+            return false;
+        }
 
-                    for(size_t i = 1; i < face_tokens.size(); ++i){
-                        vector<string> face_items = this->tokenize(face_tokens[i], '/');
+        {
+            ScopedTimer validateTimer("import.validateFaces");
+            if (!validateFaceIndices())
+                return false;
+        }
 
-                        f.v.push_back(std::stoul(face_items[0]) - 1);
+        return true;
+    }
 
-                        if (face_items.size() > 1)
-                            f.vt.push_back(has_double_slash ? -1 : std::stoul(face_items[1]) - 1);
+    void ObjImporter::releaseParsedData()
+    {
+        Profiler::Get().addCounter("arenaBytes", m_arena.getUsedBytes());
+
+        // the buffers belong to the arena, so nothing is freed one by one; the empty replacement must
+        // not allocate from the arena, its memory is reused by the next import
+        m_mesh = ObjGeometry::mesh_data();
+        if (&m_arena == &m_ownArena)
+            m_arena.release();
+        else
+            m_arena.reset();
+    }
 
-                        if(face_items.size() > 2) {
-                            auto vn_index = (has_double_slash) ? 1 : 2;
-                            f.vn.push_back(std::stoul(face_items[vn_index]) - 1);
-                        }
+    void ObjImporter::generateNormals()
+    {
+        NormalStatistics statistics;
+        {
+            ScopedTimer timer("import.normals");
+            NormalGenerator generator(m_options.normalWeighting, m_options.creaseAngle, getThreadCount());
+            statistics = generator.generate(m_mesh);
+        }
+        Profiler::Get().addCounter("generatedNormals", statistics.normalCount);
 
-                    }
+        m_log << "Generated " << statistics.normalCount << " smooth normals for " << statistics.vertexCount << " vertices" << std::endl;
+    }
 
-                    this->faces.push_back(f);
+    unsigned ObjImporter::getThreadCount() const
+    {
+        if (0 == m_options.threadCount)
+            return std::max(1u, std::thread::hardware_concurrency());
+        return m_options.threadCount;
+    }
 
+    /**
+     * @brief Cache key of the file content, the file name and all options which change the processed meshes.
+     */
+    uint64_t ObjImporter::computeCacheKey(const char* data, size_t size) const
+    {
+        // bump when the processing changes, so entries of older versions are not used anymore
+        const uint32_t ProcessingVersion = 8u;
+
+        uint32_t creaseAngleBits = 0;
+        std::memcpy(&creaseAngleBits, &m_options.creaseAngle, sizeof(creaseAngleBits));
+
+        const uint32_t optimize = (m_options.optimizeVertexCache || m_options.optimizeOverdraw) ? 1u : 0u;
+        const uint32_t options[] = {
+            ProcessingVersion,
+            static_cast<uint32_t>(m_options.indexWidthPolicy),
+            m_options.targetSupportsUInt32Indices ? 1u : 0u,
+            optimize,
+            m_options.optimizeOverdraw ? 1u : 0u,
+            optimize * m_options.vertexCacheSize,
+            m_options.generateNormals ? 1u : 0u,
+            m_options.generateNormals ? static_cast<uint32_t>(m_options.normalWeighting) : 0u,
+            m_options.generateNormals ? creaseAngleBits : 0u,
+            static_cast<uint32_t>(m_options.chunkTriangles)
+        };
+
+        uint64_t seed = GeometryCache::Hash(options, sizeof(options), 0u);
+        // meshes without object or group are named after the file, equal content under another name is another entry
+        seed = GeometryCache::Hash(m_name.data(), m_name.size(), seed);
+        for (const auto* levels : { &m_options.lodTriangleRatios, &m_options.lodMaxErrors })
+        {
+            const uint64_t levelCount = levels->size();
+            seed = GeometryCache::Hash(&levelCount, sizeof(levelCount), seed);
+            seed = GeometryCache::Hash(levels->data(), levels->size() * sizeof(float), seed);
+        }
 
+        return GeometryCache::Hash(data, size, seed);
+    }
+
+    /**
+     * @brief Builds the GPU vertex and index data, one vertex per distinct (v, vt, vn) combination.
+     *
+     * Every object, group and material combination of the file becomes a mesh of its own. Meshes
+     * with more vertices than 16 bit indices can address either use 32 bit indices or are split
+     * into several parts, depending on the configured EIndexWidthPolicy. With chunking enabled,
+     * large meshes are first cut into spatially compact chunks which the viewer can cull.
+     */
+    void ObjImporter::buildIndexedMesh()
+    {
+        const size_t maxVerticesFor16Bit = 65536u;
+
+        const std::vector<SubMesh> subMeshes = collectSubMeshes(m_mesh, m_name);
+        vector<ObjGeometry::indexed_mesh> meshes(subMeshes.size());
+        VertexWelder welder;
+        WeldStatistics statistics;
+        {
+            ScopedTimer timer("import.weld");
+            for (size_t i = 0; i < subMeshes.size(); ++i)
+            {
+                // all ranges at once, so vertices shared between them are welded as well
+                const WeldStatistics meshStatistics = welder.weld(m_mesh, subMeshes[i].faceRanges, meshes[i]);
+                statistics.cornerCount += meshStatistics.cornerCount;
+                statistics.vertexCount += meshStatistics.vertexCount;
+                meshes[i].name = subMeshes[i].name;
+                meshes[i].material = subMeshes[i].material;
+            }
+        }
+        Profiler::Get().addCounter("vertices", statistics.vertexCount);
+        Profiler::Get().addCounter("subMeshes", meshes.size());
+
+        m_log << "Welded " << statistics.cornerCount << " face corners into " << statistics.vertexCount
+                  << " unique vertices (dedup ratio " << statistics.getDedupRatio() << ")" << std::endl;
+        if (meshes.size() > 1)
+            m_log << "Split the file into " << meshes.size() << " meshes by object, group and material" << std::endl;
+
+        if (0 != m_options.chunkTriangles)
+            chunkMeshes(meshes);
+
+        size_t maxVertexCount = 0;
+        for (const auto& mesh : meshes)
+            maxVertexCount = std::max(maxVertexCount, mesh.vertex_count());
+
+        // one index width for all meshes, they share their effects
+        const bool fits16Bit = maxVertexCount <= maxVerticesFor16Bit;
+        bool split = false;
+
+        switch (m_options.indexWidthPolicy)
+        {
+        case EIndexWidthPolicy_UInt32:
+            m_use32BitIndices = true;
+            break;
+        case EIndexWidthPolicy_Split16:
+            m_use32BitIndices = false;
+            split = !fits16Bit;
+            break;
+        case EIndexWidthPolicy_Auto:
+            m_use32BitIndices = !fits16Bit && m_options.targetSupportsUInt32Indices;
+            split = !fits16Bit && !m_options.targetSupportsUInt32Indices;
+            break;
+        }
+
+        m_meshes.clear();
+        if (split)
+        {
+            ScopedTimer timer("import.split");
+            MeshPartitioner partitioner(maxVerticesFor16Bit);
+            for (auto& mesh : meshes)
+            {
+                if (mesh.vertex_count() <= maxVerticesFor16Bit)
+                {
+                    m_meshes.push_back(std::move(mesh));
+                    continue;
                 }
 
-            } else {
-                std::cerr << "Skipping: This code can only handle v, vt, vn and f, but got this instead: " << dtype << std::endl;
+                const size_t firstPart = m_meshes.size();
+                partitioner.partition(mesh, m_meshes);
+
+                size_t splitVertexCount = 0;
+                for (size_t i = firstPart; i < m_meshes.size(); ++i)
+                {
+                    m_meshes[i].name = mesh.name + "_part" + std::to_string(i - firstPart);
+                    m_meshes[i].material = mesh.material;
+                    splitVertexCount += m_meshes[i].vertex_count();
+                }
+
+                m_log << "Split mesh " << mesh.name << " with " << mesh.vertex_count() << " vertices into " << m_meshes.size() - firstPart
+                          << " parts with 16 bit indices (" << splitVertexCount - mesh.vertex_count() << " vertices duplicated)" << std::endl;
             }
         }
+        else
+        {
+            m_meshes = std::move(meshes);
+        }
 
+        if (!m_options.lodTriangleRatios.empty() || !m_options.lodMaxErrors.empty())
+            generateLods();
 
-        return true;
+        if (m_options.optimizeVertexCache || m_options.optimizeOverdraw)
+            optimizeMeshes();
+    }
+
+    /**
+     * @brief Replaces meshes with more than ImportOptions::chunkTriangles triangles by their chunks.
+     */
+    void ObjImporter::chunkMeshes(vector<ObjGeometry::indexed_mesh>& meshes) const
+    {
+        ScopedTimer timer("import.chunk");
+        MeshChunker chunker(m_options.chunkTriangles);
+        vector<ObjGeometry::indexed_mesh> chunks;
+        size_t chunkedMeshes = 0;
+
+        for (auto& mesh : meshes)
+        {
+            if (mesh.indices.size() / 3 <= m_options.chunkTriangles)
+            {
+                chunks.push_back(std::move(mesh));
+                continue;
+            }
+
+            const size_t firstChunk = chunks.size();
+            chunker.partition(mesh, chunks);
+            for (size_t i = firstChunk; i < chunks.size(); ++i)
+            {
+                chunks[i].name = mesh.name + "_chunk" + std::to_string(i - firstChunk);
+                chunks[i].material = mesh.material;
+            }
+            ++chunkedMeshes;
+        }
+
+        if (0 != chunkedMeshes)
+        {
+            m_log << "Cut " << chunkedMeshes << " mesh(es) into chunks of at most " << m_options.chunkTriangles << " triangles, "
+                      << chunks.size() << " meshes in total" << std::endl;
+        }
+        Profiler::Get().addCounter("chunks", chunks.size());
+        meshes.swap(chunks);
     }
 
-    std::vector<string>
-    ObjImporter::tokenize(string line, char delim)
+    /**
+     * @brief Appends simplified levels of detail to every mesh.
+     *
+     * Each level is simplified from the previous one, so its error is the sum of the errors of all
+     * steps. A level stops at its triangle ratio or its error bound, whichever is reached first.
+     */
+    void ObjImporter::generateLods()
     {
-        std::istringstream iss{line};
+        ScopedTimer timer("import.lod");
+        const size_t levelCount = std::max(m_options.lodTriangleRatios.size(), m_options.lodMaxErrors.size());
+
+        vector<size_t> levelTriangles(levelCount + 1, 0u);
+        vector<float> levelErrors(levelCount + 1, 0.0f);
+        vector<ObjGeometry::indexed_mesh> meshes;
+        meshes.reserve(m_meshes.size() * (levelCount + 1));
+        MeshSimplifier simplifier;
 
-        if (delim == ' '){
-            vector<string> tokens(std::istream_iterator<std::string>{iss},
-                                  std::istream_iterator<std::string>());
-            return tokens;
+        for (auto& mesh : m_meshes)
+        {
+            const size_t baseTriangles = mesh.indices.size() / 3;
+            const float meshSize = getMeshSize(mesh);
+            levelTriangles[0] += baseTriangles;
+            meshes.push_back(std::move(mesh));
+            const ObjGeometry::indexed_mesh& base = meshes.back();
+
+            float error = 0.0f;
+            for (size_t level = 1; level <= levelCount; ++level)
+            {
+                const float ratio = (level <= m_options.lodTriangleRatios.size()) ? m_options.lodTriangleRatios[level - 1] : 0.0f;
+                const float maxError = (level <= m_options.lodMaxErrors.size())
+                    ? std::max(0.0f, m_options.lodMaxErrors[level - 1] * meshSize - error)
+                    : std::numeric_limits<float>::max();
+
+                ObjGeometry::indexed_mesh lod;
+                const SimplifyStatistics statistics = simplifier.simplify(meshes.back(), static_cast<size_t>(ratio * static_cast<float>(baseTriangles)), maxError, lod);
+                error += statistics.error;
+
+                lod.name = base.name + "_lod" + std::to_string(level);
+                lod.material = base.material;
+                lod.lod = static_cast<unsigned>(level);
+                lod.lod_error = error;
+
+                levelTriangles[level] += statistics.triangleCount;
+                if (meshSize > 0.0f)
+                    levelErrors[level] = std::max(levelErrors[level], error / meshSize);
+                meshes.push_back(std::move(lod));
+            }
         }
+        m_meshes.swap(meshes);
 
-        std::string item;
-        std::vector<std::string> tokens;
-        while (std::getline(iss, item, delim))
+        for (size_t level = 1; level <= levelCount; ++level)
         {
-            tokens.push_back(item);
+            const double ratio = (0 == levelTriangles[0]) ? 0.0 : static_cast<double>(levelTriangles[level]) / static_cast<double>(levelTriangles[0]);
+            Profiler::Get().addCounter(("lod" + std::to_string(level) + ".triangles").c_str(), levelTriangles[level]);
+            m_log << "LOD " << level << ": " << levelTriangles[level] << " triangles (" << 100.0 * ratio << "% of " << levelTriangles[0]
+                      << "), largest error " << 100.0f * levelErrors[level] << "% of the mesh size" << std::endl;
         }
+    }
+
+    void ObjImporter::optimizeMeshes()
+    {
+        ScopedTimer timer("import.optimize");
+        MeshOptimizer optimizer(m_options.vertexCacheSize);
+        VertexCacheStatistics before;
+        VertexCacheStatistics after;
+
+        for (auto& mesh : m_meshes)
+        {
+            const VertexCacheStatistics meshBefore = optimizer.analyze(mesh);
+            optimizer.optimize(mesh, m_options.optimizeOverdraw);
+            const VertexCacheStatistics meshAfter = optimizer.analyze(mesh);
+
+            before.triangleCount += meshBefore.triangleCount;
+            before.vertexCount += meshBefore.vertexCount;
+            before.cacheMisses += meshBefore.cacheMisses;
+            after.triangleCount += meshAfter.triangleCount;
+            after.vertexCount += meshAfter.vertexCount;
+            after.cacheMisses += meshAfter.cacheMisses;
+        }
+
+        m_log << "Vertex cache (" << m_options.vertexCacheSize << " entries): ACMR " << before.getACMR() << " -> " << after.getACMR()
+                  << ", ATVR " << before.getATVR() << " -> " << after.getATVR() << std::endl;
+    }
+
+    bool ObjImporter::validateFaceIndices() const
+    {
+        const ObjGeometry::face_store& faces = m_mesh.faces;
+        const size_t vertexCount = m_mesh.vertices.size();
+        const size_t texCoordCount = m_mesh.tex_coords.size();
+        const size_t normalCount = m_mesh.normals.size();
+
+        for (auto v : faces.v)
+            if (v >= vertexCount)
+            {
+                std::cerr << "Face references vertex " << v + 1 << ", but only " << vertexCount << " vertices exist" << std::endl;
+                return false;
+            }
+
+        for (auto vt : faces.vt)
+            if (vt != ObjGeometry::invalid_index && vt >= texCoordCount)
+            {
+                std::cerr << "Face references texture coordinate " << vt + 1 << ", but only " << texCoordCount << " exist" << std::endl;
+                return false;
+            }
+
+        for (auto vn : faces.vn)
+            if (vn != ObjGeometry::invalid_index && vn >= normalCount)
+            {
+                std::cerr << "Face references normal " << vn + 1 << ", but only " << normalCount << " exist" << std::endl;
+                return false;
+            }
 
-        return tokens;
+        return true;
     }
 
     void ObjImporter::createDummyScene()
@@ -190,11 +693,12 @@ void main(void)
 )shader";
 
         // create an appearance
-        ramses::EffectDescription effectDesc;
-        effectDesc.setVertexShader(vertexShader.c_str());
-        effectDesc.setFragmentShader(fragmentShader.c_str());
+        EffectSource effectSource;
+        effectSource.vertexShader = vertexShader;
+        effectSource.fragmentShader = fragmentShader;
 
-        const ramses::Effect* effect = m_client.createEffect(effectDesc);
+        bool cacheHit = false;
+        const ramses::Effect* effect = m_effectCache.acquireEffect(effectSource, cacheHit);
         ramses::Appearance* appearance = m_scene.createAppearance(*effect);
 
         // set vertex positions directly in geometry
@@ -218,9 +722,11 @@ void main(void)
     }
 
 
-    ramses::RenderGroup* ObjImporter::getRamsesRenderGroup()
+    /**
+     * @brief Creates the shader of all OBJ meshes, with or without lighting by vertex normals and diffuse texture.
+     */
+    const ramses::Effect* ObjImporter::createEffect(bool hasNormals, bool hasTexture)
     {
-
         std::string vertexShader = R"shader(
         #version 300 es
 
@@ -229,9 +735,27 @@ void main(void)
         uniform highp mat4 u_VMatrix;
         uniform highp mat4 u_PMatrix;
 
+        #ifdef HAS_NORMALS
+        in vec3 a_normal;
+        out vec3 v_normal;
+        #endif
+
+        #ifdef HAS_TEXTURE
+        in vec2 a_texCoord;
+        out vec2 v_texCoord;
+        #endif
+
         void main()
         {
-            // z = -1.0, so that the geometry will not be clipped by the near plane of the camera
+            #ifdef HAS_NORMALS
+            v_normal = mat3(u_MMatrix) * a_normal;
+            #endif
+
+            #ifdef HAS_TEXTURE
+            // OBJ texture coordinates start at the bottom, image rows at the top
+            v_texCoord = vec2(a_texCoord.x, 1.0 - a_texCoord.y);
+            #endif
+
             gl_Position = u_PMatrix * u_VMatrix * u_MMatrix * vec4(a_position.xyz, 1.0);
         }
         )shader";
@@ -244,92 +768,588 @@ void main(void)
         uniform vec4 color;
         out vec4 FragColor;
 
+        #ifdef HAS_NORMALS
+        in vec3 v_normal;
+        #endif
+
+        #ifdef HAS_TEXTURE
+        uniform sampler2D u_texture;
+        in vec2 v_texCoord;
+        #endif
+
         void main(void)
         {
-            FragColor = color;
+            vec4 baseColor = color;
+            #ifdef HAS_TEXTURE
+            baseColor *= texture(u_texture, v_texCoord);
+            #endif
+
+            #ifdef HAS_NORMALS
+            // simple headlight-like diffuse term, enough to make the shape readable
+            float diffuse = max(dot(normalize(v_normal), normalize(vec3(0.3, 0.5, 1.0))), 0.0);
+            FragColor = vec4(baseColor.rgb * (0.2 + 0.8 * diffuse), baseColor.a);
+            #else
+            FragColor = baseColor;
+            #endif
         }
 
         )shader";
 
-        // create an appearance
-        ramses::EffectDescription effectDesc;
-        effectDesc.setVertexShader(vertexShader.c_str());
-        effectDesc.setFragmentShader(fragmentShader.c_str());
-        effectDesc.setUniformSemantic("u_MMatrix", ramses::EEffectUniformSemantic_ModelMatrix);
-        effectDesc.setUniformSemantic("u_VMatrix", ramses::EEffectUniformSemantic_ViewMatrix);
-        effectDesc.setUniformSemantic("u_PMatrix", ramses::EEffectUniformSemantic_ProjectionMatrix);
-
-        const ramses::Effect* effect = m_client.createEffect(effectDesc);
-        ramses::Appearance* appearance = m_scene.createAppearance(*effect);
+        EffectSource effectSource;
+        effectSource.vertexShader = vertexShader;
+        effectSource.fragmentShader = fragmentShader;
+        effectSource.uniformSemantics.push_back(std::make_pair("u_MMatrix", ramses::EEffectUniformSemantic_ModelMatrix));
+        effectSource.uniformSemantics.push_back(std::make_pair("u_VMatrix", ramses::EEffectUniformSemantic_ViewMatrix));
+        effectSource.uniformSemantics.push_back(std::make_pair("u_PMatrix", ramses::EEffectUniformSemantic_ProjectionMatrix));
+        if (hasNormals)
+            effectSource.compilerDefines.push_back("HAS_NORMALS");
+        if (hasTexture)
+            effectSource.compilerDefines.push_back("HAS_TEXTURE");
+
+        // compiled once, later runs load it from the effect cache
+        const ramses::Effect* effect = nullptr;
+        bool cacheHit = false;
+        {
+            ScopedTimer timer("scene.createEffect");
+            effect = m_effectCache.acquireEffect(effectSource, cacheHit);
+        }
+        if (nullptr == effect)
+            return nullptr;
 
-        ramses::GeometryBinding* geometry = m_scene.createGeometryBinding(*effect);
+        ++(cacheHit ? m_effectCacheHits : m_effectCacheMisses);
+        m_resources.push_back(effect);
+        return effect;
+    }
 
-        int index_sz = computeIndexCount();
-        auto indices = getIndexArray();
+    /**
+     * @brief Creates one mesh node per GPU mesh in a new render group.
+     *
+     * Meshes share one effect per shader variant and one appearance per variant and material.
+     * The nodes are ordered by both, so the renderer switches shaders and uniforms as rarely as
+     * possible.
+     */
+    ramses::RenderGroup* ObjImporter::getRamsesRenderGroup()
+    {
+        std::vector<ShaderVariant> variants(m_meshes.size());
+        for (size_t i = 0; i < m_meshes.size(); ++i)
+            variants[i] = getShaderVariant(m_meshes[i]);
+        const std::vector<size_t> drawOrder = getDrawOrder(m_meshes, variants);
 
-        const ramses::UInt16Array* rIdxArray = m_client.createConstUInt16Array(index_sz, indices.data());
-        geometry->setIndices(*rIdxArray);
+        // mesh needs to be added to a render group that belongs to a render pass with camera in order to be rendered
+        m_renderGroup = m_scene.createRenderGroup();
+        m_meshNodes.assign(m_meshes.size(), nullptr);
+        m_meshResources.assign(m_meshes.size(), MeshResources());
 
-        ramses::AttributeInput positionsInput;
-        effect->findAttributeInput("a_position", positionsInput);
+        for (size_t order = 0; order < drawOrder.size(); ++order)
+        {
+            const size_t index = drawOrder[order];
+            const ObjGeometry::indexed_mesh& mesh = m_meshes[index];
+
+            ramses::MeshNode* meshNode = createMeshNode(mesh, variants[index], m_meshResources[index]);
+            // coarser levels of detail are shown by the viewer depending on the distance
+            if (0 != mesh.lod)
+                meshNode->setVisibility(false);
+            m_renderGroup->addMeshNode(*meshNode, static_cast<int32_t>(order));
+            m_meshNodes[index] = meshNode;
+        }
 
-        auto vertexData = getVertexArray();
+        Profiler::Get().addCounter("scene.effects", m_effects.size());
+        Profiler::Get().addCounter("scene.appearances", m_appearances.size());
+        Profiler::Get().addCounter("scene.textures", m_textureSamplers.size());
+        Profiler::Get().addCounter("scene.arrays", m_arrays.size());
+        m_log << "Created " << m_meshes.size() << " mesh nodes with " << m_effects.size() << " effect(s), "
+                  << m_appearances.size() << " appearance(s) and " << m_textureSamplers.size() << " texture(s)" << std::endl;
 
-        const ramses::Vector3fArray* rVertexData = m_client.createConstVector3fArray(vertices.size(), vertexData.data());
-        geometry->setInputBuffer(positionsInput, *rVertexData);
+        if (!m_options.cacheDirectory.empty())
+        {
+            Profiler::Get().addCounter("effectCacheHits", m_effectCacheHits);
+            Profiler::Get().addCounter("effectCacheMisses", m_effectCacheMisses);
+            m_log << "Effect cache: " << m_effectCacheHits << " hit(s), " << m_effectCacheMisses << " miss(es)" << std::endl;
+        }
 
+        return m_renderGroup;
+    }
 
-        ramses::MeshNode* meshNode = m_scene.createMeshNode("Suzanne");
-        meshNode->setAppearance(*appearance);
-        meshNode->setGeometryBinding(*geometry);
+    ReloadStatistics ObjImporter::reload(ObjImporter& reloaded)
+    {
+        ScopedTimer timer("scene.reload");
+        ReloadStatistics statistics;
+        const size_t createdArrays = m_createdArrayCount;
+        const size_t destroyedArrays = m_destroyedArrayCount;
+
+        vector<ObjGeometry::indexed_mesh> meshes = std::move(reloaded.m_meshes);
+        m_use32BitIndices = reloaded.m_use32BitIndices;
+
+        std::map<std::string, size_t> previousByName;
+        for (size_t i = 0; i < m_meshes.size(); ++i)
+            previousByName[m_meshes[i].name] = i;
+
+        std::vector<ShaderVariant> variants(meshes.size());
+        for (size_t i = 0; i < meshes.size(); ++i)
+            variants[i] = getShaderVariant(meshes[i]);
+
+        // new nodes are created before the old ones are released, so arrays both use are not recreated
+        vector<ramses::MeshNode*> nodes(meshes.size(), nullptr);
+        vector<MeshResources> resources(meshes.size());
+        std::vector<bool> kept(m_meshes.size(), false);
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            const ObjGeometry::indexed_mesh& mesh = meshes[i];
+            auto previous = previousByName.find(mesh.name);
+            if (previous != previousByName.end() && !kept[previous->second])
+            {
+                const size_t index = previous->second;
+                const MeshResources& previousResources = m_meshResources[index];
+                if (m_meshes[index].material == mesh.material && previousResources.variant == variants[i] &&
+                    previousResources.arrays == getArrayKeys(mesh, variants[i].second))
+                {
+                    kept[index] = true;
+                    nodes[i] = m_meshNodes[index];
+                    resources[i] = previousResources;
+                    ++statistics.keptMeshes;
+                    continue;
+                }
+            }
 
-        // mesh needs to be added to a render group that belongs to a render pass with camera in order to be rendered
-        ramses::RenderGroup* renderGroup = m_scene.createRenderGroup();
-        renderGroup->addMeshNode(*meshNode);
+            nodes[i] = createMeshNode(mesh, variants[i], resources[i]);
+            ++statistics.createdMeshes;
+        }
 
-        ramses::UniformInput colorInput;
-        effect->findUniformInput("color", colorInput);
-        appearance->setInputValueVector4f(colorInput, 0.9f, 0.0f, 0.0f, 1.0);
+        for (size_t i = 0; i < m_meshes.size(); ++i)
+        {
+            m_renderGroup->removeMeshNode(*m_meshNodes[i]);
+            if (!kept[i])
+            {
+                releaseMesh(*m_meshNodes[i], m_meshResources[i]);
+                ++statistics.removedMeshes;
+            }
+        }
+
+        // kept nodes may have been switched by the viewer, all start over like after getRamsesRenderGroup
+        const std::vector<size_t> drawOrder = getDrawOrder(meshes, variants);
+        for (size_t order = 0; order < drawOrder.size(); ++order)
+        {
+            const size_t index = drawOrder[order];
+            nodes[index]->setVisibility(0 == meshes[index].lod);
+            m_renderGroup->addMeshNode(*nodes[index], static_cast<int32_t>(order));
+        }
+
+        m_meshes = std::move(meshes);
+        m_meshNodes.swap(nodes);
+        m_meshResources.swap(resources);
+
+        statistics.createdArrays = m_createdArrayCount - createdArrays;
+        statistics.destroyedArrays = m_destroyedArrayCount - destroyedArrays;
+        return statistics;
+    }
+
+    void ObjImporter::destroyResources()
+    {
+        std::set<const ramses::Resource*> effects;
+        for (const auto& effect : m_effects)
+        {
+            effects.insert(effect.second);
+            m_effectCache.releaseEffect(*effect.second);
+        }
+        m_effects.clear();
 
-        return renderGroup;
+        for (auto resource : m_resources)
+        {
+            if (0 == effects.count(resource))
+                m_client.destroy(*resource);
+        }
+        m_resources.clear();
+        m_arrays.clear();
+        m_textureResources.clear();
     }
 
-    int ObjImporter::computeIndexCount()
+    /**
+     * @brief Collects the sizes of the arrays and textures behind the mesh nodes and who shares them.
+     *
+     * The array layouts follow createMeshNode(). Effects are only counted, the client API does not
+     * tell the size of compiled shaders.
+     */
+    SceneFootprint ObjImporter::getFootprint() const
     {
-        int index_sz = 0;
+        SceneFootprint footprint;
+        footprint.effectCount = m_effects.size();
+
+        const uint64_t alignment = SceneFootprint::GpuBufferAlignment;
+        std::map<uint64_t, size_t> resourceByArray;
+        std::map<uint64_t, size_t> resourceByTexture;
+        auto addUser = [&footprint](MeshFootprint& mesh, std::map<uint64_t, size_t>& resources, uint64_t key, const ramses::Resource* ramsesResource,
+            const std::string& name, const char* type, uint64_t bytes, uint64_t gpuBytes)
+        {
+            auto inserted = resources.insert(std::make_pair(key, footprint.resources.size()));
+            if (inserted.second)
+            {
+                ResourceFootprint resource;
+                resource.resource = ramsesResource;
+                resource.name = name;
+                resource.type = type;
+                resource.bytes = bytes;
+                resource.gpuBytes = gpuBytes;
+                footprint.resources.push_back(resource);
+            }
+            ++footprint.resources[inserted.first->second].users;
+            mesh.resources.push_back(inserted.first->second);
+        };
 
-        /* for each face count every vertex */
-        for(const auto& f: faces)
-            for(const auto& v : f.v)
-                ++index_sz;
+        for (size_t i = 0; i < m_meshResources.size(); ++i)
+        {
+            const ObjGeometry::indexed_mesh& mesh = m_meshes[i];
+            const MeshResources& resources = m_meshResources[i];
+
+            MeshFootprint meshFootprint;
+            meshFootprint.name = mesh.name;
+            meshFootprint.vertexCount = static_cast<uint32_t>(mesh.vertex_count());
+            meshFootprint.indexCount = static_cast<uint32_t>(mesh.indices.size());
+            meshFootprint.indexWidth = m_use32BitIndices ? 32u : 16u;
+
+            // same order as getArrayKeys()
+            std::vector<std::pair<const char*, uint64_t>> arrays;
+            arrays.push_back(std::make_pair(m_use32BitIndices ? "indices32" : "indices16", uint64_t(meshFootprint.indexCount) * meshFootprint.indexWidth / 8u));
+            arrays.push_back(std::make_pair("positions", uint64_t(meshFootprint.vertexCount) * 3u * sizeof(float)));
+            if (!mesh.normals.empty())
+                arrays.push_back(std::make_pair("normals", uint64_t(meshFootprint.vertexCount) * 3u * sizeof(float)));
+            if (resources.variant.second)
+                arrays.push_back(std::make_pair("texCoords", uint64_t(meshFootprint.vertexCount) * 2u * sizeof(float)));
+            assert(arrays.size() == resources.arrays.size());
+
+            for (size_t a = 0; a < arrays.size(); ++a)
+            {
+                const uint64_t bytes = arrays[a].second;
+                auto array = m_arrays.find(resources.arrays[a]);
+                addUser(meshFootprint, resourceByArray, resources.arrays[a], (array != m_arrays.end()) ? array->second.resource : nullptr, mesh.name + "." + arrays[a].first, arrays[a].first, bytes,
+                    (bytes + alignment - 1u) / alignment * alignment);
+            }
+
+            const Material* material = findMaterial(mesh.material);
+            if (resources.variant.second && nullptr != material)
+            {
+                const size_t requested = m_textureLoader.find(material->diffuseTexture);
+                if (requested < m_textureLoader.getTextureCount())
+                {
+                    const DecodedTexture& texture = m_textureLoader.getTexture(m_textureLoader.getTexture(requested).duplicateOf);
+                    const uint64_t bytes = uint64_t(texture.width) * texture.height * 4u;
+                    // the mip chain adds a third
+                    auto resource = m_textureResources.find(texture.duplicateOf);
+                    addUser(meshFootprint, resourceByTexture, texture.duplicateOf, (resource != m_textureResources.end()) ? resource->second : nullptr, texture.path, "texture", bytes, bytes * 4u / 3u);
+                }
+            }
+
+            footprint.meshes.push_back(meshFootprint);
+        }
+
+        // most expensive resources first, the meshes refer to them by index
+        std::vector<size_t> order(footprint.resources.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&footprint](size_t a, size_t b) -> bool
+        {
+            return footprint.resources[a].gpuBytes > footprint.resources[b].gpuBytes;
+        });
+        std::vector<size_t> newIndex(order.size());
+        std::vector<ResourceFootprint> sortedResources;
+        sortedResources.reserve(order.size());
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            newIndex[order[i]] = i;
+            sortedResources.push_back(footprint.resources[order[i]]);
+        }
+        footprint.resources.swap(sortedResources);
 
-        return index_sz;
+        for (auto& mesh : footprint.meshes)
+        {
+            for (auto& index : mesh.resources)
+            {
+                index = newIndex[index];
+                const ResourceFootprint& resource = footprint.resources[index];
+                if (1u == resource.users)
+                    mesh.uniqueBytes += resource.bytes;
+                else
+                    mesh.sharedBytes += resource.bytes / resource.users;
+                mesh.gpuBytes += resource.gpuBytes / resource.users;
+                footprint.unsharedBytes += resource.bytes;
+            }
+        }
+        std::stable_sort(footprint.meshes.begin(), footprint.meshes.end(), [](const MeshFootprint& a, const MeshFootprint& b) -> bool
+        {
+            return a.gpuBytes > b.gpuBytes;
+        });
 
+        for (const auto& resource : footprint.resources)
+        {
+            if (1u == resource.users)
+                footprint.uniqueBytes += resource.bytes;
+            else
+                footprint.sharedBytes += resource.bytes;
+            footprint.gpuBytes += resource.gpuBytes;
+        }
+        return footprint;
     }
 
-    vector<uint16_t> ObjImporter::getIndexArray()
+    ObjImporter::ShaderVariant ObjImporter::getShaderVariant(const ObjGeometry::indexed_mesh& mesh)
     {
-        vector<uint16_t> ret{};
+        return std::make_pair(!mesh.normals.empty(), !mesh.tex_coords.empty() && nullptr != getTextureSampler(mesh.material));
+    }
 
-        for(const auto& f: faces) {
-            for(const auto& v : f.v){
-                ret.push_back(v);
-            }
+    ramses::Appearance& ObjImporter::getAppearance(const ShaderVariant& variant, const std::string& material, const ramses::Effect*& effect)
+    {
+        effect = m_effects[variant];
+        if (nullptr == effect)
+        {
+            effect = createEffect(variant.first, variant.second);
+            m_effects[variant] = effect;
         }
 
-        return ret;
+        ramses::Appearance*& appearance = m_appearances[std::make_pair(variant, material)];
+        if (nullptr == appearance)
+            appearance = createAppearance(*effect, material, variant.second ? getTextureSampler(material) : nullptr);
+        return *appearance;
+    }
+
+    vector<size_t> ObjImporter::getDrawOrder(const vector<ObjGeometry::indexed_mesh>& meshes, const vector<ShaderVariant>& variants)
+    {
+        std::vector<size_t> drawOrder(variants.size());
+        for (size_t i = 0; i < drawOrder.size(); ++i)
+            drawOrder[i] = i;
+
+        std::stable_sort(drawOrder.begin(), drawOrder.end(), [&meshes, &variants](size_t a, size_t b) -> bool
+        {
+            if (variants[a] != variants[b])
+                return variants[a] < variants[b];
+            return meshes[a].material < meshes[b].material;
+        });
+        return drawOrder;
     }
 
-    vector<float> ObjImporter::getVertexArray()
+    /**
+     * @brief Creates the texture resource and sampler of the diffuse texture of a material on first use.
+     *
+     * Waits for the background decoding the first time, which has usually finished while the
+     * geometry was processed. Textures with the same file content share one resource.
+     */
+    const ramses::TextureSampler* ObjImporter::getTextureSampler(const std::string& materialName)
+    {
+        const Material* material = findMaterial(materialName);
+        if (nullptr == material || material->diffuseTexture.empty())
+            return nullptr;
+
+        if (m_textureSamplers.empty())
+        {
+            ScopedTimer timer("scene.waitForTextures");
+            m_textureLoader.wait();
+        }
+
+        const size_t requested = m_textureLoader.request(material->diffuseTexture);
+        const size_t index = m_textureLoader.getTexture(requested).duplicateOf;
+        auto inserted = m_textureSamplers.insert(std::make_pair(index, static_cast<const ramses::TextureSampler*>(nullptr)));
+        if (!inserted.second)
+            return inserted.first->second;
+
+        const DecodedTexture& texture = m_textureLoader.getTexture(index);
+        if (!texture.valid)
+        {
+            std::cerr << "Cannot load texture " << texture.path << " of material " << materialName << ": " << texture.error << std::endl;
+            return nullptr;
+        }
+
+        ScopedTimer timer("scene.createTextures");
+        const ramses::MipLevelData mipLevel(static_cast<uint32_t>(texture.pixels.size()), texture.pixels.data());
+        const ramses::Texture2D* resource = m_client.createTexture2D(texture.width, texture.height, ramses::ETextureFormat_RGBA8, 1, &mipLevel, true,
+            ramses::ResourceCacheFlag_DoNotCache, texture.path.c_str());
+        m_resources.push_back(resource);
+        m_textureResources[index] = resource;
+
+        inserted.first->second = m_scene.createTextureSampler(ramses::ETextureAddressMode_Repeat, ramses::ETextureAddressMode_Repeat,
+            ramses::ETextureSamplingMethod_Linear_MipMapLinear, ramses::ETextureSamplingMethod_Linear, *resource);
+        return inserted.first->second;
+    }
+
+    ramses::Appearance* ObjImporter::createAppearance(const ramses::Effect& effect, const std::string& materialName, const ramses::TextureSampler* sampler)
+    {
+        ramses::Appearance* appearance = m_scene.createAppearance(effect, materialName.c_str());
+
+        // meshes without a material definition keep the red which shows them in any case
+        const Material* material = findMaterial(materialName);
+        ramses::UniformInput colorInput;
+        effect.findUniformInput("color", colorInput);
+        if (nullptr == material)
+            appearance->setInputValueVector4f(colorInput, 0.9f, 0.0f, 0.0f, 1.0);
+        else
+            appearance->setInputValueVector4f(colorInput, material->diffuse[0], material->diffuse[1], material->diffuse[2], material->opacity);
+
+        if (nullptr != material && material->opacity < 1.0f)
+        {
+            appearance->setBlendingOperations(ramses::EBlendOperation_Add, ramses::EBlendOperation_Add);
+            appearance->setBlendingFactors(ramses::EBlendFactor_SrcAlpha, ramses::EBlendFactor_OneMinusSrcAlpha, ramses::EBlendFactor_One, ramses::EBlendFactor_OneMinusSrcAlpha);
+        }
+
+        if (nullptr != sampler)
+        {
+            ramses::UniformInput textureInput;
+            effect.findUniformInput("u_texture", textureInput);
+            appearance->setInputTexture(textureInput, *sampler);
+        }
+
+        return appearance;
+    }
+
+    /**
+     * @brief Content hashes of the index and vertex arrays of a mesh, in the order createMeshNode() uses them.
+     *
+     * The array type is the seed, so equal bytes in arrays of different types do not share a resource.
+     */
+    vector<uint64_t> ObjImporter::getArrayKeys(const ObjGeometry::indexed_mesh& mesh, bool hasTexture) const
+    {
+        enum EArrayType : uint64_t
+        {
+            EArrayType_UInt32Indices = 1,
+            EArrayType_UInt16Indices,
+            EArrayType_Positions,
+            EArrayType_Normals,
+            EArrayType_TexCoords
+        };
+
+        vector<uint64_t> keys;
+        keys.push_back(GeometryCache::Hash(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned),
+            m_use32BitIndices ? EArrayType_UInt32Indices : EArrayType_UInt16Indices));
+        keys.push_back(GeometryCache::Hash(mesh.positions.data(), mesh.positions.size() * sizeof(float), EArrayType_Positions));
+        if (!mesh.normals.empty())
+            keys.push_back(GeometryCache::Hash(mesh.normals.data(), mesh.normals.size() * sizeof(float), EArrayType_Normals));
+        if (hasTexture)
+            keys.push_back(GeometryCache::Hash(mesh.tex_coords.data(), mesh.tex_coords.size() * sizeof(float), EArrayType_TexCoords));
+        return keys;
+    }
+
+    /* the array with this content hash, created by create() if no mesh uses one yet */
+    template <typename ArrayType, typename Create>
+    const ArrayType* ObjImporter::getArray(uint64_t key, Create create)
+    {
+        auto inserted = m_arrays.insert(std::make_pair(key, SharedArray{ nullptr, 0u }));
+        SharedArray& array = inserted.first->second;
+        if (inserted.second)
+        {
+            array.resource = create();
+            m_resources.push_back(array.resource);
+            ++m_createdArrayCount;
+        }
+        ++array.users;
+        return static_cast<const ArrayType*>(array.resource);
+    }
+
+    ramses::MeshNode* ObjImporter::createMeshNode(const ObjGeometry::indexed_mesh& mesh, const ShaderVariant& variant, MeshResources& resources)
     {
-        vector<float> ret{};
+        const ramses::Effect* effect = nullptr;
+        ramses::Appearance& appearance = getAppearance(variant, mesh.material, effect);
+
+        ScopedTimer timer("scene.createArrays");
+        ramses::GeometryBinding* geometry = m_scene.createGeometryBinding(*effect);
+        resources.geometry = geometry;
+        resources.variant = variant;
+        resources.arrays = getArrayKeys(mesh, variant.second);
+        auto key = resources.arrays.begin();
+
+        const uint32_t index_sz = static_cast<uint32_t>(computeIndexCount(mesh));
+        if (m_use32BitIndices)
+        {
+            const ramses::UInt32Array* rIdxArray = getArray<ramses::UInt32Array>(*key++, [&]()
+            {
+                return m_client.createConstUInt32Array(index_sz, mesh.indices.data());
+            });
+            geometry->setIndices(*rIdxArray);
+        }
+        else
+        {
+            const ramses::UInt16Array* rIdxArray = getArray<ramses::UInt16Array>(*key++, [&]()
+            {
+                auto indices = getIndexArray(mesh);
+                return m_client.createConstUInt16Array(index_sz, indices.data());
+            });
+            geometry->setIndices(*rIdxArray);
+        }
+
+        const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertex_count());
+
+        ramses::AttributeInput positionsInput;
+        effect->findAttributeInput("a_position", positionsInput);
+
+        // ramses copies the data, so the positions can be passed without another copy
+        const ramses::Vector3fArray* rVertexData = getArray<ramses::Vector3fArray>(*key++, [&]()
+        {
+            return m_client.createConstVector3fArray(vertexCount, mesh.positions.data());
+        });
+        geometry->setInputBuffer(positionsInput, *rVertexData);
+
+        if (!mesh.normals.empty())
+        {
+            ramses::AttributeInput normalsInput;
+            effect->findAttributeInput("a_normal", normalsInput);
+
+            const ramses::Vector3fArray* rNormalData = getArray<ramses::Vector3fArray>(*key++, [&]()
+            {
+                return m_client.createConstVector3fArray(vertexCount, mesh.normals.data());
+            });
+            geometry->setInputBuffer(normalsInput, *rNormalData);
+        }
+
+        if (variant.second)
+        {
+            ramses::AttributeInput texCoordsInput;
+            effect->findAttributeInput("a_texCoord", texCoordsInput);
+
+            const ramses::Vector2fArray* rTexCoordData = getArray<ramses::Vector2fArray>(*key++, [&]()
+            {
+                return m_client.createConstVector2fArray(vertexCount, mesh.tex_coords.data());
+            });
+            geometry->setInputBuffer(texCoordsInput, *rTexCoordData);
+        }
+
+        ramses::MeshNode* meshNode = m_scene.createMeshNode(mesh.name.c_str());
+        meshNode->setAppearance(appearance);
+        meshNode->setGeometryBinding(*geometry);
+
+        return meshNode;
+    }
 
-        for(const auto& v : vertices){
-            ret.push_back(v.x);
-            ret.push_back(v.y);
-            ret.push_back(v.z);
+    /* destroys the node and its geometry binding, and the arrays no other mesh uses */
+    void ObjImporter::releaseMesh(ramses::MeshNode& node, MeshResources& resources)
+    {
+        m_scene.destroy(node);
+        m_scene.destroy(*resources.geometry);
+        for (auto key : resources.arrays)
+        {
+            auto array = m_arrays.find(key);
+            if (array == m_arrays.end() || 0 != --array->second.users)
+                continue;
+
+            m_resources.erase(std::remove(m_resources.begin(), m_resources.end(), array->second.resource), m_resources.end());
+            m_client.destroy(*array->second.resource);
+            m_arrays.erase(array);
+            ++m_destroyedArrayCount;
         }
+        resources.arrays.clear();
+    }
+
+    int ObjImporter::computeIndexCount(const ObjGeometry::indexed_mesh& mesh)
+    {
+        return static_cast<int>(mesh.indices.size());
+    }
+
+    vector<uint16_t> ObjImporter::getIndexArray(const ObjGeometry::indexed_mesh& mesh)
+    {
+        vector<uint16_t> ret{};
+        ret.reserve(mesh.indices.size());
+
+        for (auto index : mesh.indices)
+            ret.push_back(static_cast<uint16_t>(index));
 
         return ret;
     }
+
+    vector<float> ObjImporter::getVertexArray(const ObjGeometry::indexed_mesh& mesh)
+    {
+        return mesh.positions;
+    }
 }
@@ -0,0 +1,579 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "ObjParser.h"
+#include "NumberParser.h"
+
+#include <iostream>
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+
+namespace obj2ramses
+{
+    using ObjGeometry::vertex3f;
+    using ObjGeometry::tex_coord_3f;
+    using ObjGeometry::vertex_normal_3f;
+    using ObjGeometry::face_store;
+    using ObjGeometry::invalid_index;
+
+    namespace
+    {
+        inline bool isBlank(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+        }
+
+        /* Returns the next whitespace separated token and advances 'rest' behind it */
+        StringRange nextToken(StringRange& rest)
+        {
+            const char* it = rest.begin;
+            while (it != rest.end && isBlank(*it))
+                ++it;
+
+            const char* tokenBegin = it;
+            while (it != rest.end && !isBlank(*it))
+                ++it;
+
+            rest.begin = it;
+            return StringRange(tokenBegin, it);
+        }
+
+        /* The whole token has to be a number, "1.5abc" is as malformed as "abc" */
+        bool parseFloat(StringRange token, float& value)
+        {
+            const ParseResult result = NumberParser::parseFloat(token.begin, token.end, value);
+            return EParseError_None == result.error && result.ptr == token.end;
+        }
+
+        /* Chunks below this size are not worth a thread of their own */
+        const size_t MinimumChunkSize = 256 * 1024;
+    }
+
+    ObjParser::ObjParser(ObjGeometry::mesh_data& data)
+        : ObjParser(data, false)
+    {
+    }
+
+    ObjParser::ObjParser(ObjGeometry::mesh_data& data, bool deferRelativeIndices)
+        : m_data(data)
+        , m_deferRelativeIndices(deferRelativeIndices)
+    {
+    }
+
+    void ObjParser::parse(const char* begin, const char* end)
+    {
+        reserve(countRecords(begin, end));
+
+        const char* lineBegin = begin;
+        while (lineBegin < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', static_cast<size_t>(end - lineBegin)));
+            if (nullptr == lineEnd)
+                lineEnd = end;
+
+            ++m_lineCount;
+            parseLine(StringRange(lineBegin, lineEnd));
+
+            lineBegin = lineEnd + 1;
+        }
+    }
+
+    void ObjParser::parseParallel(const char* begin, const char* end, unsigned threadCount)
+    {
+        const size_t size = static_cast<size_t>(end - begin);
+        size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, size / MinimumChunkSize));
+        if (chunkCount == 1)
+        {
+            parse(begin, end);
+            return;
+        }
+
+        // cut at the first line break after each nominal chunk boundary
+        std::vector<const char*> boundaries;
+        boundaries.push_back(begin);
+        for (size_t i = 1; i < chunkCount; ++i)
+        {
+            const char* cut = std::max(begin + size / chunkCount * i, boundaries.back());
+            const char* lineEnd = static_cast<const char*>(std::memchr(cut, '\n', static_cast<size_t>(end - cut)));
+            if (nullptr == lineEnd)
+                break;
+            if (lineEnd + 1 != boundaries.back())
+                boundaries.push_back(lineEnd + 1);
+        }
+        boundaries.push_back(end);
+        chunkCount = boundaries.size() - 1;
+
+        std::vector<ObjGeometry::mesh_data> chunks(chunkCount);
+        std::vector<std::unique_ptr<ObjParser>> parsers;
+        for (auto& chunk : chunks)
+            parsers.emplace_back(new ObjParser(chunk, true));
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < chunkCount; ++i)
+            threads.emplace_back([&parsers, &boundaries, i]() { parsers[i]->parse(boundaries[i], boundaries[i + 1]); });
+        parsers[0]->parse(boundaries[0], boundaries[1]);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        RecordCounts total;
+        for (const auto& chunk : chunks)
+        {
+            total.vertices += chunk.vertices.size();
+            total.texCoords += chunk.tex_coords.size();
+            total.normals += chunk.normals.size();
+            total.faces += chunk.faces.size();
+            total.corners += chunk.faces.corner_count();
+            total.hasTexCoordIndices = total.hasTexCoordIndices || !chunk.faces.vt.empty();
+            total.hasNormalIndices = total.hasNormalIndices || !chunk.faces.vn.empty();
+        }
+        reserve(total);
+
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            mergeChunk(chunks[i], *parsers[i]);
+            // release the chunk right away, otherwise the whole geometry is held twice at the end
+            chunks[i] = ObjGeometry::mesh_data();
+        }
+    }
+
+    void ObjParser::mergeChunk(ObjGeometry::mesh_data& chunk, const ObjParser& chunkParser)
+    {
+        const size_t lineBase = m_lineCount;
+        const long long bases[] = {
+            static_cast<long long>(m_data.vertices.size()),
+            static_cast<long long>(m_data.tex_coords.size()),
+            static_cast<long long>(m_data.normals.size())
+        };
+
+        m_data.vertices.insert(m_data.vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+        m_data.tex_coords.insert(m_data.tex_coords.end(), chunk.tex_coords.begin(), chunk.tex_coords.end());
+        m_data.normals.insert(m_data.normals.end(), chunk.normals.begin(), chunk.normals.end());
+
+        face_store& faces = m_data.faces;
+        const size_t faceBase = faces.size();
+        const size_t cornerBase = faces.v.size();
+        const size_t chunkCorners = chunk.faces.v.size();
+
+        faces.v.insert(faces.v.end(), chunk.faces.v.begin(), chunk.faces.v.end());
+        appendCornerIndices(faces.vt, cornerBase, !chunk.faces.vt.empty(), chunk.faces.vt);
+        appendCornerIndices(faces.vn, cornerBase, !chunk.faces.vn.empty(), chunk.faces.vn);
+        if (!faces.vt.empty())
+            faces.vt.resize(cornerBase + chunkCorners, invalid_index);
+        if (!faces.vn.empty())
+            faces.vn.resize(cornerBase + chunkCorners, invalid_index);
+
+        faces.offsets.reserve(faces.offsets.size() + chunk.faces.size());
+        for (size_t i = 1; i < chunk.faces.offsets.size(); ++i)
+            faces.offsets.push_back(static_cast<unsigned>(cornerBase) + chunk.faces.offsets[i]);
+        faces.triangle_count += chunk.faces.triangle_count;
+
+        for (const auto& relative : chunkParser.m_relativeIndices)
+        {
+            const long long index = bases[relative.type] + relative.localIndex;
+            if (index < 0)
+            {
+                reportError("malformed face", lineBase + relative.line);
+                continue;
+            }
+
+            ObjGeometry::index_vector& indices = (EIndexType_Vertex == relative.type) ? faces.v : (EIndexType_TexCoord == relative.type) ? faces.vt : faces.vn;
+            indices[cornerBase + relative.corner] = static_cast<unsigned>(index);
+        }
+
+        for (auto& change : chunk.name_changes)
+        {
+            change.first_face += faceBase;
+            m_data.name_changes.push_back(std::move(change));
+        }
+
+        for (const auto& skipped : chunkParser.m_skippedRecords)
+            skipRecord(StringRange(skipped.type.data(), skipped.type.data() + skipped.type.size()), skipped.count);
+
+        if (0 != chunkParser.m_errorCount)
+        {
+            reportError(chunkParser.m_firstError.c_str(), lineBase + chunkParser.m_firstErrorLine);
+            m_errorCount += chunkParser.m_errorCount - 1;
+        }
+
+        m_lineCount += chunkParser.m_lineCount;
+    }
+
+    size_t ObjParser::tokenize(StringRange line, StringRange* tokens, size_t maxTokens, char delim)
+    {
+        size_t count = 0;
+
+        if (delim == ' ')
+        {
+            StringRange rest = line;
+            for (;;)
+            {
+                StringRange token = nextToken(rest);
+                if (token.empty())
+                    break;
+                if (count < maxTokens)
+                    tokens[count] = token;
+                ++count;
+            }
+            return count;
+        }
+
+        const char* tokenBegin = line.begin;
+        for (const char* it = line.begin; ; ++it)
+        {
+            if (it == line.end || *it == delim)
+            {
+                if (count < maxTokens)
+                    tokens[count] = StringRange(tokenBegin, it);
+                ++count;
+
+                if (it == line.end)
+                    break;
+                tokenBegin = it + 1;
+            }
+        }
+        return count;
+    }
+
+    std::vector<std::string> ObjParser::findMaterialLibraries(const char* begin, const char* end)
+    {
+        // only lines starting with 'm' can be mtllib records, numbers never contain one
+        std::vector<std::string> libraries;
+        const char* it = begin;
+        while (it < end)
+        {
+            const char* m = static_cast<const char*>(std::memchr(it, 'm', static_cast<size_t>(end - it)));
+            if (nullptr == m)
+                break;
+            it = m + 1;
+
+            const char* lineBegin = m;
+            while (lineBegin != begin && isBlank(lineBegin[-1]))
+                --lineBegin;
+            if (lineBegin != begin && '\n' != lineBegin[-1])
+                continue;
+            if (static_cast<size_t>(end - m) < 7 || 0 != std::memcmp(m, "mtllib", 6) || !isBlank(m[6]))
+                continue;
+
+            const char* lineEnd = static_cast<const char*>(std::memchr(m, '\n', static_cast<size_t>(end - m)));
+            if (nullptr == lineEnd)
+                lineEnd = end;
+            StringRange rest(m + 6, lineEnd);
+            for (StringRange token = nextToken(rest); !token.empty(); token = nextToken(rest))
+            {
+                if ('#' == *token.begin)
+                    break;
+                const std::string library(token.begin, token.end);
+                if (std::find(libraries.begin(), libraries.end(), library) == libraries.end())
+                    libraries.push_back(library);
+            }
+            it = lineEnd;
+        }
+        return libraries;
+    }
+
+    RecordCounts ObjParser::countRecords(const char* begin, const char* end)
+    {
+        RecordCounts counts;
+
+        const char* lineBegin = begin;
+        while (lineBegin < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', static_cast<size_t>(end - lineBegin)));
+            if (nullptr == lineEnd)
+                lineEnd = end;
+
+            const char* it = lineBegin;
+            while (it != lineEnd && isBlank(*it))
+                ++it;
+            lineBegin = lineEnd + 1;
+
+            // the record type is all that matters for v, vt and vn
+            const size_t length = static_cast<size_t>(lineEnd - it);
+            if (length < 2)
+                continue;
+            if ('v' == it[0])
+            {
+                if (isBlank(it[1]))
+                    ++counts.vertices;
+                else if ('t' == it[1] && length > 2 && isBlank(it[2]))
+                    ++counts.texCoords;
+                else if ('n' == it[1] && length > 2 && isBlank(it[2]))
+                    ++counts.normals;
+                continue;
+            }
+            if ('f' != it[0] || !isBlank(it[1]))
+                continue;
+
+            // faces: one corner per token, slashes tell whether texture coordinates and normals are used
+            ++counts.faces;
+            for (it += 2; it != lineEnd && '#' != *it; )
+            {
+                if (isBlank(*it))
+                {
+                    ++it;
+                    continue;
+                }
+
+                ++counts.corners;
+                const char* tokenBegin = it;
+                while (it != lineEnd && !isBlank(*it) && '#' != *it)
+                    ++it;
+
+                const char* slash = static_cast<const char*>(std::memchr(tokenBegin, '/', static_cast<size_t>(it - tokenBegin)));
+                if (nullptr == slash)
+                    continue;
+                counts.hasTexCoordIndices = counts.hasTexCoordIndices || (slash + 1 != it && '/' != slash[1]);
+                const char* secondSlash = static_cast<const char*>(std::memchr(slash + 1, '/', static_cast<size_t>(it - slash - 1)));
+                counts.hasNormalIndices = counts.hasNormalIndices || (nullptr != secondSlash && secondSlash + 1 != it);
+            }
+        }
+
+        return counts;
+    }
+
+    void ObjParser::reserve(const RecordCounts& counts)
+    {
+        m_data.vertices.reserve(m_data.vertices.size() + counts.vertices);
+        m_data.tex_coords.reserve(m_data.tex_coords.size() + counts.texCoords);
+        m_data.normals.reserve(m_data.normals.size() + counts.normals);
+
+        // vt and vn are kept parallel to v once a face uses them
+        face_store& faces = m_data.faces;
+        const size_t corners = faces.v.size() + counts.corners;
+        faces.v.reserve(corners);
+        if (counts.hasTexCoordIndices || !faces.vt.empty())
+            faces.vt.reserve(corners);
+        if (counts.hasNormalIndices || !faces.vn.empty())
+            faces.vn.reserve(corners);
+        faces.offsets.reserve(faces.offsets.size() + counts.faces);
+    }
+
+    void ObjParser::parseLine(StringRange line)
+    {
+        // drop comments, they may also trail a record
+        const char* comment = static_cast<const char*>(std::memchr(line.begin, '#', line.size()));
+        if (nullptr != comment)
+            line.end = comment;
+
+        StringRange rest = line;
+        const StringRange dtype = nextToken(rest);
+        if (dtype.empty())
+            return;
+
+        if (dtype.equals("v"))
+        {
+            StringRange tokens[3];
+            vertex3f v;
+            if (tokenize(rest, tokens, 3) < 3 ||
+                !parseFloat(tokens[0], v.x) || !parseFloat(tokens[1], v.y) || !parseFloat(tokens[2], v.z))
+            {
+                reportError("malformed vertex", m_lineCount);
+                return;
+            }
+            m_data.vertices.push_back(v);
+        }
+        else if (dtype.equals("vt"))
+        {
+            StringRange tokens[3];
+            tex_coord_3f vt;
+            const size_t tokenCount = tokenize(rest, tokens, 3);
+            if (tokenCount < 1 ||
+                !parseFloat(tokens[0], vt.u) ||
+                (tokenCount >= 2 && !parseFloat(tokens[1], vt.v)) ||
+                (tokenCount >= 3 && !parseFloat(tokens[2], vt.w)))
+            {
+                reportError("malformed texture coordinate", m_lineCount);
+                return;
+            }
+            m_data.tex_coords.push_back(vt);
+        }
+        else if (dtype.equals("vn"))
+        {
+            StringRange tokens[3];
+            vertex_normal_3f vn;
+            if (tokenize(rest, tokens, 3) < 3 ||
+                !parseFloat(tokens[0], vn.x) || !parseFloat(tokens[1], vn.y) || !parseFloat(tokens[2], vn.z))
+            {
+                reportError("malformed normal", m_lineCount);
+                return;
+            }
+            m_data.normals.push_back(vn);
+        }
+        else if (dtype.equals("f"))
+        {
+            parseFace(rest);
+        }
+        else if (dtype.equals("o"))
+        {
+            addNameChange(ObjGeometry::name_object, rest);
+        }
+        else if (dtype.equals("g"))
+        {
+            addNameChange(ObjGeometry::name_group, rest);
+        }
+        else if (dtype.equals("usemtl"))
+        {
+            addNameChange(ObjGeometry::name_material, rest);
+        }
+        else if (dtype.equals("mtllib"))
+        {
+            // loaded by the importer before parsing, see findMaterialLibraries()
+        }
+        else
+        {
+            // reported once per type by the importer, printing every line is slow on large files
+            skipRecord(dtype, 1u);
+        }
+    }
+
+    void ObjParser::addNameChange(ObjGeometry::name_kind kind, StringRange rest)
+    {
+        // the name is the rest of the line, "g" may list several groups
+        while (!rest.empty() && isBlank(*rest.begin))
+            ++rest.begin;
+        while (!rest.empty() && isBlank(*(rest.end - 1)))
+            --rest.end;
+
+        ObjGeometry::name_change change = { m_data.faces.size(), kind, std::string(rest.begin, rest.end) };
+        m_data.name_changes.push_back(std::move(change));
+    }
+
+    void ObjParser::skipRecord(StringRange type, size_t count)
+    {
+        for (auto& skipped : m_skippedRecords)
+        {
+            if (type.size() == skipped.type.size() && 0 == std::memcmp(type.begin, skipped.type.data(), type.size()))
+            {
+                skipped.count += count;
+                return;
+            }
+        }
+
+        SkippedRecords skipped = { std::string(type.begin, type.end), count };
+        m_skippedRecords.push_back(skipped);
+    }
+
+    void ObjParser::parseFace(StringRange rest)
+    {
+        face_store& faces = m_data.faces;
+        const size_t firstCorner = faces.v.size();
+        const size_t relativeIndexCount = m_relativeIndices.size();
+        bool hasTexCoords = false;
+        bool hasNormals = false;
+
+        m_texCoordScratch.clear();
+        m_normalScratch.clear();
+
+        for (StringRange corner = nextToken(rest); !corner.empty(); corner = nextToken(rest))
+        {
+            // v, v/vt, v//vn or v/vt/vn
+            StringRange items[3];
+            const size_t itemCount = tokenize(corner, items, 3, '/');
+
+            unsigned v = invalid_index;
+            unsigned vt = invalid_index;
+            unsigned vn = invalid_index;
+
+            const size_t cornerIndex = faces.v.size();
+            if (itemCount > 3 ||
+                !parseIndex(items[0], EIndexType_Vertex, cornerIndex, v) ||
+                (itemCount >= 2 && !items[1].empty() && !parseIndex(items[1], EIndexType_TexCoord, cornerIndex, vt)) ||
+                (itemCount >= 3 && !parseIndex(items[2], EIndexType_Normal, cornerIndex, vn)))
+            {
+                faces.v.resize(firstCorner);
+                m_relativeIndices.resize(relativeIndexCount);
+                reportError("malformed face", m_lineCount);
+                return;
+            }
+
+            hasTexCoords = hasTexCoords || vt != invalid_index;
+            hasNormals = hasNormals || vn != invalid_index;
+
+            faces.v.push_back(v);
+            m_texCoordScratch.push_back(vt);
+            m_normalScratch.push_back(vn);
+        }
+
+        if (faces.v.size() - firstCorner < 3)
+        {
+            faces.v.resize(firstCorner);
+            m_relativeIndices.resize(relativeIndexCount);
+            reportError("face with less than three vertices", m_lineCount);
+            return;
+        }
+
+        appendCornerIndices(faces.vt, firstCorner, hasTexCoords, m_texCoordScratch);
+        appendCornerIndices(faces.vn, firstCorner, hasNormals, m_normalScratch);
+        faces.add_face();
+    }
+
+    void ObjParser::appendCornerIndices(ObjGeometry::index_vector& stream, size_t firstCorner, bool hasIndices, const ObjGeometry::index_vector& indices)
+    {
+        // streams stay empty as long as no face uses them, afterwards they are kept parallel to v
+        if (!hasIndices && stream.empty())
+            return;
+
+        stream.resize(firstCorner, invalid_index);
+        stream.insert(stream.end(), indices.begin(), indices.end());
+    }
+
+    bool ObjParser::parseIndex(StringRange token, EIndexType type, size_t corner, unsigned& index)
+    {
+        const bool negative = !token.empty() && *token.begin == '-';
+        const char* digits = negative ? token.begin + 1 : token.begin;
+
+        uint32_t value = 0;
+        const ParseResult result = NumberParser::parseUnsigned(digits, token.end, value);
+        if (EParseError_None != result.error || result.ptr != token.end || (negative && *digits == '+'))
+            return false;
+
+        if (0 == value)
+            return false;
+
+        if (negative)
+        {
+            // relative to the last element parsed so far, -1 is the most recent one
+            const size_t elementCount =
+                (EIndexType_Vertex == type) ? m_data.vertices.size() :
+                (EIndexType_TexCoord == type) ? m_data.tex_coords.size() :
+                m_data.normals.size();
+
+            if (m_deferRelativeIndices)
+            {
+                // the elements of preceding chunks are not known yet
+                const RelativeIndex relative = { corner, m_lineCount, type, static_cast<long long>(elementCount) - static_cast<long long>(value) };
+                m_relativeIndices.push_back(relative);
+                index = 0;
+                return true;
+            }
+
+            if (value > elementCount)
+                return false;
+            index = static_cast<unsigned>(elementCount - value);
+        }
+        else
+        {
+            index = static_cast<unsigned>(value - 1);
+        }
+
+        return true;
+    }
+
+    void ObjParser::reportError(const char* message, size_t line)
+    {
+        if (0 == m_errorCount || line < m_firstErrorLine)
+        {
+            m_firstError = message;
+            m_firstErrorLine = line;
+        }
+        ++m_errorCount;
+    }
+}
@@ -0,0 +1,234 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "Profiler.h"
+#include "JsonWriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#if defined(OBJ2RAMSES_COUNT_ALLOCATIONS)
+namespace
+{
+    std::atomic<uint64_t> AllocationCount(0u);
+    std::atomic<uint64_t> AllocatedBytes(0u);
+}
+
+void* operator new(std::size_t size)
+{
+    AllocationCount.fetch_add(1u, std::memory_order_relaxed);
+    AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    void* memory = std::malloc(0 == size ? 1 : size);
+    if (nullptr == memory)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+#endif
+
+namespace obj2ramses
+{
+    Profiler& Profiler::Get()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void Profiler::enable()
+    {
+        m_enabled = true;
+    }
+
+    void Profiler::addStage(const char* name, double milliseconds, uint64_t allocations, uint64_t allocatedBytes)
+    {
+        if (!m_enabled)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto stage = std::find_if(m_stages.begin(), m_stages.end(), [name](const Stage& s) { return s.name == name; });
+        if (stage == m_stages.end())
+        {
+            m_stages.push_back({ name, 0u, 0.0, 0.0, 0u, 0u });
+            stage = m_stages.end() - 1;
+        }
+
+        ++stage->calls;
+        stage->totalMilliseconds += milliseconds;
+        stage->maxMilliseconds = std::max(stage->maxMilliseconds, milliseconds);
+        stage->allocations += allocations;
+        stage->allocatedBytes += allocatedBytes;
+    }
+
+    void Profiler::addCounter(const char* name, uint64_t value)
+    {
+        if (!m_enabled)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto counter = std::find_if(m_counters.begin(), m_counters.end(), [name](const Counter& c) { return c.name == name; });
+        if (counter == m_counters.end())
+            m_counters.push_back({ name, value });
+        else
+            counter->value += value;
+    }
+
+    bool Profiler::writeReport(const std::string& fileName) const
+    {
+        std::ofstream stream(fileName);
+        JsonWriter json(stream);
+        // timer readings are not exact, all 17 digits of the milliseconds would be noise
+        json.setPrecision(10);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        json.beginObject();
+
+        json.key("stages").beginArray();
+        for (const auto& stage : m_stages)
+        {
+            json.beginObject();
+            json.key("name").value(stage.name);
+            json.key("calls").value(stage.calls);
+            json.key("totalMs").value(stage.totalMilliseconds);
+            json.key("maxMs").value(stage.maxMilliseconds);
+            if (IsAllocationCountingEnabled())
+            {
+                json.key("allocations").value(stage.allocations);
+                json.key("allocatedBytes").value(stage.allocatedBytes);
+            }
+            json.endObject();
+        }
+        json.endArray();
+
+        json.key("counters").beginObject();
+        for (const auto& counter : m_counters)
+            json.key(counter.name).value(counter.value);
+        json.endObject();
+
+        json.key("memory").beginObject();
+        json.key("peakRssBytes").value(GetPeakResidentSetSize());
+        json.key("allocationCounting").value(IsAllocationCountingEnabled());
+        if (IsAllocationCountingEnabled())
+        {
+            json.key("allocations").value(GetAllocationCount());
+            json.key("allocatedBytes").value(GetAllocatedBytes());
+        }
+        json.endObject();
+
+        json.endObject();
+        stream << std::endl;
+
+        if (!stream)
+        {
+            std::cerr << "Writing profile " << fileName << " failed" << std::endl;
+            return false;
+        }
+
+        std::cout << "Profile written to " << fileName << std::endl;
+        return true;
+    }
+
+    bool Profiler::IsAllocationCountingEnabled()
+    {
+#if defined(OBJ2RAMSES_COUNT_ALLOCATIONS)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    uint64_t Profiler::GetAllocationCount()
+    {
+#if defined(OBJ2RAMSES_COUNT_ALLOCATIONS)
+        return AllocationCount.load(std::memory_order_relaxed);
+#else
+        return 0u;
+#endif
+    }
+
+    uint64_t Profiler::GetAllocatedBytes()
+    {
+#if defined(OBJ2RAMSES_COUNT_ALLOCATIONS)
+        return AllocatedBytes.load(std::memory_order_relaxed);
+#else
+        return 0u;
+#endif
+    }
+
+    uint64_t Profiler::GetPeakResidentSetSize()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0u;
+        return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+#else
+        struct rusage usage;
+        if (0 != getrusage(RUSAGE_SELF, &usage))
+            return 0u;
+#if defined(__APPLE__)
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+        // kilobytes on Linux
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024u;
+#endif
+#endif
+    }
+
+    ScopedTimer::ScopedTimer(const char* stage)
+        : m_stage(stage)
+        , m_enabled(Profiler::Get().isEnabled())
+    {
+        if (!m_enabled)
+            return;
+
+        m_allocations = Profiler::GetAllocationCount();
+        m_allocatedBytes = Profiler::GetAllocatedBytes();
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    ScopedTimer::~ScopedTimer()
+    {
+        stop();
+    }
+
+    void ScopedTimer::stop()
+    {
+        if (!m_enabled)
+            return;
+        m_enabled = false;
+
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+        Profiler::Get().addStage(m_stage, milliseconds, Profiler::GetAllocationCount() - m_allocations, Profiler::GetAllocatedBytes() - m_allocatedBytes);
+    }
+}
@@ -0,0 +1,391 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "ProgramOptions.h"
+#include "FileUtils.h"
+#include "NumberParser.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <utility>
+
+namespace obj2ramses
+{
+    namespace
+    {
+        /* Returns the value following the option at argv[i] and skips it, or nullptr if there is none */
+        const char* takeValue(int argc, char* argv[], int& i)
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << argv[i] << std::endl;
+                return nullptr;
+            }
+            return argv[++i];
+        }
+
+        bool parseUnsigned(const char* option, const char* text, unsigned& value)
+        {
+            char* end = nullptr;
+            const unsigned long parsed = std::strtoul(text, &end, 10);
+            if (end == text || *end != '\0' || '-' == text[0])
+            {
+                std::cerr << "Invalid value '" << text << "' for " << option << std::endl;
+                return false;
+            }
+            value = static_cast<unsigned>(parsed);
+            return true;
+        }
+
+        bool parseFloat(const char* option, const char* text, float& value)
+        {
+            const char* end = text + std::strlen(text);
+            const ParseResult result = NumberParser::parseFloat(text, end, value);
+            if (EParseError_None != result.error || result.ptr != end)
+            {
+                std::cerr << "Invalid value '" << text << "' for " << option << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        /* comma separated values between 0 and maximum, e.g. "0.5,0.25" */
+        bool parseFloatList(const char* option, const char* text, float maximum, std::vector<float>& values)
+        {
+            values.clear();
+            const char* begin = text;
+            while (true)
+            {
+                const char* end = std::strchr(begin, ',');
+                if (nullptr == end)
+                    end = begin + std::strlen(begin);
+
+                float value = 0.0f;
+                const ParseResult result = NumberParser::parseFloat(begin, end, value);
+                if (EParseError_None != result.error || result.ptr != end || !(value >= 0.0f && value <= maximum))
+                {
+                    std::cerr << "Invalid value '" << text << "' for " << option << std::endl;
+                    return false;
+                }
+                values.push_back(value);
+
+                if ('\0' == *end)
+                    return true;
+                begin = end + 1;
+            }
+        }
+    }
+
+    bool ProgramOptions::parse(int argc, char* argv[])
+    {
+        std::vector<std::string> inputPaths;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+
+            if (0 == std::strcmp(arg, "--headless"))
+            {
+                headless = true;
+            }
+            else if (0 == std::strcmp(arg, "--watch"))
+            {
+                watch = true;
+            }
+            else if (0 == std::strcmp(arg, "--frame-rate"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseFloat(arg, value, frameRate))
+                    return false;
+                if (!(frameRate >= 0.0f))
+                {
+                    std::cerr << arg << " must not be negative" << std::endl;
+                    return false;
+                }
+            }
+            else if (0 == std::strcmp(arg, "--input") || 0 == std::strcmp(arg, "-i"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value)
+                    return false;
+                inputPaths.push_back(value);
+            }
+            else if (0 == std::strcmp(arg, "--output") || 0 == std::strcmp(arg, "-o"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value)
+                    return false;
+                outputFile = value;
+            }
+            else if (0 == std::strcmp(arg, "--output-dir"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value)
+                    return false;
+                outputDirectory = value;
+            }
+            else if (0 == std::strcmp(arg, "--compress"))
+            {
+                compress = true;
+            }
+            else if (0 == std::strcmp(arg, "--compress-min-size"))
+            {
+                unsigned kilobytes = 0;
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseUnsigned(arg, value, kilobytes))
+                    return false;
+                compress = true;
+                compressMinSize = static_cast<uint64_t>(kilobytes) << 10;
+            }
+            else if (0 == std::strcmp(arg, "--jobs") || 0 == std::strcmp(arg, "-j"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseUnsigned(arg, value, jobCount))
+                    return false;
+            }
+            else if (0 == std::strcmp(arg, "--profile"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value)
+                    return false;
+                profileFile = value;
+            }
+            else if (0 == std::strcmp(arg, "--scene-format"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value)
+                    return false;
+
+                if (0 == std::strcmp(value, "text"))
+                    sceneFormat = ESceneTextFormat_Text;
+                else if (0 == std::strcmp(value, "json"))
+                    sceneFormat = ESceneTextFormat_Json;
+                else if (0 == std::strcmp(value, "ndjson"))
+                    sceneFormat = ESceneTextFormat_NDJson;
+                else
+                {
+                    std::cerr << "Invalid value '" << value << "' for " << arg << ", expected text, json or ndjson" << std::endl;
+                    return false;
+                }
+            }
+            else if (0 == std::strcmp(arg, "--scene-dump"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value)
+                    return false;
+                sceneDumpFile = value;
+            }
+            else if (0 == std::strcmp(arg, "--footprint"))
+            {
+                printFootprint = true;
+            }
+            else if (0 == std::strcmp(arg, "--memory-budget"))
+            {
+                unsigned kilobytes = 0;
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseUnsigned(arg, value, kilobytes))
+                    return false;
+                memoryBudget = static_cast<uint64_t>(kilobytes) << 10;
+            }
+            else if (0 == std::strcmp(arg, "--threads"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseUnsigned(arg, value, importOptions.threadCount))
+                    return false;
+            }
+            else if (0 == std::strcmp(arg, "--index-width"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value)
+                    return false;
+
+                if (0 == std::strcmp(value, "auto"))
+                    importOptions.indexWidthPolicy = EIndexWidthPolicy_Auto;
+                else if (0 == std::strcmp(value, "32"))
+                    importOptions.indexWidthPolicy = EIndexWidthPolicy_UInt32;
+                else if (0 == std::strcmp(value, "split16"))
+                    importOptions.indexWidthPolicy = EIndexWidthPolicy_Split16;
+                else
+                {
+                    std::cerr << "Invalid value '" << value << "' for " << arg << ", expected auto, 32 or split16" << std::endl;
+                    return false;
+                }
+            }
+            else if (0 == std::strcmp(arg, "--no-uint32-indices"))
+            {
+                importOptions.targetSupportsUInt32Indices = false;
+            }
+            else if (0 == std::strcmp(arg, "--optimize"))
+            {
+                importOptions.optimizeVertexCache = true;
+            }
+            else if (0 == std::strcmp(arg, "--optimize-overdraw"))
+            {
+                importOptions.optimizeOverdraw = true;
+            }
+            else if (0 == std::strcmp(arg, "--no-materials"))
+            {
+                importOptions.loadMaterials = false;
+            }
+            else if (0 == std::strcmp(arg, "--no-generate-normals"))
+            {
+                importOptions.generateNormals = false;
+            }
+            else if (0 == std::strcmp(arg, "--normal-weighting"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value)
+                    return false;
+
+                if (0 == std::strcmp(value, "area"))
+                    importOptions.normalWeighting = ENormalWeighting_Area;
+                else if (0 == std::strcmp(value, "angle"))
+                    importOptions.normalWeighting = ENormalWeighting_Angle;
+                else
+                {
+                    std::cerr << "Invalid value '" << value << "' for " << arg << ", expected area or angle" << std::endl;
+                    return false;
+                }
+            }
+            else if (0 == std::strcmp(arg, "--crease-angle"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseFloat(arg, value, importOptions.creaseAngle))
+                    return false;
+                if (!(importOptions.creaseAngle >= 0.0f && importOptions.creaseAngle <= 180.0f))
+                {
+                    std::cerr << arg << " must be between 0 and 180 degrees" << std::endl;
+                    return false;
+                }
+            }
+            else if (0 == std::strcmp(arg, "--chunk"))
+            {
+                unsigned triangles = 0;
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseUnsigned(arg, value, triangles))
+                    return false;
+                importOptions.chunkTriangles = triangles;
+            }
+            else if (0 == std::strcmp(arg, "--lod"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseFloatList(arg, value, 1.0f, importOptions.lodTriangleRatios))
+                    return false;
+            }
+            else if (0 == std::strcmp(arg, "--lod-error"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseFloatList(arg, value, std::numeric_limits<float>::max(), importOptions.lodMaxErrors))
+                    return false;
+            }
+            else if (0 == std::strcmp(arg, "--cache-dir"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value)
+                    return false;
+                importOptions.cacheDirectory = value;
+            }
+            else if (0 == std::strcmp(arg, "--cache-size"))
+            {
+                unsigned megabytes = 0;
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseUnsigned(arg, value, megabytes))
+                    return false;
+                importOptions.cacheSizeLimit = static_cast<uint64_t>(megabytes) << 20;
+            }
+            else if (0 == std::strcmp(arg, "--vertex-cache-size"))
+            {
+                const char* value = takeValue(argc, argv, i);
+                if (nullptr == value || !parseUnsigned(arg, value, importOptions.vertexCacheSize))
+                    return false;
+                if (importOptions.vertexCacheSize < 3)
+                {
+                    std::cerr << arg << " must be at least 3" << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        if (inputPaths.empty())
+            inputPaths.push_back("res/suzanne.obj");
+
+        batch = inputPaths.size() > 1;
+        for (const auto& path : inputPaths)
+        {
+            if (FileUtils::isDirectory(path))
+            {
+                if (!FileUtils::listFiles(path, ".obj", inputFiles))
+                    return false;
+                batch = true;
+            }
+            else
+            {
+                inputFiles.push_back(path);
+            }
+        }
+
+        if (inputFiles.empty())
+        {
+            std::cerr << "No OBJ files found" << std::endl;
+            return false;
+        }
+
+        if (batch && !outputFile.empty())
+        {
+            std::cerr << "--output can only be used with a single input file, use --output-dir instead" << std::endl;
+            return false;
+        }
+
+        // with --output-dir only the stem of an input names its output
+        std::map<std::string, std::string> inputBySceneFile;
+        for (const auto& inputFile : inputFiles)
+        {
+            const auto inserted = inputBySceneFile.insert(std::make_pair(getSceneFile(inputFile), inputFile));
+            if (!inserted.second)
+            {
+                std::cerr << inputFile << " and " << inserted.first->second << " would both be saved to " << inserted.first->first
+                          << ", rename one of them or convert them separately" << std::endl;
+                return false;
+            }
+        }
+
+        // there is no window for several scenes
+        if (batch)
+            headless = true;
+
+        if (watch && headless)
+        {
+            std::cerr << "--watch needs the viewer, it cannot be combined with --headless or several inputs" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    std::string ProgramOptions::getSceneFile(const std::string& inputFile) const
+    {
+        if (!outputFile.empty())
+            return outputFile;
+
+        const std::string sceneFile = FileUtils::replaceExtension(inputFile, ".ramses");
+        return outputDirectory.empty() ? sceneFile : FileUtils::joinPath(outputDirectory, FileUtils::getStem(sceneFile) + ".ramses");
+    }
+
+    std::string ProgramOptions::getResourceFile(const std::string& inputFile) const
+    {
+        return FileUtils::replaceExtension(getSceneFile(inputFile), ".ramres");
+    }
+
+    std::string ProgramOptions::getCompressedResourceFile(const std::string& inputFile) const
+    {
+        return FileUtils::replaceExtension(getSceneFile(inputFile), ".lz4.ramres");
+    }
+}
@@ -7,8 +7,14 @@
 //  -------------------------------------------------------------------------
 
 #include "SceneToText.h"
+#include "JsonWriter.h"
+#include "SceneFootprint.h"
 
 #include <assert.h>
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+#include <utility>
 
 #include "ramses-client-api/Scene.h"
 #include "ramses-client-api/SceneObjectIterator.h"
@@ -19,96 +25,153 @@
 
 namespace obj2ramses
 {
+    namespace
+    {
+        /* objects of the type for which include(object) holds, ordered by id */
+        template <typename ObjectType, typename Include>
+        std::vector<ObjectType const*> collectObjects(const ramses::Scene& scene, ramses::ERamsesObjectType type, Include include)
+        {
+            std::vector<ObjectType const*> objects;
+            ramses::SceneObjectIterator iterator(scene, type);
+
+            const ramses::RamsesObject* object = iterator.getNext();
+            while (nullptr != object)
+            {
+                ObjectType const* converted = ramses::RamsesUtils::TryConvert<ObjectType>(*object);
+                assert(nullptr != converted);
+                if (include(*converted))
+                    objects.push_back(converted);
+
+                object = iterator.getNext();
+            }
+
+            // the iterator order depends on internal containers, the ids are stable
+            std::sort(objects.begin(), objects.end(), [](ObjectType const* a, ObjectType const* b) -> bool
+            {
+                return a->getSceneObjectId() < b->getSceneObjectId();
+            });
+            return objects;
+        }
+
+        const char* getNodeTypeName(const ramses::Node& node)
+        {
+            if (ramses::ERamsesObjectType_MeshNode == node.getType())
+                return "MeshNode";
+            if (node.isOfType(ramses::ERamsesObjectType_Camera))
+                return "Camera";
+            return "Node";
+        }
+
+        void writeIndentation(std::ostream& stream, uint32_t indentation)
+        {
+            std::fill_n(std::ostreambuf_iterator<char>(stream), indentation, ' ');
+        }
+
+        void writeVector(JsonWriter& json, const char* name, float x, float y, float z)
+        {
+            json.key(name).beginArray().value(static_cast<double>(x)).value(static_cast<double>(y)).value(static_cast<double>(z)).endArray();
+        }
+    }
 
-    SceneToText::SceneToText(bool printTransformations)
+    SceneToText::SceneToText(bool printTransformations, ESceneTextFormat format)
         : m_printTransformations(printTransformations)
+        , m_format(format)
     {
     }
 
-    void SceneToText::printToStream(const ramses::Scene& scene, const ramses::RamsesClient& /*client*/, std::ostringstream& stream) const
+    void SceneToText::printToStream(const ramses::Scene& scene, const ramses::RamsesClient& /*client*/, std::ostream& stream) const
     {
-        stream << "Scene '" << scene.getName() << "' [id:" << scene.getSceneId() << "]\n";
+        switch (m_format)
+        {
+        case ESceneTextFormat_Text:
+            printText(stream, scene);
+            break;
+        case ESceneTextFormat_Json:
+            printJson(stream, scene);
+            break;
+        case ESceneTextFormat_NDJson:
+            printNDJson(stream, scene);
+            break;
+        }
+    }
 
-        NodeSet rootNodes = collectRootNodes(scene);
+    template <typename Visit>
+    void SceneToText::forEachNode(const NodeList& rootNodes, Visit visit) const
+    {
+        // explicit stack, hierarchies can be deeper than the call stack allows
+        std::vector<std::pair<ramses::Node const*, uint32_t>> stack;
+        for (auto rootNode = rootNodes.rbegin(); rootNode != rootNodes.rend(); ++rootNode)
+            stack.push_back(std::make_pair(*rootNode, 0u));
 
-        for (auto& rootNode : rootNodes)
+        while (!stack.empty())
         {
-            printSubtree(stream, *rootNode, 0);
+            const ramses::Node& node = *stack.back().first;
+            const uint32_t depth = stack.back().second;
+            stack.pop_back();
+
+            visit(node, depth);
+
+            // reversed, so the first child is visited next
+            for (uint32_t i = node.getChildCount(); i > 0; --i)
+                stack.push_back(std::make_pair(node.getChild(i - 1), depth + 1));
         }
+    }
+
+    void SceneToText::printText(std::ostream& stream, const ramses::Scene& scene) const
+    {
+        stream << "Scene '" << scene.getName() << "' [id:" << scene.getSceneId() << "]\n";
+
+        forEachNode(collectRootNodes(scene), [this, &stream](const ramses::Node& node, uint32_t depth)
+        {
+            printNode(stream, node, depth);
+        });
 
         stream << "\nRenderPass setup:\n";
-        printRenderPasses(stream, scene);
+        for (auto renderPass : collectRenderPasses(scene))
+            printRenderPass(stream, *renderPass);
     }
 
-    void SceneToText::printRenderPasses(std::ostringstream& stream, const ramses::Scene& scene) const
+    void SceneToText::printRenderPass(std::ostream& stream, const ramses::RenderPass& renderPass) const
     {
-        ramses::SceneObjectIterator renderPassIterator(scene, ramses::ERamsesObjectType_RenderPass);
+        stream << "RenderPass " << renderPass.getName() << "\n";
 
-        const ramses::RamsesObject* passAsObject = renderPassIterator.getNext();
-        while (nullptr != passAsObject)
+        if (nullptr != renderPass.getCamera() && renderPass.getCamera()->isOfType(ramses::ERamsesObjectType_LocalCamera))
         {
-            ramses::RenderPass const * renderPass = ramses::RamsesUtils::TryConvert<ramses::RenderPass>(*passAsObject);
-            assert(nullptr != renderPass);
+            ramses::LocalCamera const * localCamera = ramses::RamsesUtils::TryConvert<ramses::LocalCamera>(*renderPass.getCamera());
 
-            stream << "RenderPass " << renderPass->getName() << "\n";
+            const char* cameraType =
+                (ramses::ERamsesObjectType_PerspectiveCamera == localCamera->getType()) ?
+                "Perspective Camera:" :
+                "Orthographic Camera:";
 
-            if (nullptr != renderPass->getCamera() && renderPass->getCamera()->isOfType(ramses::ERamsesObjectType_LocalCamera))
+            stream << "  " << cameraType << "\n    Planes: [" <<
+                "Left: " << localCamera->getLeftPlane() <<
+                " Right: " << localCamera->getRightPlane() <<
+                " Bot: " << localCamera->getBottomPlane() <<
+                " Top: " << localCamera->getTopPlane() << "]\n";
+            stream << "    Viewport: ["
+                << localCamera->getViewportX() << ", "
+                << localCamera->getViewportY() << ", "
+                << localCamera->getViewportWidth() << ", "
+                << localCamera->getViewportHeight() << "]\n";
+
+            ramses::PerspectiveCamera const * perspCamera = ramses::RamsesUtils::TryConvert<ramses::PerspectiveCamera>(*localCamera);
+            if (nullptr != perspCamera)
             {
-                ramses::LocalCamera const * localCamera = ramses::RamsesUtils::TryConvert<ramses::LocalCamera>(*renderPass->getCamera());
-
-                std::string cameraType =
-                    (ramses::ERamsesObjectType_PerspectiveCamera == localCamera->getType()) ?
-                    "Perspective Camera:" :
-                    "Orthographic Camera:";
-
-                stream << "  " << cameraType << "\n    Planes: [" <<
-                    "Left: " << localCamera->getLeftPlane() <<
-                    " Right: " << localCamera->getRightPlane() <<
-                    " Bot: " << localCamera->getBottomPlane() <<
-                    " Top: " << localCamera->getTopPlane() << "]\n";
-                stream << "    Viewport: ["
-                    << localCamera->getViewportX() << ", "
-                    << localCamera->getViewportY() << ", "
-                    << localCamera->getViewportWidth() << ", "
-                    << localCamera->getViewportHeight() << "]\n";
-
-                ramses::PerspectiveCamera const * perspCamera = ramses::RamsesUtils::TryConvert<ramses::PerspectiveCamera>(*localCamera);
-                if (nullptr != perspCamera)
-                {
-                    stream << "    FoV: " << perspCamera->getVerticalFieldOfView() << "; Asp. Ratio: " << perspCamera->getAspectRatio();
-                }
+                stream << "    FoV: " << perspCamera->getVerticalFieldOfView() << "; Asp. Ratio: " << perspCamera->getAspectRatio();
             }
-            stream << "\n";
-
-            passAsObject = renderPassIterator.getNext();
         }
+        stream << "\n";
     }
 
-    void SceneToText::printSubtree(std::ostringstream& stream, const ramses::Node& rootNode, uint32_t indentation) const
+    void SceneToText::printNode(std::ostream& stream, const ramses::Node& node, uint32_t depth) const
     {
-        stream << std::string(indentation, ' ');
-
-        const std::string rootNodePrefix = (0 == indentation) ? "Root" : "";
-
-        if (ramses::ERamsesObjectType_Node == rootNode.getType())
-        {
-            stream << rootNodePrefix << "Node '" << rootNode.getName() << "'\n";
-        }
-        else if (ramses::ERamsesObjectType_MeshNode == rootNode.getType())
-        {
-            stream << rootNodePrefix << "MeshNode '" << rootNode.getName() << "'\n";
-        }
-        else if (rootNode.isOfType(ramses::ERamsesObjectType_Camera))
-        {
-            stream << rootNodePrefix << "Camera '" << rootNode.getName() << "'\n";
-        }
-
-        printTransformations(stream, rootNode, indentation);
-        for (uint32_t i = 0; i < rootNode.getChildCount(); ++i)
-            printSubtree(stream, *rootNode.getChild(i), indentation+1);
+        writeIndentation(stream, depth);
+        stream << ((0 == depth) ? "Root" : "") << getNodeTypeName(node) << " '" << node.getName() << "'\n";
+        printTransformations(stream, node, depth);
     }
 
-    void SceneToText::printTransformations(std::ostringstream& stream, const ramses::Node& node, uint32_t indentation) const
+    void SceneToText::printTransformations(std::ostream& stream, const ramses::Node& node, uint32_t indentation) const
     {
         if (m_printTransformations)
         {
@@ -120,7 +183,7 @@ namespace obj2ramses
             node.getRotation(rx, ry, rz);
             if (sx != 1.0f || sy != 1.0f || sz != 1.0f || tx != 0.0f || ty != 0.0f || tz != 0.0f || rx != 0.0f || ry != 0.0f || rz != 0.0f)
             {
-                stream << std::string(indentation, ' ');
+                writeIndentation(stream, indentation);
 
                 if (sx != 1.0f || sy != 1.0f || sz != 1.0f)
                     stream << "S[" << sx << "," << sy << "," << sz << "] ";
@@ -134,22 +197,269 @@ namespace obj2ramses
         }
     }
 
-    NodeSet SceneToText::collectRootNodes(const ramses::Scene& scene) const
+    void SceneToText::printJson(std::ostream& stream, const ramses::Scene& scene) const
+    {
+        JsonWriter json(stream);
+        json.beginObject();
+
+        json.key("scene").beginObject();
+        writeScene(json, scene);
+        json.endObject();
+
+        json.key("nodes").beginArray();
+        forEachNode(collectRootNodes(scene), [this, &json](const ramses::Node& node, uint32_t /*depth*/)
+        {
+            json.beginObject();
+            writeNode(json, node);
+            json.endObject();
+        });
+        json.endArray();
+
+        json.key("renderPasses").beginArray();
+        for (auto renderPass : collectRenderPasses(scene))
+        {
+            json.beginObject();
+            writeRenderPass(json, *renderPass);
+            json.endObject();
+        }
+        json.endArray();
+
+        json.endObject();
+        stream << "\n";
+    }
+
+    void SceneToText::printNDJson(std::ostream& stream, const ramses::Scene& scene) const
+    {
+        {
+            JsonWriter json(stream, 0);
+            json.beginObject().key("record").value("scene");
+            writeScene(json, scene);
+            json.endObject();
+            stream << "\n";
+        }
+
+        forEachNode(collectRootNodes(scene), [this, &stream](const ramses::Node& node, uint32_t /*depth*/)
+        {
+            JsonWriter json(stream, 0);
+            json.beginObject().key("record").value("node");
+            writeNode(json, node);
+            json.endObject();
+            stream << "\n";
+        });
+
+        for (auto renderPass : collectRenderPasses(scene))
+        {
+            JsonWriter json(stream, 0);
+            json.beginObject().key("record").value("renderPass");
+            writeRenderPass(json, *renderPass);
+            json.endObject();
+            stream << "\n";
+        }
+    }
+
+    void SceneToText::writeScene(JsonWriter& json, const ramses::Scene& scene) const
+    {
+        json.key("name").value(scene.getName());
+        json.key("id").value(static_cast<uint64_t>(scene.getSceneId()));
+    }
+
+    void SceneToText::writeNode(JsonWriter& json, const ramses::Node& node) const
+    {
+        json.key("id").value(static_cast<uint64_t>(node.getSceneObjectId()));
+        // the parent comes earlier in the output, the depth follows from it
+        if (nullptr != node.getParent())
+            json.key("parent").value(static_cast<uint64_t>(node.getParent()->getSceneObjectId()));
+        else
+            json.key("parent").null();
+        json.key("type").value(getNodeTypeName(node));
+        json.key("name").value(node.getName());
+
+        if (m_printTransformations)
+        {
+            float x, y, z;
+            node.getScaling(x, y, z);
+            writeVector(json, "scaling", x, y, z);
+            node.getTranslation(x, y, z);
+            writeVector(json, "translation", x, y, z);
+            node.getRotation(x, y, z);
+            writeVector(json, "rotation", x, y, z);
+        }
+    }
+
+    void SceneToText::writeRenderPass(JsonWriter& json, const ramses::RenderPass& renderPass) const
+    {
+        json.key("id").value(static_cast<uint64_t>(renderPass.getSceneObjectId()));
+        json.key("name").value(renderPass.getName());
+
+        const ramses::Camera* camera = renderPass.getCamera();
+        json.key("camera");
+        if (nullptr == camera)
+        {
+            json.null();
+            return;
+        }
+
+        json.beginObject();
+        json.key("id").value(static_cast<uint64_t>(camera->getSceneObjectId()));
+        ramses::LocalCamera const * localCamera = ramses::RamsesUtils::TryConvert<ramses::LocalCamera>(*camera);
+        if (nullptr != localCamera)
+        {
+            ramses::PerspectiveCamera const * perspCamera = ramses::RamsesUtils::TryConvert<ramses::PerspectiveCamera>(*localCamera);
+            json.key("type").value(nullptr != perspCamera ? "perspective" : "orthographic");
+            json.key("planes").beginArray()
+                .value(static_cast<double>(localCamera->getLeftPlane()))
+                .value(static_cast<double>(localCamera->getRightPlane()))
+                .value(static_cast<double>(localCamera->getBottomPlane()))
+                .value(static_cast<double>(localCamera->getTopPlane()))
+                .value(static_cast<double>(localCamera->getNearPlane()))
+                .value(static_cast<double>(localCamera->getFarPlane()))
+                .endArray();
+            json.key("viewport").beginArray()
+                .value(static_cast<int64_t>(localCamera->getViewportX()))
+                .value(static_cast<int64_t>(localCamera->getViewportY()))
+                .value(static_cast<uint64_t>(localCamera->getViewportWidth()))
+                .value(static_cast<uint64_t>(localCamera->getViewportHeight()))
+                .endArray();
+            if (nullptr != perspCamera)
+            {
+                json.key("fieldOfView").value(static_cast<double>(perspCamera->getVerticalFieldOfView()));
+                json.key("aspectRatio").value(static_cast<double>(perspCamera->getAspectRatio()));
+            }
+        }
+        else
+        {
+            json.key("type").value("remote");
+        }
+        json.endObject();
+    }
+
+    void SceneToText::printFootprint(const SceneFootprint& footprint, std::ostream& stream) const
     {
-        NodeSet rootNodes;
-        ramses::SceneObjectIterator nodeIterator(scene, ramses::ERamsesObjectType_Node);
+        if (ESceneTextFormat_Json == m_format)
+        {
+            JsonWriter json(stream);
+            json.beginObject();
+            writeFootprintTotals(json, footprint);
+            json.key("meshes").beginArray();
+            for (const auto& mesh : footprint.meshes)
+            {
+                json.beginObject();
+                writeMeshFootprint(json, mesh);
+                json.endObject();
+            }
+            json.endArray();
+            json.key("resources").beginArray();
+            for (size_t i = 0; i < footprint.resources.size(); ++i)
+            {
+                json.beginObject();
+                writeResourceFootprint(json, footprint.resources[i], i);
+                json.endObject();
+            }
+            json.endArray();
+            json.endObject();
+            stream << "\n";
+            return;
+        }
 
-        const ramses::RamsesObject* nodeAsObject = nodeIterator.getNext();
-        while (nullptr != nodeAsObject)
+        if (ESceneTextFormat_NDJson == m_format)
         {
-            ramses::Node const * node = ramses::RamsesUtils::TryConvert<ramses::Node>(*nodeAsObject);
-            assert(nullptr != node);
-            if (nullptr == node->getParent())
-                rootNodes.insert(node);
+            {
+                JsonWriter json(stream, 0);
+                json.beginObject().key("record").value("footprint");
+                writeFootprintTotals(json, footprint);
+                json.endObject();
+                stream << "\n";
+            }
+            for (const auto& mesh : footprint.meshes)
+            {
+                JsonWriter json(stream, 0);
+                json.beginObject().key("record").value("meshFootprint");
+                writeMeshFootprint(json, mesh);
+                json.endObject();
+                stream << "\n";
+            }
+            for (size_t i = 0; i < footprint.resources.size(); ++i)
+            {
+                JsonWriter json(stream, 0);
+                json.beginObject().key("record").value("resourceFootprint");
+                writeResourceFootprint(json, footprint.resources[i], i);
+                json.endObject();
+                stream << "\n";
+            }
+            return;
+        }
 
-            nodeAsObject = nodeIterator.getNext();
+        stream << "\nFootprint of " << footprint.meshes.size() << " mesh node(s), " << footprint.resources.size() << " resource(s) and "
+               << footprint.effectCount << " effect(s):\n"
+               << "  unique " << footprint.uniqueBytes << " bytes, shared " << footprint.sharedBytes << " bytes ("
+               << footprint.unsharedBytes << " bytes without sharing), estimated GPU memory " << footprint.gpuBytes << " bytes\n";
+
+        stream << "\n  GPU [bytes]  unique [bytes]  shared [bytes]  vertices   indices  index  mesh\n";
+        for (const auto& mesh : footprint.meshes)
+        {
+            stream << std::setw(13) << mesh.gpuBytes << "  "
+                   << std::setw(14) << mesh.uniqueBytes << "  "
+                   << std::setw(14) << mesh.sharedBytes << "  "
+                   << std::setw(8) << mesh.vertexCount << "  "
+                   << std::setw(8) << mesh.indexCount << "  "
+                   << std::setw(5) << mesh.indexWidth << "  "
+                   << mesh.name << "\n";
         }
 
-        return rootNodes;
+        stream << "\n  GPU [bytes]         bytes  users  type        resource\n";
+        for (const auto& resource : footprint.resources)
+        {
+            stream << std::setw(13) << resource.gpuBytes << "  "
+                   << std::setw(12) << resource.bytes << "  "
+                   << std::setw(5) << resource.users << "  "
+                   << std::left << std::setw(10) << resource.type << std::right << "  "
+                   << resource.name << "\n";
+        }
+    }
+
+    void SceneToText::writeFootprintTotals(JsonWriter& json, const SceneFootprint& footprint) const
+    {
+        json.key("meshCount").value(static_cast<uint64_t>(footprint.meshes.size()));
+        json.key("resourceCount").value(static_cast<uint64_t>(footprint.resources.size()));
+        json.key("effectCount").value(static_cast<uint64_t>(footprint.effectCount));
+        json.key("uniqueBytes").value(footprint.uniqueBytes);
+        json.key("sharedBytes").value(footprint.sharedBytes);
+        json.key("unsharedBytes").value(footprint.unsharedBytes);
+        json.key("gpuBytes").value(footprint.gpuBytes);
+    }
+
+    void SceneToText::writeMeshFootprint(JsonWriter& json, const MeshFootprint& mesh) const
+    {
+        json.key("name").value(mesh.name);
+        json.key("vertexCount").value(static_cast<uint64_t>(mesh.vertexCount));
+        json.key("indexCount").value(static_cast<uint64_t>(mesh.indexCount));
+        json.key("indexWidth").value(static_cast<uint64_t>(mesh.indexWidth));
+        json.key("uniqueBytes").value(mesh.uniqueBytes);
+        json.key("sharedBytes").value(mesh.sharedBytes);
+        json.key("gpuBytes").value(mesh.gpuBytes);
+        json.key("resources").beginArray();
+        for (auto resource : mesh.resources)
+            json.value(static_cast<uint64_t>(resource));
+        json.endArray();
+    }
+
+    void SceneToText::writeResourceFootprint(JsonWriter& json, const ResourceFootprint& resource, size_t index) const
+    {
+        json.key("index").value(static_cast<uint64_t>(index));
+        json.key("name").value(resource.name);
+        json.key("type").value(resource.type);
+        json.key("bytes").value(resource.bytes);
+        json.key("gpuBytes").value(resource.gpuBytes);
+        json.key("users").value(static_cast<uint64_t>(resource.users));
+    }
+
+    NodeList SceneToText::collectRootNodes(const ramses::Scene& scene) const
+    {
+        return collectObjects<ramses::Node>(scene, ramses::ERamsesObjectType_Node, [](const ramses::Node& node) { return nullptr == node.getParent(); });
+    }
+
+    std::vector<ramses::RenderPass const*> SceneToText::collectRenderPasses(const ramses::Scene& scene) const
+    {
+        return collectObjects<ramses::RenderPass>(scene, ramses::ERamsesObjectType_RenderPass, [](const ramses::RenderPass&) { return true; });
     }
 }
@@ -0,0 +1,141 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "TextureLoader.h"
+#include "ThreadPool.h"
+#include "MappedFile.h"
+#include "GeometryCache.h"
+#include "Profiler.h"
+
+#include <utility>
+
+// the PNG decoder bundled with the RAMSES SDK
+#include "lodepng.h"
+
+namespace obj2ramses
+{
+    TextureLoader::TextureLoader(unsigned threadCount)
+        : m_threadCount(threadCount)
+    {
+    }
+
+    TextureLoader::~TextureLoader()
+    {
+        // the tasks write into m_textures
+        wait();
+    }
+
+    size_t TextureLoader::request(const std::string& path)
+    {
+        auto inserted = m_textureByPath.insert(std::make_pair(path, m_textures.size()));
+        if (!inserted.second)
+            return inserted.first->second;
+
+        const size_t index = m_textures.size();
+        m_textures.push_back(std::unique_ptr<DecodedTexture>(new DecodedTexture()));
+        DecodedTexture& texture = *m_textures.back();
+        texture.path = path;
+        texture.duplicateOf = index;
+
+        if (!m_pool)
+            m_pool.reset(new ThreadPool(m_threadCount));
+        m_pool->submit([this, &texture, index]()
+        {
+            decode(texture, index);
+        });
+        return index;
+    }
+
+    size_t TextureLoader::find(const std::string& path) const
+    {
+        auto it = m_textureByPath.find(path);
+        return (it == m_textureByPath.end()) ? m_textures.size() : it->second;
+    }
+
+    void TextureLoader::wait()
+    {
+        if (!m_pool)
+            return;
+
+        m_pool->wait();
+        resolveDuplicates();
+    }
+
+    void TextureLoader::decode(DecodedTexture& texture, size_t index)
+    {
+        ScopedTimer timer("textures.decode");
+        MappedFile file;
+        if (!file.open(texture.path))
+        {
+            texture.error = "cannot open file";
+            return;
+        }
+
+        // the same image is often copied next to every model using it
+        const uint64_t contentKey = GeometryCache::Hash(file.data(), file.size(), file.size());
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto inserted = m_textureByContent.insert(std::make_pair(contentKey, index));
+            if (!inserted.second)
+            {
+                texture.duplicateOf = inserted.first->second;
+                return;
+            }
+        }
+
+        unsigned width = 0;
+        unsigned height = 0;
+        const unsigned result = lodepng::decode(texture.pixels, width, height, reinterpret_cast<const unsigned char*>(file.data()), file.size(), LCT_RGBA, 8u);
+        if (0 != result)
+        {
+            texture.error = lodepng_error_text(result);
+            texture.pixels.clear();
+            return;
+        }
+
+        texture.width = width;
+        texture.height = height;
+        texture.valid = true;
+        Profiler::Get().addCounter("textures.decodedBytes", texture.pixels.size());
+    }
+
+    void TextureLoader::resolveDuplicates()
+    {
+        // whichever worker hashed a content first decoded it; the first requested texture with that
+        // content takes over the pixels, so the result does not depend on the timing of the workers
+        for (size_t index = 0; index < m_textures.size(); ++index)
+        {
+            DecodedTexture& texture = *m_textures[index];
+            const size_t decoded = texture.duplicateOf;
+            if (decoded <= index)
+                continue;
+
+            // the duplicate has neither pixels nor an error, swapping leaves the decoded texture like one
+            DecodedTexture& decodedTexture = *m_textures[decoded];
+            std::swap(texture.valid, decodedTexture.valid);
+            std::swap(texture.width, decodedTexture.width);
+            std::swap(texture.height, decodedTexture.height);
+            texture.error.swap(decodedTexture.error);
+            texture.pixels.swap(decodedTexture.pixels);
+
+            for (size_t other = index; other < m_textures.size(); ++other)
+            {
+                if (m_textures[other]->duplicateOf == decoded)
+                    m_textures[other]->duplicateOf = index;
+            }
+
+            // textures requested later are compared against this one
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& content : m_textureByContent)
+            {
+                if (content.second == decoded)
+                    content.second = index;
+            }
+        }
+    }
+}
@@ -0,0 +1,135 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace obj2ramses
+{
+    namespace
+    {
+        /* pool and queue of the worker running on the current thread, if any */
+        thread_local const ThreadPool* CurrentPool = nullptr;
+        thread_local unsigned CurrentWorker = 0;
+    }
+
+    ThreadPool::ThreadPool(unsigned threadCount)
+        : m_nextQueue(0)
+    {
+        if (0 == threadCount)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned i = 0; i < threadCount; ++i)
+            m_queues.emplace_back(new WorkQueue);
+
+        for (unsigned i = 0; i < threadCount; ++i)
+            m_workers.emplace_back(&ThreadPool::run, this, i);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_workAvailable.notify_all();
+
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    void ThreadPool::submit(Task task)
+    {
+        const unsigned queueIndex = (CurrentPool == this) ? CurrentWorker : m_nextQueue++ % getThreadCount();
+        {
+            // counted before it is queued, otherwise another worker can finish it first and wait() returns early
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_pendingTasks;
+        }
+        {
+            WorkQueue& queue = *m_queues[queueIndex];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        {
+            // idle workers count the queued tasks under m_mutex before they sleep, so this cannot slip in between
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        m_workAvailable.notify_one();
+    }
+
+    void ThreadPool::wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_allDone.wait(lock, [this]() { return 0 == m_pendingTasks; });
+    }
+
+    void ThreadPool::run(unsigned workerIndex)
+    {
+        CurrentPool = this;
+        CurrentWorker = workerIndex;
+
+        for (;;)
+        {
+            Task task;
+            if (popOwn(workerIndex, task) || steal(workerIndex, task))
+            {
+                task();
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (0 == --m_pendingTasks)
+                    m_allDone.notify_all();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stopping)
+                return;
+
+            // pending tasks which are not queued anymore are running; wake up for new ones only
+            size_t queuedTasks = 0;
+            for (auto& queue : m_queues)
+            {
+                std::lock_guard<std::mutex> queueLock(queue->mutex);
+                queuedTasks += queue->tasks.size();
+            }
+            if (0 == queuedTasks)
+                m_workAvailable.wait(lock);
+        }
+    }
+
+    bool ThreadPool::popOwn(unsigned workerIndex, Task& task)
+    {
+        WorkQueue& queue = *m_queues[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool ThreadPool::steal(unsigned workerIndex, Task& task)
+    {
+        const unsigned threadCount = getThreadCount();
+        for (unsigned i = 1; i < threadCount; ++i)
+        {
+            WorkQueue& queue = *m_queues[(workerIndex + i) % threadCount];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+                continue;
+
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+}
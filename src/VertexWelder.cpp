@@ -0,0 +1,179 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "VertexWelder.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace obj2ramses
+{
+    using ObjGeometry::invalid_index;
+
+    namespace
+    {
+        inline size_t hashKey(unsigned v, unsigned vt, unsigned vn)
+        {
+            // multiplicative mixing of the three indices followed by the murmur3 finalizer
+            uint32_t h = v * 0x9E3779B1u ^ vt * 0x85EBCA77u ^ vn * 0xC2B2AE3Du;
+            h ^= h >> 16;
+            h *= 0x85EBCA6Bu;
+            h ^= h >> 13;
+            h *= 0xC2B2AE35u;
+            h ^= h >> 16;
+            return h;
+        }
+
+        size_t nextPowerOfTwo(size_t value)
+        {
+            size_t result = 16;
+            while (result < value)
+                result <<= 1;
+            return result;
+        }
+    }
+
+    WeldStatistics VertexWelder::weld(const ObjGeometry::mesh_data& mesh, const std::vector<FaceRange>& faceRanges, ObjGeometry::indexed_mesh& out)
+    {
+        const ObjGeometry::face_store& faces = mesh.faces;
+        const bool hasTexCoords = !faces.vt.empty();
+        const bool hasNormals = !faces.vn.empty();
+
+        size_t cornerCount = 0;
+        size_t triangleCount = 0;
+        for (const auto& range : faceRanges)
+        {
+            const size_t rangeCorners = faces.offsets[range.second] - faces.offsets[range.first];
+            cornerCount += rangeCorners;
+            triangleCount += rangeCorners - 2 * (range.second - range.first);
+        }
+
+        // unique vertices usually end up close to the largest attribute count
+        const size_t expectedVertices = std::min(cornerCount, std::max(mesh.vertices.size(), std::max(mesh.tex_coords.size(), mesh.normals.size())));
+        resetTable(expectedVertices);
+
+        const unsigned vertexBase = static_cast<unsigned>(out.vertex_count());
+        out.positions.reserve(out.positions.size() + 3 * expectedVertices);
+        if (hasTexCoords)
+            out.tex_coords.reserve(out.tex_coords.size() + 2 * expectedVertices);
+        if (hasNormals)
+            out.normals.reserve(out.normals.size() + 3 * expectedVertices);
+        out.indices.reserve(out.indices.size() + 3 * triangleCount);
+
+        for (const auto& range : faceRanges)
+        {
+            for (size_t f = range.first; f < range.second; ++f)
+            {
+                m_faceCorners.clear();
+
+                for (size_t corner = faces.offsets[f]; corner < faces.offsets[f + 1]; ++corner)
+                {
+                    const unsigned v = faces.v[corner];
+                    const unsigned vt = hasTexCoords ? faces.vt[corner] : invalid_index;
+                    const unsigned vn = hasNormals ? faces.vn[corner] : invalid_index;
+
+                    bool inserted = false;
+                    const unsigned vertex = findOrInsert(v, vt, vn, inserted);
+                    if (inserted)
+                    {
+                        const ObjGeometry::vertex3f& position = mesh.vertices[v];
+                        out.positions.push_back(position.x);
+                        out.positions.push_back(position.y);
+                        out.positions.push_back(position.z);
+
+                        if (hasTexCoords)
+                        {
+                            const bool valid = vt != invalid_index;
+                            out.tex_coords.push_back(valid ? mesh.tex_coords[vt].u : 0.0f);
+                            out.tex_coords.push_back(valid ? mesh.tex_coords[vt].v : 0.0f);
+                        }
+
+                        if (hasNormals)
+                        {
+                            const bool valid = vn != invalid_index;
+                            out.normals.push_back(valid ? mesh.normals[vn].x : 0.0f);
+                            out.normals.push_back(valid ? mesh.normals[vn].y : 0.0f);
+                            out.normals.push_back(valid ? mesh.normals[vn].z : 0.0f);
+                        }
+                    }
+
+                    m_faceCorners.push_back(vertexBase + vertex);
+                }
+
+                for (size_t i = 1; i + 1 < m_faceCorners.size(); ++i)
+                {
+                    out.indices.push_back(m_faceCorners[0]);
+                    out.indices.push_back(m_faceCorners[i]);
+                    out.indices.push_back(m_faceCorners[i + 1]);
+                }
+            }
+        }
+
+        WeldStatistics statistics;
+        statistics.cornerCount = cornerCount;
+        statistics.vertexCount = m_keys.size() / 3;
+        return statistics;
+    }
+
+    void VertexWelder::resetTable(size_t expectedVertices)
+    {
+        // keep the load factor below one half
+        const size_t capacity = nextPowerOfTwo(2 * expectedVertices);
+        m_slots.assign(capacity, 0u);
+        m_mask = capacity - 1;
+        m_keys.clear();
+        m_keys.reserve(3 * expectedVertices);
+    }
+
+    void VertexWelder::growTable()
+    {
+        const size_t capacity = 2 * m_slots.size();
+        m_slots.assign(capacity, 0u);
+        m_mask = capacity - 1;
+
+        const size_t vertexCount = m_keys.size() / 3;
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            size_t slot = hashKey(m_keys[3 * vertex], m_keys[3 * vertex + 1], m_keys[3 * vertex + 2]) & m_mask;
+            while (0 != m_slots[slot])
+                slot = (slot + 1) & m_mask;
+            m_slots[slot] = static_cast<unsigned>(vertex + 1);
+        }
+    }
+
+    unsigned VertexWelder::findOrInsert(unsigned v, unsigned vt, unsigned vn, bool& inserted)
+    {
+        size_t slot = hashKey(v, vt, vn) & m_mask;
+        for (;;)
+        {
+            const unsigned entry = m_slots[slot];
+            if (0 == entry)
+                break;
+
+            const unsigned* key = &m_keys[3 * (entry - 1)];
+            if (key[0] == v && key[1] == vt && key[2] == vn)
+            {
+                inserted = false;
+                return entry - 1;
+            }
+            slot = (slot + 1) & m_mask;
+        }
+
+        const unsigned vertex = static_cast<unsigned>(m_keys.size() / 3);
+        m_keys.push_back(v);
+        m_keys.push_back(vt);
+        m_keys.push_back(vn);
+        m_slots[slot] = vertex + 1;
+        inserted = true;
+
+        if (2 * (vertex + 1) > m_slots.size())
+            growTable();
+
+        return vertex;
+    }
+}
@@ -0,0 +1,88 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_EFFECTCACHE
+#define OBJ2RAMSES_EFFECTCACHE
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+#include "ramses-client-api/EffectInputSemantic.h"
+
+namespace ramses
+{
+    class RamsesClient;
+    class Effect;
+}
+
+namespace obj2ramses
+{
+    /* Everything an effect is compiled from */
+    struct EffectSource
+    {
+        std::string vertexShader;
+        std::string fragmentShader;
+        std::vector<std::pair<std::string, ramses::EEffectUniformSemantic>> uniformSemantics;
+        std::vector<std::string> compilerDefines;
+    };
+
+    /**
+     * @brief Persistent cache of compiled effects, so shaders are only parsed and validated once.
+     *
+     * Every effect is saved to a resource file of its own in the cache directory, named after a
+     * hash of its source, uniform semantics, compiler defines and the RAMSES version. Later runs
+     * load the resource file instead of compiling the shaders.
+     *
+     * The cache owns the effects it hands out. Importers sharing one cache share one effect per
+     * source, which is destroyed when its last user releases it. Like the client calls it makes,
+     * the cache is not thread safe.
+     */
+    class EffectCache
+    {
+    public:
+        /* an empty directory disables the cache, effects are always compiled */
+        EffectCache(ramses::RamsesClient& client, const std::string& directory);
+
+        /**
+         * @brief Effect of the source, each call must be paired with releaseEffect().
+         *
+         * @param cacheHit set if the effect was in use already or loaded from the cache directory
+         * @return nullptr if the effect cannot be compiled
+         */
+        const ramses::Effect* acquireEffect(const EffectSource& source, bool& cacheHit);
+
+        /* destroys the effect once no user is left */
+        void releaseEffect(const ramses::Effect& effect);
+
+        static uint64_t ComputeKey(const EffectSource& source);
+
+    private:
+        const ramses::Effect* compile(const EffectSource& source, const std::string& name) const;
+        const ramses::Effect* find(const std::string& name) const;
+        const ramses::Effect* load(const std::string& entryFile, const std::string& name) const;
+        void store(const ramses::Effect& effect, const std::string& entryFile) const;
+
+        /* effect and the number of acquireEffect() calls not released yet */
+        struct SharedEffect
+        {
+            const ramses::Effect* effect;
+            size_t users;
+        };
+
+        ramses::RamsesClient& m_client;
+        const std::string m_directory;
+        /* by key of the source */
+        std::map<std::string, SharedEffect> m_effects;
+    };
+}
+
+#endif
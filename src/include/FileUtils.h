@@ -0,0 +1,60 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_FILEUTILS
+#define OBJ2RAMSES_FILEUTILS
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace obj2ramses
+{
+    namespace FileUtils
+    {
+        bool isDirectory(const std::string& path);
+
+        /* size of the file in bytes, 0 if it does not exist */
+        uint64_t getFileSize(const std::string& path);
+
+        /* modification time in seconds since the epoch, 0 if the file does not exist */
+        int64_t getModificationTime(const std::string& path);
+
+        /* sets the modification time to now */
+        bool touchFile(const std::string& path);
+
+        /* creates the directory if it does not exist yet, parent directories must exist */
+        bool createDirectory(const std::string& path);
+
+        bool removeFile(const std::string& path);
+
+        /* replaces an existing file at the destination */
+        bool renameFile(const std::string& source, const std::string& destination);
+
+        /* name next to path which no other process or thread uses, to write a file and rename it to path */
+        std::string getTemporaryFile(const std::string& path);
+
+        /* appends the regular files in directory (not recursive) ending with extension, sorted by name */
+        bool listFiles(const std::string& directory, const std::string& extension, std::vector<std::string>& files);
+
+        /* path without directory and extension */
+        std::string getStem(const std::string& path);
+
+        std::string replaceExtension(const std::string& path, const std::string& extension);
+
+        std::string joinPath(const std::string& directory, const std::string& fileName);
+
+        /* directory part of path, empty if it has none */
+        std::string getDirectory(const std::string& path);
+
+        /* path relative to directory, absolute paths are returned unchanged */
+        std::string resolvePath(const std::string& directory, const std::string& path);
+    }
+}
+
+#endif
@@ -0,0 +1,47 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_FILEWATCHER
+#define OBJ2RAMSES_FILEWATCHER
+
+#include <string>
+#include <cstdint>
+
+namespace obj2ramses
+{
+    /**
+     * @brief Tells whether a file was written since the last check, without blocking.
+     *
+     * On Linux the directory of the file is watched with inotify, so files which editors save by
+     * writing a temporary file and renaming it are noticed as well. Elsewhere the modification
+     * time and size are compared on every check.
+     */
+    class FileWatcher
+    {
+    public:
+        explicit FileWatcher(const std::string& file);
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        /* true once after one or more changes of the file */
+        bool poll();
+
+    private:
+        const std::string m_file;
+#if defined(__linux__)
+        std::string m_fileName;
+        int m_inotify = -1;
+#endif
+        int64_t m_modificationTime = 0;
+        uint64_t m_size = 0;
+    };
+}
+
+#endif
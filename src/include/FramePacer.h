@@ -0,0 +1,48 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_FRAMEPACER
+#define OBJ2RAMSES_FRAMEPACER
+
+#include <chrono>
+#include <cstdint>
+
+namespace obj2ramses
+{
+    /**
+     * @brief Paces the viewer loop to a frame rate.
+     *
+     * Frames start at fixed deadlines, so the time spent handling events and updating the scene
+     * is part of the frame instead of being added to a fixed sleep. A loop which falls behind
+     * starts the next frame immediately and does not try to catch up. A frame rate of 0 does not
+     * wait at all, which gives the lowest input latency at the cost of a busy core.
+     */
+    class FramePacer
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        explicit FramePacer(float framesPerSecond);
+
+        /* blocks until the next frame is due */
+        void waitForNextFrame();
+
+        /* frames which started later than their deadline */
+        uint64_t getLateFrameCount() const
+        {
+            return m_lateFrames;
+        }
+
+    private:
+        const Clock::duration m_period;
+        Clock::time_point m_nextFrame;
+        uint64_t m_lateFrames = 0;
+    };
+}
+
+#endif
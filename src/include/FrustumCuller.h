@@ -0,0 +1,88 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_FRUSTUMCULLER
+#define OBJ2RAMSES_FRUSTUMCULLER
+
+#include <vector>
+#include <cstddef>
+
+#include "ObjGeometry.h"
+
+namespace ramses
+{
+    class MeshNode;
+    class PerspectiveCamera;
+}
+
+namespace obj2ramses
+{
+    class LodSwitcher;
+
+    struct CullStatistics
+    {
+        /* selected levels inside and outside of the frustum */
+        size_t visibleMeshes = 0;
+        size_t culledMeshes = 0;
+        /* nodes whose visibility was set, the scene only needs a flush if there are any */
+        size_t changedMeshes = 0;
+        double milliseconds = 0.0;
+    };
+
+    /**
+     * @brief Hides mesh nodes whose bounding boxes are outside of the camera frustum.
+     *
+     * Only the levels selected by the LodSwitcher are shown, so the culler is the only one setting
+     * the visibility of the nodes. Culling runs again whenever the camera or the selection moved.
+     * The camera must not have parent nodes, its rotation is applied around x, then y, then z.
+     */
+    class FrustumCuller
+    {
+    public:
+        /* meshes and mesh nodes as created by ObjImporter */
+        FrustumCuller(const std::vector<ObjGeometry::indexed_mesh>& meshes, const std::vector<ramses::MeshNode*>& nodes);
+
+        /* returns true if culling ran, i.e. the camera moved or the lod selection changed */
+        bool update(const ramses::PerspectiveCamera& camera, const LodSwitcher& lodSwitcher, bool selectionChanged);
+
+        /* results of the last culling pass */
+        const CullStatistics& getStatistics() const
+        {
+            return m_statistics;
+        }
+
+    private:
+        struct Bounds
+        {
+            float minimum[3];
+            float maximum[3];
+        };
+
+        /* inward facing planes n * p + d >= 0 */
+        struct Plane
+        {
+            float normal[3];
+            float d;
+        };
+
+        void computeFrustum(const ramses::PerspectiveCamera& camera);
+        bool isInside(const Bounds& bounds) const;
+
+        std::vector<Bounds> m_bounds;
+        std::vector<ramses::MeshNode*> m_nodes;
+        std::vector<unsigned char> m_visible;
+
+        Plane m_planes[6];
+        /* translation, rotation and frustum of the last culled camera */
+        float m_cameraState[10];
+        bool m_culled = false;
+        CullStatistics m_statistics;
+    };
+}
+
+#endif
@@ -0,0 +1,57 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_GEOMETRYCACHE
+#define OBJ2RAMSES_GEOMETRYCACHE
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+
+#include "ObjGeometry.h"
+
+namespace obj2ramses
+{
+    /**
+     * @brief On-disk cache of processed GPU meshes, keyed by a hash of the OBJ content and import options.
+     *
+     * Every entry is one file in the cache directory. The layout is a fixed header, a table with
+     * one entry per mesh and the raw attribute and index arrays and names, each 16 byte aligned, so
+     * loading copies them straight out of the memory-mapped entry without any parsing. Entries are written in native byte
+     * order; files with another version, byte order or key are ignored.
+     *
+     * Loading an entry updates its modification time. When the cache grows beyond the size
+     * limit, the entries which were not used for the longest time are removed.
+     */
+    class GeometryCache
+    {
+    public:
+        /* sizeLimit in bytes, 0 disables eviction; log receives the evicted entries */
+        GeometryCache(const std::string& directory, uint64_t sizeLimit, std::ostream& log = std::cout);
+
+        /* xxHash64 of the data */
+        static uint64_t Hash(const void* data, size_t size, uint64_t seed);
+
+        bool load(uint64_t key, std::vector<ObjGeometry::indexed_mesh>& meshes, bool& use32BitIndices) const;
+        bool store(uint64_t key, const std::vector<ObjGeometry::indexed_mesh>& meshes, bool use32BitIndices) const;
+
+        /* removes least recently used entries until the cache fits into the size limit */
+        void evict() const;
+
+    private:
+        std::string getEntryFile(uint64_t key) const;
+
+        const std::string m_directory;
+        const uint64_t m_sizeLimit;
+        std::ostream& m_log;
+    };
+}
+
+#endif
@@ -0,0 +1,70 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_JSONWRITER
+#define OBJ2RAMSES_JSONWRITER
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace obj2ramses
+{
+    /**
+     * @brief Minimal streaming JSON writer.
+     *
+     * Values are written directly to the stream, the writer only keeps track of nesting to
+     * place separators and indentation. Inside objects every value must be preceded by key().
+     * With indent 0 everything is written on one line, e.g. for line delimited JSON.
+     */
+    class JsonWriter
+    {
+    public:
+        explicit JsonWriter(std::ostream& stream, unsigned indent = 2);
+
+        JsonWriter& beginObject();
+        JsonWriter& endObject();
+        JsonWriter& beginArray();
+        JsonWriter& endArray();
+
+        JsonWriter& key(const std::string& name);
+
+        JsonWriter& value(const std::string& text);
+        JsonWriter& value(const char* text);
+        JsonWriter& value(bool flag);
+        JsonWriter& value(int64_t number);
+        JsonWriter& value(uint64_t number);
+        JsonWriter& value(int number);
+        JsonWriter& value(unsigned number);
+        JsonWriter& value(double number);
+        JsonWriter& null();
+
+        /* significant digits of floating point values, the default of 17 round-trips doubles */
+        void setPrecision(unsigned digits);
+
+    private:
+        void beginValue();
+        void newLine();
+        void writeString(const std::string& text);
+
+        std::ostream& m_stream;
+        const unsigned m_indent;
+        unsigned m_precision = 17;
+
+        struct Scope
+        {
+            bool isObject;
+            bool isEmpty;
+        };
+        std::vector<Scope> m_scopes;
+        bool m_afterKey = false;
+    };
+}
+
+#endif
@@ -0,0 +1,74 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_LODSWITCHER
+#define OBJ2RAMSES_LODSWITCHER
+
+#include <vector>
+#include <cstddef>
+
+#include "ObjGeometry.h"
+
+namespace ramses
+{
+    class PerspectiveCamera;
+}
+
+namespace obj2ramses
+{
+    /**
+     * @brief Selects one level of detail per mesh, depending on its distance to the camera.
+     *
+     * The coarsest level whose simplification error projects to at most pixelError pixels on
+     * screen is selected, the other levels of the mesh are not. Meshes are approximated by their
+     * bounding spheres, the camera must not have parent nodes. FrustumCuller shows the selected
+     * levels.
+     */
+    class LodSwitcher
+    {
+    public:
+        /* meshes as created by ObjImporter, the levels of a mesh directly follow it */
+        explicit LodSwitcher(const std::vector<ObjGeometry::indexed_mesh>& meshes, float pixelError = 1.0f);
+
+        /* returns the number of meshes which switched their level */
+        size_t update(const ramses::PerspectiveCamera& camera);
+
+        /* whether the mesh with this index is the selected level of its mesh, meshes without levels always are */
+        bool isSelected(size_t mesh) const
+        {
+            return 0 != m_selected[mesh];
+        }
+
+        bool hasLevels() const
+        {
+            return !m_meshes.empty();
+        }
+
+    private:
+        struct Level
+        {
+            size_t mesh;
+            float error;
+        };
+
+        struct Mesh
+        {
+            float center[3];
+            float radius;
+            std::vector<Level> levels;
+            size_t selectedLevel;
+        };
+
+        const float m_pixelError;
+        /* only meshes with more than one level */
+        std::vector<Mesh> m_meshes;
+        std::vector<unsigned char> m_selected;
+    };
+}
+
+#endif
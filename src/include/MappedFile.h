@@ -0,0 +1,66 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_MAPPEDFILE
+#define OBJ2RAMSES_MAPPEDFILE
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace obj2ramses
+{
+    /**
+     * @brief Read-only memory mapping of a whole file, or a copy of it read into memory.
+     *
+     * The data stays valid until the object is destroyed or close() is called.
+     * Empty files can be opened, but have no mapping (data() returns nullptr).
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& fileName);
+        /**
+         * @brief Reads the file into memory instead of mapping it.
+         *
+         * For files which another process may rewrite meanwhile: a mapped file which is truncated
+         * raises SIGBUS on access. Fails if the size or modification time changed while reading.
+         */
+        bool read(const std::string& fileName);
+        void close();
+
+        const char* data() const
+        {
+            return m_data;
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+    private:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        /* the data after read(), empty for a mapping */
+        std::vector<char> m_buffer;
+
+#if defined(_WIN32)
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+}
+
+#endif
@@ -0,0 +1,131 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_MEMORYARENA
+#define OBJ2RAMSES_MEMORYARENA
+
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace obj2ramses
+{
+    /**
+     * @brief Bump allocator for the temporary buffers of one import.
+     *
+     * Memory is handed out from large blocks and only returned all at once, by reset() or
+     * release(). Freeing single allocations does nothing, except for the most recent one, so
+     * buffers should be reserved with their final size, see ObjParser::countRecords().
+     *
+     * After reset() the next import gets one block as large as everything the previous one
+     * used, which keeps repeated imports of similar files from going back to the system. The
+     * arena is not thread safe.
+     */
+    class MemoryArena
+    {
+    public:
+        explicit MemoryArena(size_t minimumBlockSize = 1u << 20);
+        ~MemoryArena();
+
+        MemoryArena(const MemoryArena&) = delete;
+        MemoryArena& operator=(const MemoryArena&) = delete;
+
+        void* allocate(size_t size, size_t alignment);
+        void deallocate(void* memory, size_t size);
+
+        /* frees all allocations, the memory is kept for the next import */
+        void reset();
+        /* frees all allocations and returns the memory to the system */
+        void release();
+
+        /* bytes currently allocated from the arena */
+        size_t getUsedBytes() const;
+        /* bytes currently held, used or not */
+        size_t getCapacity() const;
+
+    private:
+        struct Block
+        {
+            char* memory;
+            size_t size;
+            size_t used;
+        };
+
+        void freeBlocks();
+
+        const size_t m_minimumBlockSize;
+        /* size of the first block, grows to what the previous imports needed */
+        size_t m_firstBlockSize;
+        std::vector<Block> m_blocks;
+    };
+
+    /**
+     * @brief Standard allocator on top of a MemoryArena.
+     *
+     * Without an arena it falls back to the heap, so containers using it stay usable everywhere
+     * and only the importer needs to know about arenas.
+     */
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        ArenaAllocator(MemoryArena* arena = nullptr)
+            : m_arena(arena)
+        {
+        }
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other)
+            : m_arena(other.getArena())
+        {
+        }
+
+        T* allocate(size_t count)
+        {
+            if (nullptr == m_arena)
+                return static_cast<T*>(::operator new(count * sizeof(T)));
+            return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* memory, size_t count)
+        {
+            if (nullptr == m_arena)
+                ::operator delete(memory);
+            else
+                m_arena->deallocate(memory, count * sizeof(T));
+        }
+
+        MemoryArena* getArena() const
+        {
+            return m_arena;
+        }
+
+    private:
+        MemoryArena* m_arena;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+    {
+        return a.getArena() == b.getArena();
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+    {
+        return a.getArena() != b.getArena();
+    }
+}
+
+#endif
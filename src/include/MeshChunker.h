@@ -0,0 +1,54 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_MESHCHUNKER
+#define OBJ2RAMSES_MESHCHUNKER
+
+#include <vector>
+#include <cstddef>
+
+#include "ObjGeometry.h"
+
+namespace obj2ramses
+{
+    /**
+     * @brief Splits an indexed mesh into spatially compact chunks of at most a given number of triangles.
+     *
+     * The triangles are sorted into a bounding volume hierarchy: a range of triangles is split at
+     * the median of their centroids along the longest axis of the range until it is small enough.
+     * The leaves become the chunks, in depth first order, so neighboring chunks are also close in
+     * space. Vertices on the border between two chunks are duplicated.
+     */
+    class MeshChunker
+    {
+    public:
+        explicit MeshChunker(size_t maxTrianglesPerChunk);
+
+        /* appends the chunks of mesh to chunks */
+        void partition(const ObjGeometry::indexed_mesh& mesh, std::vector<ObjGeometry::indexed_mesh>& chunks);
+
+    private:
+        void computeCentroids(const ObjGeometry::indexed_mesh& mesh);
+        /* index of the longest axis of the centroid bounds of m_triangles[begin, end) */
+        unsigned getSplitAxis(size_t begin, size_t end) const;
+        void appendChunk(const ObjGeometry::indexed_mesh& mesh, size_t begin, size_t end, std::vector<ObjGeometry::indexed_mesh>& chunks);
+
+        const size_t m_maxTriangles;
+
+        /* three coordinates per triangle */
+        std::vector<float> m_centroids;
+        /* triangles in hierarchy order, each leaf is a consecutive range */
+        std::vector<unsigned> m_triangles;
+
+        /* chunk local index of each mesh vertex, valid if m_vertexChunk matches the current chunk */
+        std::vector<unsigned> m_localIndex;
+        std::vector<unsigned> m_vertexChunk;
+    };
+}
+
+#endif
@@ -0,0 +1,69 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_MESHOPTIMIZER
+#define OBJ2RAMSES_MESHOPTIMIZER
+
+#include <vector>
+#include <cstddef>
+
+#include "ObjGeometry.h"
+
+namespace obj2ramses
+{
+    struct VertexCacheStatistics
+    {
+        size_t triangleCount = 0;
+        size_t vertexCount = 0;
+        size_t cacheMisses = 0;
+
+        /* average cache miss ratio: vertex shader invocations per triangle, 0.5 is the ideal for large grids */
+        double getACMR() const
+        {
+            return 0 == triangleCount ? 0.0 : static_cast<double>(cacheMisses) / static_cast<double>(triangleCount);
+        }
+
+        /* average transformed vertex ratio: vertex shader invocations per vertex, 1.0 is the ideal */
+        double getATVR() const
+        {
+            return 0 == vertexCount ? 0.0 : static_cast<double>(cacheMisses) / static_cast<double>(vertexCount);
+        }
+    };
+
+    /**
+     * @brief Reorders triangles and vertices of an indexed mesh for the GPU.
+     *
+     * Triangles are first reordered for the post-transform vertex cache with Tipsify
+     * (Sander, Nehab, Barczak: "Fast Triangle Reordering for Vertex Locality and Reduced
+     * Overdraw", 2007). Optionally the clusters Tipsify produces are then sorted by a
+     * view-independent occlusion estimate, so outward facing parts are drawn first.
+     * Finally vertices are renumbered in order of first use for fetch locality.
+     */
+    class MeshOptimizer
+    {
+    public:
+        explicit MeshOptimizer(unsigned cacheSize = 16);
+
+        void optimize(ObjGeometry::indexed_mesh& mesh, bool reorderForOverdraw);
+
+        /* simulates a FIFO post-transform cache of the configured size */
+        VertexCacheStatistics analyze(const ObjGeometry::indexed_mesh& mesh) const;
+
+    private:
+        void reorderForVertexCache(ObjGeometry::indexed_mesh& mesh);
+        void reorderClustersForOverdraw(ObjGeometry::indexed_mesh& mesh) const;
+        void reorderVertices(ObjGeometry::indexed_mesh& mesh) const;
+
+        const unsigned m_cacheSize;
+
+        /* first triangle of each Tipsify cluster, i.e. after each dead end */
+        std::vector<size_t> m_clusterStarts;
+    };
+}
+
+#endif
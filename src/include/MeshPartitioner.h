@@ -0,0 +1,48 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_MESHPARTITIONER
+#define OBJ2RAMSES_MESHPARTITIONER
+
+#include <vector>
+#include <cstddef>
+
+#include "ObjGeometry.h"
+
+namespace obj2ramses
+{
+    /**
+     * @brief Splits an indexed mesh into parts which each reference at most a given number of vertices.
+     *
+     * Parts are grown triangle by triangle across shared vertices (breadth first), so every part is a
+     * connected patch of the surface and only vertices on the border between two parts are duplicated.
+     */
+    class MeshPartitioner
+    {
+    public:
+        explicit MeshPartitioner(size_t maxVerticesPerPart);
+
+        /* appends the parts of mesh to parts */
+        void partition(const ObjGeometry::indexed_mesh& mesh, std::vector<ObjGeometry::indexed_mesh>& parts);
+
+    private:
+        void buildAdjacency(const ObjGeometry::indexed_mesh& mesh);
+
+        const size_t m_maxVertices;
+
+        /* triangles around each vertex in compressed row storage */
+        std::vector<unsigned> m_vertexTriangleOffsets;
+        std::vector<unsigned> m_vertexTriangles;
+
+        /* part local index of each mesh vertex, valid if m_vertexPart matches the current part */
+        std::vector<unsigned> m_localIndex;
+        std::vector<unsigned> m_vertexPart;
+    };
+}
+
+#endif
@@ -0,0 +1,110 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_MESHSIMPLIFIER
+#define OBJ2RAMSES_MESHSIMPLIFIER
+
+#include <vector>
+#include <cstddef>
+
+#include "ObjGeometry.h"
+
+namespace obj2ramses
+{
+    struct SimplifyStatistics
+    {
+        size_t triangleCount = 0;
+        /* largest deviation of a collapse from the surface it replaced, in mesh units */
+        float error = 0.0f;
+        size_t passes = 0;
+    };
+
+    /**
+     * @brief Reduces the triangle count of an indexed mesh by quadric error metric edge collapses.
+     *
+     * Every vertex accumulates the planes of its triangles (Garland, Heckbert: "Surface
+     * Simplification Using Quadric Error Metrics", 1997) and edges are collapsed onto one of
+     * their end points, so the remaining vertices keep their attributes. Instead of a priority
+     * queue the collapses are done in passes: all edges are sorted by error in linear time and
+     * the cheapest ones which do not flip triangles or fold the surface onto itself are collapsed
+     * at once. A collapse locks the triangles around the vertex it moves for the rest of the pass,
+     * so the collapses of one pass never touch the same triangle and each is checked against the
+     * unchanged mesh. Each pass is linear in the size of the mesh and removes a constant fraction
+     * of it.
+     *
+     * Vertices on open borders and attribute seams (edges used by only one triangle) and on
+     * non-manifold edges do not move, so neither the outline nor texture or normal seams tear.
+     */
+    class MeshSimplifier
+    {
+    public:
+        /**
+         * @brief Simplifies mesh into out until it has targetTriangles or the next collapse would exceed maxError.
+         *
+         * @param maxError in mesh units, 0 only allows collapses without any error
+         */
+        SimplifyStatistics simplify(const ObjGeometry::indexed_mesh& mesh, size_t targetTriangles, float maxError, ObjGeometry::indexed_mesh& out);
+
+    private:
+        /* double precision, the squared distances of fine meshes are far below the float resolution of the sums */
+        struct Quadric
+        {
+            double a00, a11, a22, a01, a02, a12;
+            double b0, b1, b2;
+            double c;
+            /* area of the accumulated triangles */
+            double weight;
+        };
+
+        struct Collapse
+        {
+            unsigned from;
+            unsigned to;
+            float error;
+        };
+
+        void normalizePositions(const ObjGeometry::indexed_mesh& mesh);
+        void buildAdjacency(size_t vertexCount);
+        void lockBorderVertices();
+        void computeQuadrics();
+        float getCollapseError(unsigned from, unsigned to) const;
+        bool flipsTriangle(unsigned from, unsigned to) const;
+        size_t countEdgeTriangles(unsigned from, unsigned to) const;
+        /* whether the end points have other common neighbors than the corners opposite of the edge */
+        bool violatesLinkCondition(unsigned from, unsigned to, size_t edgeTriangles);
+        void collectNeighbors(unsigned vertex, std::vector<unsigned>& neighbors) const;
+        void sortCollapses();
+        /* returns the largest error of the collapses done */
+        float collapseEdges(size_t targetTriangles, float errorLimit);
+        /* collapses the sorted edges up to passLimit, returns the number of triangles removed */
+        size_t collapseSortedEdges(size_t targetTriangles, float passLimit, float& largestError);
+        void removeCollapsedTriangles();
+
+        /* positions scaled into the unit cube, floats lose too much precision on large coordinates otherwise */
+        std::vector<float> m_positions;
+        /* size of the mesh, converts errors back to mesh units */
+        float m_scale = 1.0f;
+        std::vector<unsigned> m_indices;
+        std::vector<Quadric> m_quadrics;
+        std::vector<unsigned char> m_locked;
+        std::vector<unsigned> m_remap;
+
+        /* triangles of vertex i are m_adjacency[m_adjacencyOffsets[i], m_adjacencyOffsets[i + 1]) */
+        std::vector<unsigned> m_adjacencyOffsets;
+        std::vector<unsigned> m_adjacency;
+
+        std::vector<Collapse> m_collapses;
+        std::vector<Collapse> m_sortedCollapses;
+        /* vertices on triangles changed by a collapse of the current pass */
+        std::vector<unsigned char> m_collapsed;
+        std::vector<unsigned> m_fromNeighbors;
+        std::vector<unsigned> m_toNeighbors;
+    };
+}
+
+#endif
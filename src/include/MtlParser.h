@@ -0,0 +1,65 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_MTLPARSER
+#define OBJ2RAMSES_MTLPARSER
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "ObjParser.h"
+
+namespace obj2ramses
+{
+    /* The part of an MTL material the importer can show: diffuse color, opacity and diffuse texture */
+    struct Material
+    {
+        std::string name;
+        /* Kd */
+        float diffuse[3] = { 0.8f, 0.8f, 0.8f };
+        /* d, or 1 - Tr */
+        float opacity = 1.0f;
+        /* map_Kd resolved against the directory of the MTL file, empty without texture */
+        std::string diffuseTexture;
+    };
+
+    /**
+     * @brief Parses MTL material libraries referenced by mtllib records.
+     *
+     * Only newmtl, Kd, d, Tr and map_Kd are evaluated, all other statements (specular and
+     * ambient terms, illumination models, other texture maps) are counted as skipped. Texture
+     * options like "-s 1 1 1" are ignored, the last token of map_Kd is the file name.
+     */
+    class MtlParser
+    {
+    public:
+        /* appends the materials of the file, false if it cannot be read */
+        bool parseFile(const std::string& mtlFile, std::vector<Material>& materials);
+
+        /* directory resolves the texture paths */
+        void parse(const char* begin, const char* end, const std::string& directory, std::vector<Material>& materials);
+
+        /* statements of unsupported types */
+        size_t getSkippedCount() const
+        {
+            return m_skippedCount;
+        }
+
+        size_t getErrorCount() const
+        {
+            return m_errorCount;
+        }
+
+    private:
+        size_t m_skippedCount = 0;
+        size_t m_errorCount = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,83 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_NORMALGENERATOR
+#define OBJ2RAMSES_NORMALGENERATOR
+
+#include <vector>
+#include <cstddef>
+
+#include "ObjGeometry.h"
+
+namespace obj2ramses
+{
+    enum ENormalWeighting
+    {
+        /* larger faces contribute more to the vertex normal */
+        ENormalWeighting_Area = 0,
+        /* faces contribute by their angle at the vertex, independent of the tessellation */
+        ENormalWeighting_Angle
+    };
+
+    struct NormalStatistics
+    {
+        /* positions used by faces */
+        size_t vertexCount = 0;
+        /* normals generated, more than vertexCount if creases split vertices */
+        size_t normalCount = 0;
+    };
+
+    /**
+     * @brief Computes smooth vertex normals for OBJ faces without normals.
+     *
+     * Every face corner gets the weighted average of the normals of all faces sharing its position.
+     * With a crease angle below 180 degrees only faces whose normals deviate less than that from
+     * the corner's own face are averaged, so hard edges stay sharp and their positions get several
+     * normals.
+     *
+     * Work is split across threads in two phases without locks: face normals and corner weights
+     * are computed per face, then every thread gathers the contributions of its own range of
+     * positions through a position-to-corner table.
+     */
+    class NormalGenerator
+    {
+    public:
+        NormalGenerator(ENormalWeighting weighting, float creaseAngleDegrees, unsigned threadCount);
+
+        /* replaces the normals and face normal indices of mesh */
+        NormalStatistics generate(ObjGeometry::mesh_data& mesh);
+
+    private:
+        void computeFaceNormals(const ObjGeometry::mesh_data& mesh, size_t firstFace, size_t lastFace);
+        /* returns the number of positions used by faces */
+        size_t buildVertexCorners(const ObjGeometry::mesh_data& mesh);
+        void gatherSmoothNormals(ObjGeometry::mesh_data& mesh, size_t firstVertex, size_t lastVertex);
+        /* positions get a varying number of normals, they are counted first and written once the offsets are known */
+        ObjGeometry::vertex_normal_3f computeCreasedNormal(unsigned begin, unsigned end, unsigned corner) const;
+        void countCreasedNormals(ObjGeometry::mesh_data& mesh, size_t firstVertex, size_t lastVertex);
+        void writeCreasedNormals(ObjGeometry::mesh_data& mesh, size_t firstVertex, size_t lastVertex);
+
+        const ENormalWeighting m_weighting;
+        const bool m_useCreaseAngle;
+        const float m_creaseCosine;
+        const unsigned m_threadCount;
+
+        /* unit normal per face, zero for degenerate faces */
+        std::vector<ObjGeometry::vertex_normal_3f> m_faceNormals;
+        /* face and weight of every corner */
+        std::vector<unsigned> m_cornerFaces;
+        std::vector<float> m_cornerWeights;
+        /* corners of position i are m_vertexCorners[m_vertexCornerOffsets[i], m_vertexCornerOffsets[i + 1]) */
+        std::vector<unsigned> m_vertexCornerOffsets;
+        std::vector<unsigned> m_vertexCorners;
+        /* first normal of each position when creases split positions */
+        std::vector<unsigned> m_vertexNormalOffsets;
+    };
+}
+
+#endif
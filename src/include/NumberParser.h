@@ -0,0 +1,57 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_NUMBERPARSER
+#define OBJ2RAMSES_NUMBERPARSER
+
+#include <cstdint>
+#include <cstddef>
+
+namespace obj2ramses
+{
+    enum EParseError
+    {
+        EParseError_None = 0,
+        /* no number at the beginning of the text */
+        EParseError_InvalidArgument,
+        /* a number, but it does not fit into the result type */
+        EParseError_OutOfRange
+    };
+
+    /* like std::from_chars_result: ptr is the first character after the number */
+    struct ParseResult
+    {
+        const char* ptr;
+        EParseError error;
+    };
+
+    /**
+     * @brief Locale independent number parsing directly from a text buffer, similar to std::from_chars.
+     *
+     * Nothing needs to be terminated, nothing is allocated and nothing is thrown. A leading '+' is
+     * accepted, leading whitespace is not. On error the value is left unchanged.
+     */
+    namespace NumberParser
+    {
+        /**
+         * @brief Parses a decimal floating point number like "-1.5e-3", "inf" or "nan", correctly rounded.
+         *
+         * Numbers with at most 19 significant digits and small exponents take an exact fast path,
+         * all others are converted by the standard library in the classic "C" locale. As with strtof,
+         * numbers beyond the float range give infinity and numbers below it zero, not an error.
+         */
+        ParseResult parseFloat(const char* begin, const char* end, float& value);
+
+        ParseResult parseUnsigned(const char* begin, const char* end, uint32_t& value);
+
+        /* length of the run of decimal digits at begin, scanned 16 bytes at a time where SSE2 is available */
+        size_t scanDigits(const char* begin, const char* end);
+    }
+}
+
+#endif
@@ -2,12 +2,24 @@
 #define GEOMETRY_H
 
 #include <vector>
+#include <limits>
+#include <string>
+
+#include "MemoryArena.h"
 
 namespace obj2ramses {
 namespace ObjGeometry {
 
 using std::vector;
 
+/* buffers of the parsed OBJ data, allocated from the importer's arena if there is one */
+template <typename T>
+using arena_vector = std::vector<T, ArenaAllocator<T>>;
+typedef arena_vector<unsigned> index_vector;
+
+/* marks a face corner without texture coordinate or normal */
+const unsigned invalid_index = std::numeric_limits<unsigned>::max();
+
 
 struct vertex3f {
     float x, y, z;
@@ -21,9 +33,91 @@ struct vertex_normal_3f {
     float x, y, z;
 };
 
-struct face {
-    vector<unsigned> v, vt, vn;
-    unsigned long len = v.size();
+/*
+ * All faces of a mesh as structure of arrays. The corners of face i are the entries
+ * [offsets[i], offsets[i + 1]) of the index streams. vt and vn are either empty or
+ * parallel to v, corners without texture coordinate or normal hold invalid_index.
+ */
+struct face_store {
+    explicit face_store(MemoryArena* arena = nullptr)
+        : v(arena), vt(arena), vn(arena), offsets(1, 0u, arena) {
+    }
+
+    index_vector v, vt, vn;
+    index_vector offsets;
+
+    /* triangles after fan triangulation of all faces, kept up to date by add_face */
+    size_t triangle_count = 0;
+
+    size_t size() const {
+        return offsets.size() - 1;
+    }
+
+    size_t corner_count() const {
+        return v.size();
+    }
+
+    bool empty() const {
+        return v.empty();
+    }
+
+    /* closes a face whose corners were appended to the index streams */
+    void add_face() {
+        const unsigned corners = static_cast<unsigned>(v.size()) - offsets.back();
+        offsets.push_back(static_cast<unsigned>(v.size()));
+        triangle_count += corners - 2;
+    }
+};
+
+enum name_kind {
+    name_object,    /* o */
+    name_group,     /* g */
+    name_material   /* usemtl */
+};
+
+/* an o, g or usemtl record, it applies to the faces from first_face on */
+struct name_change {
+    size_t first_face;
+    name_kind kind;
+    std::string name;
+};
+
+struct mesh_data {
+    explicit mesh_data(MemoryArena* arena = nullptr)
+        : vertices(arena), tex_coords(arena), normals(arena), faces(arena) {
+    }
+
+    arena_vector<vertex3f> vertices;
+    arena_vector<tex_coord_3f> tex_coords;
+    arena_vector<vertex_normal_3f> normals;
+    face_store faces;
+    /* in file order */
+    vector<name_change> name_changes;
+};
+
+/*
+ * Mesh as uploaded to the GPU: one entry per unique (v, vt, vn) combination in each
+ * attribute stream and a triangle list indexing them. tex_coords and normals are
+ * empty if the faces have none.
+ */
+struct indexed_mesh {
+    vector<float> positions;   /* 3 floats per vertex */
+    vector<float> tex_coords;  /* 2 floats per vertex */
+    vector<float> normals;     /* 3 floats per vertex */
+    vector<unsigned> indices;
+
+    /* mesh node name and OBJ material (usemtl), empty without material */
+    std::string name;
+    std::string material;
+
+    /* level of detail, 0 is the full mesh and coarser levels directly follow it */
+    unsigned lod = 0;
+    /* simplification error of the level in mesh units */
+    float lod_error = 0.0f;
+
+    size_t vertex_count() const {
+        return positions.size() / 3;
+    }
 };
 
 }}
@@ -11,8 +11,17 @@
 
 #include <string>
 #include <array>
+#include <iostream>
+#include <map>
+#include <cstdint>
 
 #include "ObjGeometry.h"
+#include "MemoryArena.h"
+#include "NormalGenerator.h"
+#include "EffectCache.h"
+#include "MtlParser.h"
+#include "TextureLoader.h"
+#include "SceneFootprint.h"
 #include "ramses-client-api/RenderGroup.h"
 
 using std::string;
@@ -21,42 +30,223 @@ using std::vector;
 using obj2ramses::ObjGeometry::vertex3f;
 using obj2ramses::ObjGeometry::tex_coord_3f;
 using obj2ramses::ObjGeometry::vertex_normal_3f;
-using obj2ramses::ObjGeometry::face;
+using obj2ramses::ObjGeometry::face_store;
 
 namespace ramses
 {
     class RamsesClient;
     class Scene;
+    class Effect;
+    class Appearance;
+    class MeshNode;
+    class Resource;
+    class TextureSampler;
+    class GeometryBinding;
 }
 
 namespace obj2ramses
 {
+    enum EIndexWidthPolicy
+    {
+        /* 16 bit indices if the mesh fits, otherwise 32 bit if the target allows it, otherwise split */
+        EIndexWidthPolicy_Auto = 0,
+        /* always 32 bit indices */
+        EIndexWidthPolicy_UInt32,
+        /* always 16 bit indices, meshes with too many vertices are split into several mesh nodes */
+        EIndexWidthPolicy_Split16
+    };
+
+    struct ImportOptions
+    {
+        /* number of threads used to parse the file and generate normals, 0 uses all hardware threads */
+        unsigned threadCount = 1;
+
+        EIndexWidthPolicy indexWidthPolicy = EIndexWidthPolicy_Auto;
+        /* whether the target renderer can draw with 32 bit index buffers, considered by EIndexWidthPolicy_Auto */
+        bool targetSupportsUInt32Indices = true;
+
+        /* reorder triangles for the post-transform vertex cache and vertices for fetch locality */
+        bool optimizeVertexCache = false;
+        /* additionally reorder triangle clusters to reduce overdraw, implies optimizeVertexCache */
+        bool optimizeOverdraw = false;
+        /* post-transform cache size (in vertices) to optimize for and to report ACMR/ATVR with */
+        unsigned vertexCacheSize = 16;
+
+        /* read the materials of mtllib records and decode their diffuse textures in the background */
+        bool loadMaterials = true;
+        /* parse the OBJ file from a memory mapping, otherwise from a copy, e.g. for files an editor may rewrite during the import */
+        bool mapFile = true;
+
+        /* compute smooth normals if no face of the file has normals */
+        bool generateNormals = true;
+        ENormalWeighting normalWeighting = ENormalWeighting_Area;
+        /* faces meeting at a larger angle (in degrees) get separate normals along their edge, 180 smooths everything */
+        float creaseAngle = 180.0f;
+
+        /* meshes with more triangles are cut into spatially compact chunks of at most this size for culling, 0 disables it */
+        size_t chunkTriangles = 0;
+
+        /* triangle count of each level of detail relative to the full mesh, e.g. 0.5, 0.25; no levels if both lists are empty */
+        std::vector<float> lodTriangleRatios;
+        /* largest simplification error of each level relative to the mesh size, missing entries do not limit the error */
+        std::vector<float> lodMaxErrors;
+
+        /* directory of the caches for processed meshes (by OBJ content and options) and compiled effects, empty disables them */
+        std::string cacheDirectory;
+        /* least recently used cache entries are removed when the cache grows beyond this size in bytes, 0 is unlimited */
+        uint64_t cacheSizeLimit = 512ull << 20;
+    };
+
+    /* what ObjImporter::reload() kept and replaced */
+    struct ReloadStatistics
+    {
+        size_t keptMeshes = 0;
+        size_t createdMeshes = 0;
+        size_t removedMeshes = 0;
+        size_t createdArrays = 0;
+        size_t destroyedArrays = 0;
+    };
+
     class ObjImporter
     {
     public:
 
-        ObjImporter(ramses::RamsesClient& client, ramses::Scene& scene);
+        /**
+         * @param arena holds the parsed OBJ data during an import. An arena passed in keeps its memory for
+         * the next import using it, without one the importer uses its own and frees it after each import.
+         * @param log receives the progress messages, errors go to std::cerr
+         * @param effectCache shares the effects with the other importers using it, without one the importer uses its own
+         */
+        ObjImporter(ramses::RamsesClient& client, ramses::Scene& scene, const ImportOptions& options = ImportOptions(), MemoryArena* arena = nullptr,
+            std::ostream& log = std::cout, EffectCache* effectCache = nullptr);
 
         bool importFromFile(const std::string& objFile);
 
         ramses::RenderGroup* getRamsesRenderGroup();
 
+        /**
+         * @brief Replaces the meshes of the render group with the meshes of another import of the file.
+         *
+         * reloaded only needs to have run importFromFile, e.g. on a background thread. Meshes keep
+         * their node if name, material and content are unchanged; arrays are looked up by content
+         * hash, so only arrays with new content are created. Effects, appearances, textures and
+         * everything outside of the render group stay as they are, as does the material library.
+         */
+        ReloadStatistics reload(ObjImporter& reloaded);
+
+        /* memory of the mesh nodes and of the arrays and textures they use, after getRamsesRenderGroup */
+        SceneFootprint getFootprint() const;
+
+        /* client resources (effect, arrays) created by getRamsesRenderGroup, e.g. to save them to a resource file */
+        const vector<const ramses::Resource*>& getResources() const
+        {
+            return m_resources;
+        }
+
+        /* destroys the resources after the scene, effects shared with other importers stay until their last user is done */
+        void destroyResources();
+
+        /* GPU meshes built by importFromFile, the levels of detail of a mesh directly follow it */
+        const vector<ObjGeometry::indexed_mesh>& getMeshes() const
+        {
+            return m_meshes;
+        }
+
+        /* mesh node of each mesh created by getRamsesRenderGroup, only level 0 is visible */
+        const vector<ramses::MeshNode*>& getMeshNodes() const
+        {
+            return m_meshNodes;
+        }
+
+        /* conversion of a GPU mesh to the ramses array layouts */
+        static int computeIndexCount(const ObjGeometry::indexed_mesh& mesh);
+        static vector<uint16_t> getIndexArray(const ObjGeometry::indexed_mesh& mesh);
+        static vector<float> getVertexArray(const ObjGeometry::indexed_mesh& mesh);
+
     private:
         void createDummyScene();
 
         ramses::RamsesClient& m_client;
         ramses::Scene& m_scene;
-
-        vector<vertex3f> vertices;
-        vector<tex_coord_3f> tex_coords;
-        vector<vertex_normal_3f> normals;
-        vector<face> faces;
-
-        std::vector<string> tokenize(string line, char delim = ' ');
-
-        int computeIndexCount();
-        vector<uint16_t> getIndexArray();
-        vector<float> getVertexArray();
+        const ImportOptions m_options;
+        std::ostream& m_log;
+        EffectCache m_ownEffectCache;
+        EffectCache& m_effectCache;
+        size_t m_effectCacheHits = 0;
+        size_t m_effectCacheMisses = 0;
+
+        std::string m_name;
+        MemoryArena m_ownArena;
+        MemoryArena& m_arena;
+        /* parsed OBJ data, only alive during importFromFile */
+        ObjGeometry::mesh_data m_mesh;
+        /* GPU meshes, one per object, group and material, more if meshes were chunked or split to fit 16 bit indices */
+        vector<ObjGeometry::indexed_mesh> m_meshes;
+        bool m_use32BitIndices = false;
+
+        /* materials of the mtllib records and the texture of each, textures decode during the import */
+        vector<Material> m_materials;
+        std::map<std::string, size_t> m_materialByName;
+        TextureLoader m_textureLoader;
+        /* sampler per texture, shared by textures with the same content */
+        std::map<size_t, const ramses::TextureSampler*> m_textureSamplers;
+        std::map<size_t, const ramses::Resource*> m_textureResources;
+
+        /* normals, diffuse texture */
+        typedef std::pair<bool, bool> ShaderVariant;
+
+        /* scene objects of a mesh node and the content hashes of its arrays */
+        struct MeshResources
+        {
+            ramses::GeometryBinding* geometry;
+            ShaderVariant variant;
+            vector<uint64_t> arrays;
+        };
+
+        /* array resources by content hash, shared by all meshes with the same data */
+        struct SharedArray
+        {
+            const ramses::Resource* resource;
+            size_t users;
+        };
+
+        ramses::RenderGroup* m_renderGroup = nullptr;
+        std::map<ShaderVariant, const ramses::Effect*> m_effects;
+        std::map<std::pair<ShaderVariant, std::string>, ramses::Appearance*> m_appearances;
+
+        vector<ramses::MeshNode*> m_meshNodes;
+        vector<MeshResources> m_meshResources;
+        std::map<uint64_t, SharedArray> m_arrays;
+        size_t m_createdArrayCount = 0;
+        size_t m_destroyedArrayCount = 0;
+        vector<const ramses::Resource*> m_resources;
+
+        uint64_t computeCacheKey(const char* data, size_t size) const;
+        bool parse(const std::string& objFile, const char* data, size_t size);
+        void releaseParsedData();
+        void generateNormals();
+        unsigned getThreadCount() const;
+        bool validateFaceIndices() const;
+        void buildIndexedMesh();
+        void chunkMeshes(vector<ObjGeometry::indexed_mesh>& meshes) const;
+        void generateLods();
+        void optimizeMeshes();
+        void loadMaterials(const std::string& objFile, const char* data, size_t size);
+        const Material* findMaterial(const std::string& name) const;
+        /* sampler of the diffuse texture of the material, nullptr without one */
+        const ramses::TextureSampler* getTextureSampler(const std::string& material);
+        const ramses::Effect* createEffect(bool hasNormals, bool hasTexture);
+        ramses::Appearance* createAppearance(const ramses::Effect& effect, const std::string& material, const ramses::TextureSampler* sampler);
+        ShaderVariant getShaderVariant(const ObjGeometry::indexed_mesh& mesh);
+        /* effect and appearance of the variant and material, created on first use */
+        ramses::Appearance& getAppearance(const ShaderVariant& variant, const std::string& material, const ramses::Effect*& effect);
+        /* draw order of the meshes with their shader variants, grouped by variant and material */
+        static vector<size_t> getDrawOrder(const vector<ObjGeometry::indexed_mesh>& meshes, const vector<ShaderVariant>& variants);
+        vector<uint64_t> getArrayKeys(const ObjGeometry::indexed_mesh& mesh, bool hasTexture) const;
+        ramses::MeshNode* createMeshNode(const ObjGeometry::indexed_mesh& mesh, const ShaderVariant& variant, MeshResources& resources);
+        template <typename ArrayType, typename Create>
+        const ArrayType* getArray(uint64_t key, Create create);
+        void releaseMesh(ramses::MeshNode& node, MeshResources& resources);
 
     };
 }
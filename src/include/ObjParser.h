@@ -0,0 +1,194 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_OBJPARSER
+#define OBJ2RAMSES_OBJPARSER
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+
+#include "ObjGeometry.h"
+
+namespace obj2ramses
+{
+    /**
+     * @brief Non-owning view on a range of characters, e.g. a line or a token inside a mapped file.
+     */
+    struct StringRange
+    {
+        StringRange() = default;
+        StringRange(const char* b, const char* e)
+            : begin(b), end(e)
+        {
+        }
+
+        size_t size() const
+        {
+            return static_cast<size_t>(end - begin);
+        }
+
+        bool empty() const
+        {
+            return begin == end;
+        }
+
+        bool equals(const char* literal) const
+        {
+            const size_t len = std::strlen(literal);
+            return len == size() && 0 == std::memcmp(begin, literal, len);
+        }
+
+        const char* begin = nullptr;
+        const char* end = nullptr;
+    };
+
+    /* Number of records in OBJ text, to allocate the parsed data at its final size up front */
+    struct RecordCounts
+    {
+        size_t vertices = 0;
+        size_t texCoords = 0;
+        size_t normals = 0;
+        size_t faces = 0;
+        size_t corners = 0;
+        /* whether any face corner references a texture coordinate or normal */
+        bool hasTexCoordIndices = false;
+        bool hasNormalIndices = false;
+    };
+
+    /* Records of a type the parser does not support */
+    struct SkippedRecords
+    {
+        std::string type;
+        size_t count;
+    };
+
+    /**
+     * @brief Parses OBJ text in place, without copying lines or tokens.
+     *
+     * Recognized records (v, vt, vn, f) are appended to the mesh_data passed on construction,
+     * object, group and material names (o, g, usemtl) are recorded as name changes, material
+     * libraries (mtllib) are left to the importer.
+     * Face indices are stored 0-based; negative (relative) indices are resolved against the
+     * number of elements parsed so far.
+     */
+    class ObjParser
+    {
+    public:
+        explicit ObjParser(ObjGeometry::mesh_data& data);
+
+        void parse(const char* begin, const char* end);
+
+        /**
+         * @brief Splits the text at line boundaries and parses the chunks on threadCount threads.
+         *
+         * Chunks are merged in file order and relative indices are resolved against the global
+         * element counts, so the result is identical to parse().
+         */
+        void parseParallel(const char* begin, const char* end, unsigned threadCount);
+
+        /**
+         * @brief Splits a line into tokens without allocating.
+         *
+         * With ' ' as delimiter runs of spaces and tabs count as one separator and empty tokens
+         * are skipped. With any other delimiter empty tokens are kept, so "1//3" split at '/'
+         * gives three tokens.
+         *
+         * @return the number of tokens in the line; only the first maxTokens are written to tokens.
+         */
+        static size_t tokenize(StringRange line, StringRange* tokens, size_t maxTokens, char delim = ' ');
+
+        /**
+         * @brief Counts the records of OBJ text without parsing any numbers.
+         *
+         * The counts are exact for well-formed files and an upper bound otherwise.
+         */
+        static RecordCounts countRecords(const char* begin, const char* end);
+
+        /**
+         * @brief Finds the file names of all mtllib records, without parsing anything else.
+         *
+         * Lets the importer load materials and textures while the geometry is parsed.
+         */
+        static std::vector<std::string> findMaterialLibraries(const char* begin, const char* end);
+
+        size_t getErrorCount() const
+        {
+            return m_errorCount;
+        }
+
+        /* Message of the first malformed record, see getFirstErrorLine() for its position */
+        const std::string& getFirstError() const
+        {
+            return m_firstError;
+        }
+
+        size_t getFirstErrorLine() const
+        {
+            return m_firstErrorLine;
+        }
+
+        size_t getLineCount() const
+        {
+            return m_lineCount;
+        }
+
+        /* unsupported records by type, in order of first occurrence */
+        const std::vector<SkippedRecords>& getSkippedRecords() const
+        {
+            return m_skippedRecords;
+        }
+
+    private:
+        enum EIndexType : unsigned char
+        {
+            EIndexType_Vertex = 0,
+            EIndexType_TexCoord,
+            EIndexType_Normal
+        };
+
+        /* A negative face index seen while parsing a chunk, resolved once the preceding chunks are known */
+        struct RelativeIndex
+        {
+            size_t corner;
+            size_t line;
+            EIndexType type;
+            long long localIndex;
+        };
+
+        ObjParser(ObjGeometry::mesh_data& data, bool deferRelativeIndices);
+
+        void reserve(const RecordCounts& counts);
+        void parseLine(StringRange line);
+        void parseFace(StringRange rest);
+        void addNameChange(ObjGeometry::name_kind kind, StringRange rest);
+        void skipRecord(StringRange type, size_t count);
+        bool parseIndex(StringRange token, EIndexType type, size_t corner, unsigned& index);
+        static void appendCornerIndices(ObjGeometry::index_vector& stream, size_t firstCorner, bool hasIndices, const ObjGeometry::index_vector& indices);
+        void reportError(const char* message, size_t line);
+        void mergeChunk(ObjGeometry::mesh_data& chunk, const ObjParser& chunkParser);
+
+        ObjGeometry::mesh_data& m_data;
+        const bool m_deferRelativeIndices;
+        std::vector<RelativeIndex> m_relativeIndices;
+
+        /* texture coordinate and normal indices of the face being parsed, reused across faces */
+        ObjGeometry::index_vector m_texCoordScratch;
+        ObjGeometry::index_vector m_normalScratch;
+
+        std::vector<SkippedRecords> m_skippedRecords;
+
+        size_t m_lineCount = 0;
+        size_t m_errorCount = 0;
+        size_t m_firstErrorLine = 0;
+        std::string m_firstError;
+    };
+}
+
+#endif
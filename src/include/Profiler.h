@@ -0,0 +1,106 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_PROFILER
+#define OBJ2RAMSES_PROFILER
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+namespace obj2ramses
+{
+    /**
+     * @brief Collects stage timings and counters of a conversion for the --profile report.
+     *
+     * Stages are named hierarchically ("import.parse", "scene.createEffect") and accumulate over
+     * all calls, e.g. over all files of a batch. Recording is thread safe and does nothing until
+     * the profiler is enabled.
+     *
+     * Heap allocations are only counted in builds with OBJ2RAMSES_COUNT_ALLOCATIONS, which replaces
+     * the global operator new. The count is process wide, so with concurrent jobs the allocations
+     * of a stage include those of other threads.
+     */
+    class Profiler
+    {
+    public:
+        static Profiler& Get();
+
+        void enable();
+
+        bool isEnabled() const
+        {
+            return m_enabled;
+        }
+
+        void addStage(const char* name, double milliseconds, uint64_t allocations, uint64_t allocatedBytes);
+        void addCounter(const char* name, uint64_t value);
+
+        /* JSON report of all stages, counters and memory statistics */
+        bool writeReport(const std::string& fileName) const;
+
+        static bool IsAllocationCountingEnabled();
+        static uint64_t GetAllocationCount();
+        static uint64_t GetAllocatedBytes();
+        /* peak resident set size of the process in bytes, 0 if unknown */
+        static uint64_t GetPeakResidentSetSize();
+
+    private:
+        Profiler() = default;
+
+        struct Stage
+        {
+            std::string name;
+            uint64_t calls;
+            double totalMilliseconds;
+            double maxMilliseconds;
+            uint64_t allocations;
+            uint64_t allocatedBytes;
+        };
+
+        struct Counter
+        {
+            std::string name;
+            uint64_t value;
+        };
+
+        bool m_enabled = false;
+
+        mutable std::mutex m_mutex;
+        /* in order of first use */
+        std::vector<Stage> m_stages;
+        std::vector<Counter> m_counters;
+    };
+
+    /**
+     * @brief Measures the enclosing scope as one call of a profiler stage.
+     */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(const char* stage);
+        ~ScopedTimer();
+
+        /* ends the measurement before the end of the scope */
+        void stop();
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        const char* const m_stage;
+        bool m_enabled;
+        std::chrono::steady_clock::time_point m_start;
+        uint64_t m_allocations = 0;
+        uint64_t m_allocatedBytes = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,83 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_PROGRAMOPTIONS
+#define OBJ2RAMSES_PROGRAMOPTIONS
+
+#include <string>
+#include <vector>
+
+#include "ObjImporter.h"
+#include "SceneToText.h"
+
+namespace obj2ramses
+{
+    /**
+     * @brief Options of the obj2ramses command line.
+     *
+     * Arguments which are not recognized are ignored, they may belong to the ramses
+     * framework or renderer configuration which parse the same command line.
+     */
+    struct ProgramOptions
+    {
+        bool parse(int argc, char* argv[]);
+
+        /* several inputs or a directory are converted concurrently in headless mode */
+        bool isBatch() const
+        {
+            return batch;
+        }
+
+        /* ramses scene file written in headless mode, by default named after the input file */
+        std::string getSceneFile(const std::string& inputFile) const;
+        /* resource file next to the scene file */
+        std::string getResourceFile(const std::string& inputFile) const;
+        /* file for the compressed resources if only resources above a size are compressed */
+        std::string getCompressedResourceFile(const std::string& inputFile) const;
+
+        /* OBJ files to convert, directories given on the command line are expanded to their *.obj files */
+        std::vector<std::string> inputFiles;
+        std::string outputFile;
+        /* directory for the scene and resource files, by default they are written next to the input */
+        std::string outputDirectory;
+
+        /* number of files converted concurrently in batch mode, 0 uses all hardware threads */
+        unsigned jobCount = 0;
+        bool batch = false;
+
+        /* compress the saved resources with LZ4 */
+        bool compress = false;
+        /* only compress resources of at least this many bytes, into a file of their own; 0 compresses everything */
+        uint64_t compressMinSize = 0;
+
+        /* convert and save without creating a renderer or display */
+        bool headless = false;
+
+        /* re-import the input into the running viewer whenever the file changes */
+        bool watch = false;
+
+        /* frames per second of the viewer loop and the renderer, 0 runs the loop as fast as possible */
+        float frameRate = 60.0f;
+
+        /* format of the scene dump printed after the import */
+        ESceneTextFormat sceneFormat = ESceneTextFormat_Text;
+        /* file for the scene dump, empty prints it to stdout */
+        std::string sceneDumpFile;
+        /* memory report by mesh and resource after the scene dump */
+        bool printFootprint = false;
+        /* largest estimated GPU memory of a scene in bytes, larger scenes fail to convert; 0 is unlimited */
+        uint64_t memoryBudget = 0;
+
+        /* JSON report of stage timings and counters, empty disables profiling */
+        std::string profileFile;
+
+        ImportOptions importOptions;
+    };
+}
+
+#endif
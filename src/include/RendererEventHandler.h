@@ -15,6 +15,7 @@
 
 #include "ramses-client-api/Camera.h"
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <unordered_set>
@@ -23,6 +24,18 @@
 
 namespace obj2ramses
 {
+    /* when the renderer events on the way to the first frame were dispatched, empty until then */
+    struct StartupTimes
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        Clock::time_point displayCreated;
+        Clock::time_point published;
+        Clock::time_point subscribed;
+        Clock::time_point mapped;
+        Clock::time_point shown;
+    };
+
     class SceneStateEventHandler : public ramses::RendererEventHandlerEmpty
     {
     public:
@@ -34,6 +47,7 @@ namespace obj2ramses
         virtual void scenePublished(ramses::sceneId_t sceneId) override
         {
             m_publishedScenes.insert(sceneId);
+            setOnce(m_startupTimes.published);
         }
 
         virtual void sceneUnpublished(ramses::sceneId_t sceneId) override
@@ -46,6 +60,7 @@ namespace obj2ramses
             if (ramses::ERendererEventResult_OK == result)
             {
                 m_subscribedScenes.insert(sceneId);
+                setOnce(m_startupTimes.subscribed);
             }
         }
 
@@ -62,6 +77,7 @@ namespace obj2ramses
             if (ramses::ERendererEventResult_OK == result)
             {
                 m_mappedScenes.insert(sceneId);
+                setOnce(m_startupTimes.mapped);
             }
         }
 
@@ -73,11 +89,29 @@ namespace obj2ramses
             }
         }
 
+        virtual void sceneShown(ramses::sceneId_t sceneId, ramses::ERendererEventResult result) override
+        {
+            if (ramses::ERendererEventResult_OK == result)
+            {
+                m_shownScenes.insert(sceneId);
+                setOnce(m_startupTimes.shown);
+            }
+        }
+
+        virtual void sceneHidden(ramses::sceneId_t sceneId, ramses::ERendererEventResult result) override
+        {
+            if (ramses::ERendererEventResult_FAIL != result)
+            {
+                m_shownScenes.erase(sceneId);
+            }
+        }
+
         virtual void displayCreated(ramses::displayId_t displayId, ramses::ERendererEventResult result) override
         {
             if (result == ramses::ERendererEventResult_OK)
             {
                 m_lastDisplayCreated = displayId;
+                setOnce(m_startupTimes.displayCreated);
             }
         }
 
@@ -89,19 +123,20 @@ namespace obj2ramses
         virtual void keyEvent(ramses::displayId_t displayId, ramses::EKeyEvent eventType, uint32_t keyModifiers, ramses::EKeyCode keyCode) override
         {
 
+            ++m_inputEventCount;
             switch(keyCode)
             {
                 case ramses::EKeyCode_W:
-                m_camera.translate(1.0f, 0.0f, 0.0f);  break;
+                m_translation[0] += 1.0f;  break;
 
                 case ramses::EKeyCode_S:
-                m_camera.translate(-1.0f, 0.0f, 0.0f); break;
+                m_translation[0] -= 1.0f; break;
 
                 case ramses::EKeyCode_A:
-                m_camera.translate(0.0f, -1.0f, 0.0f); break;
+                m_translation[1] -= 1.0f; break;
 
                 case ramses::EKeyCode_D:
-                m_camera.translate(0.0f, 1.0f, 0.0f);  break;
+                m_translation[1] += 1.0f;  break;
             }
         }
 
@@ -114,7 +149,9 @@ namespace obj2ramses
             float pitch = sensitivity * deltaX;
             float yaw = sensitivity * deltaY;
 
-            m_camera.rotate(pitch, yaw, 0.0f);
+            ++m_inputEventCount;
+            m_rotation[0] += pitch;
+            m_rotation[1] += yaw;
 
             m_MouseLastX = mousePosX;
             m_MouseLastY = mousePosY;
@@ -122,11 +159,7 @@ namespace obj2ramses
 
         void waitForDisplayCreation(const ramses::displayId_t display)
         {
-            while (m_lastDisplayCreated != display)
-            {
-                std::this_thread::sleep_for(std::chrono::milliseconds(50));
-                m_renderer.dispatchEvents(*this);
-            }
+            waitUntil([this, display]() { return m_lastDisplayCreated == display; });
         }
 
         void waitForPublication(const ramses::sceneId_t sceneId)
@@ -144,6 +177,49 @@ namespace obj2ramses
             waitForSceneInSet(sceneId, m_mappedScenes);
         }
 
+        void waitForShown(const ramses::sceneId_t sceneId)
+        {
+            waitForSceneInSet(sceneId, m_shownScenes);
+        }
+
+        /**
+         * @brief Moves the camera by the sum of all key and mouse input since the last call.
+         *
+         * Events only accumulate, so a frame with many events changes the camera transform once.
+         *
+         * @return the number of transform properties (translation, rotation) which changed, 0 if
+         *         the camera was left alone
+         */
+        size_t applyCameraInput()
+        {
+            size_t changes = 0;
+            if (0.0f != m_translation[0] || 0.0f != m_translation[1] || 0.0f != m_translation[2])
+            {
+                m_camera.translate(m_translation[0], m_translation[1], m_translation[2]);
+                ++changes;
+            }
+            if (0.0f != m_rotation[0] || 0.0f != m_rotation[1] || 0.0f != m_rotation[2])
+            {
+                m_camera.rotate(m_rotation[0], m_rotation[1], m_rotation[2]);
+                ++changes;
+            }
+
+            std::fill(m_translation, m_translation + 3, 0.0f);
+            std::fill(m_rotation, m_rotation + 3, 0.0f);
+            return changes;
+        }
+
+        /* key and mouse events received so far */
+        uint64_t getInputEventCount() const
+        {
+            return m_inputEventCount;
+        }
+
+        const StartupTimes& getStartupTimes() const
+        {
+            return m_startupTimes;
+        }
+
         bool windowWasClosed() const
         {
             return m_windowWasClosed;
@@ -154,16 +230,42 @@ namespace obj2ramses
 
         void waitForSceneInSet(const ramses::sceneId_t sceneId, const SceneSet& sceneSet)
         {
-            while (sceneSet.find(sceneId) == sceneSet.end())
+            waitUntil([sceneId, &sceneSet]() { return sceneSet.find(sceneId) != sceneSet.end(); });
+        }
+
+        /**
+         * @brief Dispatches renderer events until condition holds or the window is closed.
+         *
+         * The renderer has no blocking wait for its events, so the pause between two dispatches
+         * starts short and doubles up to a millisecond: an event is handled within about a
+         * millisecond of its arrival, while longer waits do not spin.
+         */
+        template <typename Condition>
+        void waitUntil(Condition condition)
+        {
+            const std::chrono::microseconds MaxPause(1000);
+            std::chrono::microseconds pause(20);
+
+            m_renderer.dispatchEvents(*this);
+            while (!condition() && !m_windowWasClosed)
             {
-                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                std::this_thread::sleep_for(pause);
+                pause = std::min(pause * 2, MaxPause);
                 m_renderer.dispatchEvents(*this);
             }
         }
 
+        static void setOnce(StartupTimes::Clock::time_point& time)
+        {
+            if (StartupTimes::Clock::time_point() == time)
+                time = StartupTimes::Clock::now();
+        }
+
         SceneSet m_publishedScenes;
         SceneSet m_subscribedScenes;
         SceneSet m_mappedScenes;
+        SceneSet m_shownScenes;
+        StartupTimes m_startupTimes;
 
         ramses::RamsesRenderer& m_renderer;
         ramses::Camera& m_camera;
@@ -172,6 +274,11 @@ namespace obj2ramses
 
         int32_t m_MouseLastX = 0;
         int32_t m_MouseLastY = 0;
+
+        /* camera movement of the events since the last applyCameraInput() */
+        float m_translation[3] = { 0.0f, 0.0f, 0.0f };
+        float m_rotation[3] = { 0.0f, 0.0f, 0.0f };
+        uint64_t m_inputEventCount = 0;
     };
 }
 
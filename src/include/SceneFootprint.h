@@ -0,0 +1,80 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_SCENEFOOTPRINT
+#define OBJ2RAMSES_SCENEFOOTPRINT
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace ramses
+{
+    class Resource;
+}
+
+namespace obj2ramses
+{
+    /* an array or texture resource used by one or more mesh nodes */
+    struct ResourceFootprint
+    {
+        const ramses::Resource* resource = nullptr;
+        std::string name;
+        /* indices16, indices32, positions, normals, texCoords or texture */
+        const char* type = "";
+        /* size of the resource data */
+        uint64_t bytes = 0;
+        /* estimated GPU memory: buffers aligned to GpuBufferAlignment, textures with their mip chain */
+        uint64_t gpuBytes = 0;
+        /* mesh nodes using the resource */
+        size_t users = 0;
+    };
+
+    struct MeshFootprint
+    {
+        std::string name;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        /* 16 or 32 */
+        uint32_t indexWidth = 0;
+        /* resources of the mesh, indices into SceneFootprint::resources */
+        std::vector<size_t> resources;
+        /* bytes of the resources only this mesh uses */
+        uint64_t uniqueBytes = 0;
+        /* bytes of the resources it shares with other meshes, divided by their number of users */
+        uint64_t sharedBytes = 0;
+        /* GPU estimate of the resources, shared ones divided by their users */
+        uint64_t gpuBytes = 0;
+    };
+
+    /**
+     * @brief Memory used by the mesh nodes of a scene and the resources behind them.
+     *
+     * Filled by ObjImporter::getFootprint(), which created every resource and knows which mesh
+     * nodes share them. Meshes and resources are sorted by GPU cost, most expensive first.
+     */
+    struct SceneFootprint
+    {
+        /* GPU buffers are assumed to be allocated in blocks of this size */
+        static const uint64_t GpuBufferAlignment = 256u;
+
+        std::vector<MeshFootprint> meshes;
+        std::vector<ResourceFootprint> resources;
+        size_t effectCount = 0;
+
+        /* resources used by a single mesh and by several meshes */
+        uint64_t uniqueBytes = 0;
+        uint64_t sharedBytes = 0;
+        /* what all meshes would use without sharing resources */
+        uint64_t unsharedBytes = 0;
+        uint64_t gpuBytes = 0;
+    };
+}
+
+#endif
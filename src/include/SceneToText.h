@@ -9,35 +9,79 @@
 #ifndef OBJ2RAMSES_SCENETOTEXT
 #define OBJ2RAMSES_SCENETOTEXT
 
-#include <sstream>
-#include <set>
+#include <ostream>
+#include <vector>
+#include <cstdint>
 
 namespace ramses
 {
     class Scene;
     class RamsesClient;
     class Node;
+    class RenderPass;
 }
 
 namespace obj2ramses
 {
-    using NodeSet = std::set<ramses::Node const*>;
+    class JsonWriter;
+    struct SceneFootprint;
+    struct MeshFootprint;
+    struct ResourceFootprint;
 
+    enum ESceneTextFormat
+    {
+        /* indented node tree and render passes for reading */
+        ESceneTextFormat_Text = 0,
+        /* one JSON document with the scene, all nodes and all render passes */
+        ESceneTextFormat_Json,
+        /* one JSON object per line for the scene, every node and every render pass */
+        ESceneTextFormat_NDJson
+    };
+
+    using NodeList = std::vector<ramses::Node const*>;
+
+    /**
+     * @brief Writes the node hierarchy and render passes of a scene to a stream.
+     *
+     * Root nodes and render passes are ordered by scene object id and children by their index,
+     * so the same scene always gives the same output and two dumps can be diffed. The hierarchy
+     * is walked without recursion and written as it is walked, nothing is buffered.
+     */
     class SceneToText
     {
     public:
-        SceneToText(bool printTransformations);
+        SceneToText(bool printTransformations, ESceneTextFormat format = ESceneTextFormat_Text);
 
-        void printToStream(const ramses::Scene& scene, const ramses::RamsesClient& client, std::ostringstream& stream) const;
+        void printToStream(const ramses::Scene& scene, const ramses::RamsesClient& client, std::ostream& stream) const;
+
+        /* memory report with the meshes and resources in the order of the footprint, i.e. by cost */
+        void printFootprint(const SceneFootprint& footprint, std::ostream& stream) const;
 
     private:
+        NodeList collectRootNodes(const ramses::Scene& scene) const;
+        std::vector<ramses::RenderPass const*> collectRenderPasses(const ramses::Scene& scene) const;
+
+        /* calls visit(node, depth) for all nodes below the roots in depth first order */
+        template <typename Visit>
+        void forEachNode(const NodeList& rootNodes, Visit visit) const;
+
+        void printText(std::ostream& stream, const ramses::Scene& scene) const;
+        void printNode(std::ostream& stream, const ramses::Node& node, uint32_t depth) const;
+        void printTransformations(std::ostream& stream, const ramses::Node& node, uint32_t indentation) const;
+        void printRenderPass(std::ostream& stream, const ramses::RenderPass& renderPass) const;
 
-        NodeSet collectRootNodes(const ramses::Scene& scene) const;
-        void printSubtree(std::ostringstream& stream, const ramses::Node& rootNode, uint32_t indentation) const;
-        void printTransformations(std::ostringstream& stream, const ramses::Node& rootNode, uint32_t indentation) const;
-        void printRenderPasses(std::ostringstream& stream, const ramses::Scene& scene) const;
+        void printJson(std::ostream& stream, const ramses::Scene& scene) const;
+        void printNDJson(std::ostream& stream, const ramses::Scene& scene) const;
+        /* members of the JSON objects of the records */
+        void writeScene(JsonWriter& json, const ramses::Scene& scene) const;
+        void writeNode(JsonWriter& json, const ramses::Node& node) const;
+        void writeRenderPass(JsonWriter& json, const ramses::RenderPass& renderPass) const;
+        void writeFootprintTotals(JsonWriter& json, const SceneFootprint& footprint) const;
+        void writeMeshFootprint(JsonWriter& json, const MeshFootprint& mesh) const;
+        void writeResourceFootprint(JsonWriter& json, const ResourceFootprint& resource, size_t index) const;
 
         bool m_printTransformations;
+        ESceneTextFormat m_format;
     };
 }
 
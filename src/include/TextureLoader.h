@@ -0,0 +1,94 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_TEXTURELOADER
+#define OBJ2RAMSES_TEXTURELOADER
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace obj2ramses
+{
+    class ThreadPool;
+
+    struct DecodedTexture
+    {
+        std::string path;
+        /* false if the file cannot be read or decoded (see error), or if it is a duplicate */
+        bool valid = false;
+        std::string error;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        /* RGBA8, rows from top to bottom */
+        std::vector<unsigned char> pixels;
+        /* own index, or the index of the first requested texture with the same file content, which holds the pixels */
+        size_t duplicateOf;
+    };
+
+    /**
+     * @brief Decodes PNG textures on a thread pool in the background.
+     *
+     * Textures are requested while the geometry is still being parsed and collected once the
+     * scene is created. A path is only decoded once, and files with the same content under
+     * different paths are detected by their hash before decoding, so they share one decode and
+     * one texture resource.
+     */
+    class TextureLoader
+    {
+    public:
+        /* threadCount 0 uses all hardware threads */
+        explicit TextureLoader(unsigned threadCount);
+        ~TextureLoader();
+
+        TextureLoader(const TextureLoader&) = delete;
+        TextureLoader& operator=(const TextureLoader&) = delete;
+
+        /* starts decoding path unless it was requested before, returns the index of its texture */
+        size_t request(const std::string& path);
+
+        /* index of the texture requested for path, getTextureCount() if there is none */
+        size_t find(const std::string& path) const;
+
+        /* blocks until all requested textures are decoded, duplicates then refer to the first request of their content */
+        void wait();
+
+        size_t getTextureCount() const
+        {
+            return m_textures.size();
+        }
+
+        /* only valid after wait() */
+        const DecodedTexture& getTexture(size_t index) const
+        {
+            return *m_textures[index];
+        }
+
+    private:
+        void decode(DecodedTexture& texture, size_t index);
+        void resolveDuplicates();
+
+        const unsigned m_threadCount;
+        /* created with the first request, most files have no textures */
+        std::unique_ptr<ThreadPool> m_pool;
+
+        /* stable addresses, the workers fill the entries while more are requested */
+        std::vector<std::unique_ptr<DecodedTexture>> m_textures;
+        std::map<std::string, size_t> m_textureByPath;
+
+        std::mutex m_mutex;
+        /* first texture of each file content */
+        std::map<uint64_t, size_t> m_textureByContent;
+    };
+}
+
+#endif
@@ -0,0 +1,78 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_THREADPOOL
+#define OBJ2RAMSES_THREADPOOL
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+namespace obj2ramses
+{
+    /**
+     * @brief Work-stealing thread pool.
+     *
+     * Every worker owns a task queue. Tasks submitted from outside are distributed round-robin,
+     * tasks submitted from a worker go to its own queue. Workers take their newest task first and,
+     * once their queue is empty, steal the oldest task of another worker, so one long task never
+     * blocks the tasks queued behind it.
+     */
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        /* threadCount 0 uses all hardware threads */
+        explicit ThreadPool(unsigned threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(Task task);
+
+        /* blocks until all submitted tasks have finished */
+        void wait();
+
+        unsigned getThreadCount() const
+        {
+            // the queues are complete before the first worker starts, m_workers is still growing then
+            return static_cast<unsigned>(m_queues.size());
+        }
+
+    private:
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void run(unsigned workerIndex);
+        bool popOwn(unsigned workerIndex, Task& task);
+        bool steal(unsigned workerIndex, Task& task);
+
+        std::vector<std::unique_ptr<WorkQueue>> m_queues;
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_allDone;
+        size_t m_pendingTasks = 0;
+        bool m_stopping = false;
+
+        std::atomic<unsigned> m_nextQueue;
+    };
+}
+
+#endif
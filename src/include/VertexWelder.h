@@ -0,0 +1,70 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_VERTEXWELDER
+#define OBJ2RAMSES_VERTEXWELDER
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+#include "ObjGeometry.h"
+
+namespace obj2ramses
+{
+    struct WeldStatistics
+    {
+        /* face corners processed, i.e. the vertex count without welding */
+        size_t cornerCount = 0;
+        /* unique (v, vt, vn) combinations emitted */
+        size_t vertexCount = 0;
+
+        double getDedupRatio() const
+        {
+            return 0 == vertexCount ? 1.0 : static_cast<double>(cornerCount) / static_cast<double>(vertexCount);
+        }
+    };
+
+    /**
+     * @brief Turns OBJ faces into an indexed triangle list with one vertex per distinct (v, vt, vn) triple.
+     *
+     * Triples are looked up in an open-addressing hash table with linear probing. The table only
+     * holds output vertex numbers, the keys live in a dense side array, so lookups touch two cache
+     * lines at most and the memory use grows with the number of unique vertices, not corners.
+     * The welder can be reused; its table memory is kept between calls.
+     */
+    class VertexWelder
+    {
+    public:
+        /* faces [first, second) of a mesh */
+        using FaceRange = std::pair<size_t, size_t>;
+
+        /**
+         * @brief Welds the faces of all ranges of mesh together and appends the result to out.
+         *
+         * Corners of different ranges with the same triple share one vertex. Faces with more than
+         * three corners are fan-triangulated.
+         */
+        WeldStatistics weld(const ObjGeometry::mesh_data& mesh, const std::vector<FaceRange>& faceRanges, ObjGeometry::indexed_mesh& out);
+
+    private:
+        void resetTable(size_t expectedVertices);
+        void growTable();
+        unsigned findOrInsert(unsigned v, unsigned vt, unsigned vn, bool& inserted);
+
+        /* output vertex + 1 per slot, 0 marks a free slot */
+        std::vector<unsigned> m_slots;
+        /* (v, vt, vn) of every output vertex */
+        std::vector<unsigned> m_keys;
+        size_t m_mask = 0;
+
+        std::vector<unsigned> m_faceCorners;
+    };
+}
+
+#endif
@@ -7,12 +7,23 @@
 //  -------------------------------------------------------------------------
 
 #include "ObjImporter.h"
+#include "ProgramOptions.h"
+#include "ThreadPool.h"
+#include "FileUtils.h"
+#include "Profiler.h"
+#include "LodSwitcher.h"
+#include "FrustumCuller.h"
+#include "FileWatcher.h"
+#include "FramePacer.h"
 
 #include "ramses-client-api/Scene.h"
 #include "ramses-framework-api/RamsesFramework.h"
 #include "ramses-client-api/RamsesClient.h"
 #include "ramses-client-api/ResourceFileDescriptionSet.h"
 #include "ramses-client-api/ResourceFileDescription.h"
+#include "ramses-client-api/ResourceIterator.h"
+#include "ramses-client-api/Resource.h"
+#include "ramses-utils.h"
 #include "ramses-client-api/Camera.h"
 #include "ramses-client-api/LocalCamera.h"
 #include "ramses-client-api/PerspectiveCamera.h"
@@ -22,96 +33,785 @@
 #include "RendererEventHandler.h"
 #include "SceneToText.h"
 #include <iostream>
+#include <iomanip>
+#include <set>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <mutex>
+#include <chrono>
+#include <future>
+#include <memory>
+
+namespace
+{
+    const uint32_t ScreenWidth = 1280U;
+    const uint32_t ScreenHeight = 480U;
+
+    // TODO make scene id and name configurable over cmd line
+    const ramses::sceneId_t SceneId = 123u;
+    const char* const SceneName = "The Scene";
+
+    /**
+     * @brief Sets up camera and render pass for the imported meshes and validates the scene.
+     *
+     * @return the camera, or nullptr if the validation failed
+     */
+    ramses::PerspectiveCamera* setupScene(ramses::Scene& scene, obj2ramses::ObjImporter& objImporter, std::ostream& log = std::cout)
+    {
+        // every scene needs a render pass with camera
+        const char* CAMERA_NAME = "Default Camera";
+
+        ramses::PerspectiveCamera* camera = scene.createPerspectiveCamera(CAMERA_NAME);
+        camera->setFrustum(19.f, static_cast<float>(ScreenWidth)/ScreenHeight, 0.1f, 1500.f);
+        camera->setViewport(0U, 0U, ScreenWidth, ScreenHeight);
+        ramses::RenderPass* renderPass = scene.createRenderPass("my render pass");
+        renderPass->setClearFlags(ramses::EClearFlags_None);
+        renderPass->setCamera(*camera);
+        camera->setTranslation(0, 0, 5);
+
+        ramses::RenderGroup* renderGroup = objImporter.getRamsesRenderGroup();
+        renderPass->addRenderGroup(*renderGroup);
+
+        ramses::status_t status = ramses::StatusOK;
+        {
+            obj2ramses::ScopedTimer timer("scene.validate");
+            status = scene.validate();
+        }
+
+        if (ramses::StatusOK != status)
+        {
+            log << "Validation test for imported scene failed: " << scene.getValidationReport(ramses::EValidationSeverity_Info);
+            return nullptr;
+        }
+
+        return camera;
+    }
+
+    /**
+     * @brief Streams the scene dump in the configured format to stdout or the dump file.
+     */
+    bool printScene(const ramses::RamsesClient& client, const ramses::Scene& scene, const obj2ramses::ObjImporter& objImporter, const obj2ramses::ProgramOptions& options)
+    {
+        obj2ramses::ScopedTimer timer("scene.toText");
+        const obj2ramses::SceneToText sceneToText(true, options.sceneFormat);
+        if (options.sceneDumpFile.empty())
+        {
+            sceneToText.printToStream(scene, client, std::cout);
+            if (options.printFootprint)
+                sceneToText.printFootprint(objImporter.getFootprint(), std::cout);
+            std::cout.flush();
+            return true;
+        }
+
+        std::ofstream file(options.sceneDumpFile.c_str(), std::ios::binary);
+        sceneToText.printToStream(scene, client, file);
+        if (options.printFootprint)
+            sceneToText.printFootprint(objImporter.getFootprint(), file);
+        file.close();
+        if (!file)
+        {
+            std::cerr << "Writing the scene dump to " << options.sceneDumpFile << " failed" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Compares the estimated GPU memory of the imported scene with the budget of the options.
+     *
+     * @return false if the scene does not fit, always true without a budget
+     */
+    bool checkMemoryBudget(const obj2ramses::ObjImporter& objImporter, const obj2ramses::ProgramOptions& options, const std::string& inputFile)
+    {
+        if (0 == options.memoryBudget)
+            return true;
+
+        const uint64_t gpuBytes = objImporter.getFootprint().gpuBytes;
+        obj2ramses::Profiler::Get().addCounter("scene.estimatedGpuBytes", gpuBytes);
+        if (gpuBytes <= options.memoryBudget)
+            return true;
+
+        std::cerr << inputFile << ": estimated GPU memory of " << gpuBytes << " bytes exceeds the budget of " << options.memoryBudget << " bytes" << std::endl;
+        return false;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+
+    double getMilliseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    /* files written for a scene and how long writing and loading them took */
+    struct SaveStatistics
+    {
+        std::string sceneFile;
+        std::vector<std::string> resourceFiles;
+        uint64_t outputSize = 0;
+        size_t resourceCount = 0;
+        size_t compressedResourceCount = 0;
+        /* including compression */
+        double saveMs = 0.0;
+        /* saving the same files without compression, only measured if anything is compressed, negative otherwise */
+        double uncompressedSaveMs = -1.0;
+        /* loading the scene and its resource files again, negative if it failed */
+        double reloadMs = -1.0;
+    };
+
+    /* writes the scene with the resources of the importer, the large ones into a resource file of their own */
+    ramses::status_t writeSceneFiles(ramses::RamsesClient& client, const ramses::Scene& scene, const obj2ramses::ObjImporter& objImporter,
+        const std::set<const ramses::Resource*>& largeResources, const std::string& sceneFile, const std::string& resourceFile,
+        const std::string& largeResourceFile, bool compressAll, bool compressLarge)
+    {
+        ramses::ResourceFileDescription resourceFileDescription(resourceFile.c_str());
+        ramses::ResourceFileDescription largeFileDescription(largeResourceFile.c_str());
+        for (auto resource : objImporter.getResources())
+        {
+            if (0 != largeResources.count(resource))
+                largeFileDescription.add(resource);
+            else
+                resourceFileDescription.add(resource);
+        }
+
+        ramses::ResourceFileDescriptionSet resourceFiles;
+        resourceFiles.add(resourceFileDescription);
+        ramses::status_t status = client.saveSceneToFile(scene, sceneFile.c_str(), resourceFiles, compressAll);
+        if (ramses::StatusOK == status && !largeResources.empty())
+            status = client.saveResources(largeFileDescription, compressLarge);
+        return status;
+    }
+
+    /**
+     * @brief Saves the scene and the resources created by the importer to files.
+     *
+     * With --compress all files are compressed. With a minimum size only the resources of at least
+     * that size are compressed, into a resource file of their own, the others are saved as they
+     * are with the scene. If anything is compressed, the same files are also saved without
+     * compression to temporary files, so the time spent compressing can be told apart.
+     */
+    bool saveScene(ramses::RamsesClient& client, const ramses::Scene& scene, const obj2ramses::ObjImporter& objImporter, const obj2ramses::ProgramOptions& options,
+        const std::string& inputFile, SaveStatistics& statistics)
+    {
+        obj2ramses::ScopedTimer timer("scene.save");
+        statistics.sceneFile = options.getSceneFile(inputFile);
+        const std::string resourceFile = options.getResourceFile(inputFile);
+        const std::string compressedResourceFile = options.getCompressedResourceFile(inputFile);
+
+        std::set<const ramses::Resource*> largeResources;
+        if (options.compress && 0 != options.compressMinSize)
+        {
+            for (const auto& resource : objImporter.getFootprint().resources)
+            {
+                if (nullptr != resource.resource && resource.bytes >= options.compressMinSize)
+                    largeResources.insert(resource.resource);
+            }
+        }
+        const bool compressAll = options.compress && 0 == options.compressMinSize;
+
+        const Clock::time_point started = Clock::now();
+        const ramses::status_t status = writeSceneFiles(client, scene, objImporter, largeResources, statistics.sceneFile, resourceFile,
+            compressedResourceFile, compressAll, true);
+        if (ramses::StatusOK != status)
+        {
+            std::cerr << "Saving " << statistics.sceneFile << " failed: " << client.getStatusMessage(status) << std::endl;
+            return false;
+        }
+        statistics.saveMs = getMilliseconds(Clock::now() - started);
+
+        if (compressAll || !largeResources.empty())
+        {
+            const std::string files[] = {
+                obj2ramses::FileUtils::getTemporaryFile(statistics.sceneFile),
+                obj2ramses::FileUtils::getTemporaryFile(resourceFile),
+                obj2ramses::FileUtils::getTemporaryFile(compressedResourceFile) };
+            const Clock::time_point uncompressedStarted = Clock::now();
+            if (ramses::StatusOK == writeSceneFiles(client, scene, objImporter, largeResources, files[0], files[1], files[2], false, false))
+                statistics.uncompressedSaveMs = getMilliseconds(Clock::now() - uncompressedStarted);
+            for (const auto& file : files)
+                obj2ramses::FileUtils::removeFile(file);
+        }
+
+        statistics.resourceFiles.assign(1, resourceFile);
+        if (!largeResources.empty())
+            statistics.resourceFiles.push_back(compressedResourceFile);
+        else
+            // left by an earlier run with other options, it does not belong to this scene anymore
+            obj2ramses::FileUtils::removeFile(compressedResourceFile);
+        statistics.outputSize = obj2ramses::FileUtils::getFileSize(statistics.sceneFile);
+        for (const auto& file : statistics.resourceFiles)
+            statistics.outputSize += obj2ramses::FileUtils::getFileSize(file);
+        statistics.resourceCount = objImporter.getResources().size();
+        statistics.compressedResourceCount = compressAll ? statistics.resourceCount : largeResources.size();
+        return true;
+    }
+
+    /* all resources of the client, to tell which ones loading a file created */
+    std::set<const ramses::RamsesObject*> getClientResources(const ramses::RamsesClient& client)
+    {
+        std::set<const ramses::RamsesObject*> resources;
+        ramses::ResourceIterator iterator(client, ramses::ERamsesObjectType_Resource);
+        for (const ramses::RamsesObject* resource = iterator.getNext(); nullptr != resource; resource = iterator.getNext())
+            resources.insert(resource);
+        return resources;
+    }
+
+    /**
+     * @brief Loads the saved scene and its resources again to measure the load time, and destroys them.
+     *
+     * The scene must have been destroyed before, the loaded scene has the same id. The loaded
+     * resources are destroyed as well, so a batch does not keep the resources of every file in
+     * the client and later files do not find effects of earlier ones. No other client calls may
+     * run concurrently, they would count as loaded.
+     */
+    bool measureReload(ramses::RamsesClient& client, SaveStatistics& statistics)
+    {
+        obj2ramses::ScopedTimer timer("output.reload");
+        const std::set<const ramses::RamsesObject*> resourcesBefore = getClientResources(client);
+
+        const Clock::time_point started = Clock::now();
+        ramses::ResourceFileDescriptionSet resourceFiles;
+        for (const auto& file : statistics.resourceFiles)
+            resourceFiles.add(ramses::ResourceFileDescription(file.c_str()));
+
+        ramses::Scene* scene = client.loadSceneFromFile(statistics.sceneFile.c_str(), resourceFiles);
+        if (nullptr != scene)
+        {
+            statistics.reloadMs = getMilliseconds(Clock::now() - started);
+            client.destroy(*scene);
+        }
+
+        // also after a failure, the resource files may have been loaded anyway
+        for (const ramses::RamsesObject* object : getClientResources(client))
+        {
+            if (0 != resourcesBefore.count(object))
+                continue;
+            const ramses::Resource* resource = ramses::RamsesUtils::TryConvert<ramses::Resource>(*object);
+            if (nullptr != resource)
+                client.destroy(*resource);
+        }
+
+        if (nullptr == scene)
+        {
+            std::cerr << "Loading " << statistics.sceneFile << " again failed" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void reportOutput(const SaveStatistics& statistics)
+    {
+        std::cout << std::fixed << std::setprecision(1) << "Saved " << statistics.sceneFile;
+        for (const auto& file : statistics.resourceFiles)
+            std::cout << ", " << file;
+        std::cout << ": " << statistics.outputSize << " bytes, " << statistics.compressedResourceCount << " of " << statistics.resourceCount
+                  << " resource(s) compressed, saved in " << statistics.saveMs << " ms";
+        if (statistics.uncompressedSaveMs >= 0.0)
+            std::cout << " (" << statistics.uncompressedSaveMs << " ms without compression)";
+        if (statistics.reloadMs >= 0.0)
+            std::cout << ", reloaded in " << statistics.reloadMs << " ms";
+        std::cout << std::endl;
+
+        obj2ramses::Profiler::Get().addCounter("output.bytes", statistics.outputSize);
+        obj2ramses::Profiler::Get().addCounter("output.compressedResources", statistics.compressedResourceCount);
+    }
+
+    struct ConversionJob
+    {
+        std::string inputFile;
+        ramses::sceneId_t sceneId;
+        Clock::time_point submitted;
+
+        bool succeeded = false;
+        double queueWaitMs = 0.0;
+        /* summed over all sections which need the client */
+        double clientWaitMs = 0.0;
+        double wallTimeMs = 0.0;
+        SaveStatistics output;
+    };
+
+    /**
+     * @brief Locks the mutex of the shared client and adds the time spent waiting for it to waitMs.
+     */
+    class ClientLock
+    {
+    public:
+        ClientLock(std::mutex& mutex, double& waitMs)
+            : m_lock(mutex, std::defer_lock)
+        {
+            const Clock::time_point started = Clock::now();
+            m_lock.lock();
+            waitMs += getMilliseconds(Clock::now() - started);
+        }
+
+    private:
+        std::unique_lock<std::mutex> m_lock;
+    };
+
+    /**
+     * @brief Converts one file of a batch into its own scene, which is destroyed after saving.
+     *
+     * Parsing and mesh processing run concurrently with other jobs. The client calls are serialized
+     * with clientMutex, in one short section per step, so other jobs get the client in between.
+     * Saving and loading read and fill the resource registry of the client and need the lock as
+     * well, the time spent waiting for it is reported per job. The progress messages of the job are
+     * collected and printed at once under outputMutex, so they do not interleave with other jobs.
+     * All jobs use one effect cache, which is guarded by clientMutex like the client.
+     */
+    void convertFile(ramses::RamsesClient& client, std::mutex& clientMutex, std::mutex& outputMutex, obj2ramses::EffectCache& effectCache,
+        const obj2ramses::ProgramOptions& options, ConversionJob& job)
+    {
+        const Clock::time_point started = Clock::now();
+        job.queueWaitMs = getMilliseconds(started - job.submitted);
+
+        ramses::Scene* scene = nullptr;
+        {
+            ClientLock lock(clientMutex, job.clientWaitMs);
+            scene = client.createScene(job.sceneId, ramses::SceneConfig(), job.inputFile.c_str());
+        }
+
+        // each pool thread keeps the memory of its previous import for the next one
+        static thread_local obj2ramses::MemoryArena arena;
+        std::ostringstream log;
+        obj2ramses::ObjImporter objImporter(client, *scene, options.importOptions, &arena, log, &effectCache);
+        const bool imported = objImporter.importFromFile(job.inputFile);
+        if (!imported)
+            std::cerr << "Importing " << job.inputFile << " failed" << std::endl;
+
+        bool sceneSetUp = false;
+        if (imported)
+        {
+            // creates the client resources of the meshes
+            ClientLock lock(clientMutex, job.clientWaitMs);
+            sceneSetUp = nullptr != setupScene(*scene, objImporter, log);
+        }
+
+        job.succeeded = sceneSetUp && checkMemoryBudget(objImporter, options, job.inputFile);
+        if (job.succeeded)
+        {
+            ClientLock lock(clientMutex, job.clientWaitMs);
+            job.succeeded = saveScene(client, *scene, objImporter, options, job.inputFile, job.output);
+        }
+
+        {
+            ClientLock lock(clientMutex, job.clientWaitMs);
+            client.destroy(*scene);
+            objImporter.destroyResources();
+        }
+
+        // after destroying the resources, so they are really read from the files
+        if (job.succeeded)
+        {
+            ClientLock lock(clientMutex, job.clientWaitMs);
+            job.succeeded = measureReload(client, job.output);
+        }
+
+        job.wallTimeMs = getMilliseconds(Clock::now() - started);
+
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << "[" << job.inputFile << "]\n" << log.str() << std::flush;
+    }
+
+    /**
+     * @brief Converts all input files on a work-stealing pool and reports per file timings.
+     */
+    bool convertFiles(ramses::RamsesClient& client, const obj2ramses::ProgramOptions& options)
+    {
+        const Clock::time_point started = Clock::now();
+
+        std::vector<ConversionJob> jobs(options.inputFiles.size());
+        std::mutex clientMutex;
+        std::mutex outputMutex;
+        obj2ramses::EffectCache effectCache(client, options.importOptions.cacheDirectory);
+        {
+            obj2ramses::ThreadPool pool(options.jobCount);
+            std::cout << "Converting " << jobs.size() << " files with " << pool.getThreadCount() << " jobs" << std::endl;
+
+            for (size_t i = 0; i < jobs.size(); ++i)
+            {
+                ConversionJob& job = jobs[i];
+                job.inputFile = options.inputFiles[i];
+                job.sceneId = SceneId + static_cast<ramses::sceneId_t>(i);
+                job.submitted = Clock::now();
+                pool.submit([&client, &clientMutex, &outputMutex, &effectCache, &options, &job]()
+                {
+                    convertFile(client, clientMutex, outputMutex, effectCache, options, job);
+                });
+            }
+            pool.wait();
+        }
+
+        size_t failedCount = 0;
+        uint64_t totalOutputSize = 0;
+
+        std::cout << std::endl << "wall [ms]  queue [ms]  client wait [ms]  save [ms]  uncompressed save [ms]  reload [ms]  output [bytes]  compressed  file" << std::endl;
+        for (const auto& job : jobs)
+        {
+            std::cout << std::fixed << std::setprecision(1)
+                << std::setw(9) << job.wallTimeMs << "  "
+                << std::setw(10) << job.queueWaitMs << "  "
+                << std::setw(16) << job.clientWaitMs << "  "
+                << std::setw(9) << job.output.saveMs << "  "
+                << std::setw(22) << std::max(job.output.uncompressedSaveMs, 0.0) << "  "
+                << std::setw(11) << std::max(job.output.reloadMs, 0.0) << "  "
+                << std::setw(14) << job.output.outputSize << "  "
+                << std::setw(10) << job.output.compressedResourceCount << "  "
+                << job.inputFile << (job.succeeded ? "" : " (failed)") << std::endl;
+
+            totalOutputSize += job.output.outputSize;
+            if (!job.succeeded)
+                ++failedCount;
+        }
+        std::cout << "Converted " << jobs.size() - failedCount << " of " << jobs.size() << " files to " << totalOutputSize
+            << " bytes in " << getMilliseconds(Clock::now() - started) << " ms" << std::endl;
+
+        return 0 == failedCount;
+    }
+
+    /**
+     * @brief Prints when the renderer events leading to the first frame were handled, relative to started.
+     *
+     * The times are also added to the profile as startup.* stages.
+     */
+    void reportStartupTimes(const obj2ramses::StartupTimes& times, Clock::time_point started)
+    {
+        const std::pair<const char*, Clock::time_point> milestones[] =
+        {
+            std::make_pair("startup.displayCreated", times.displayCreated),
+            std::make_pair("startup.published", times.published),
+            std::make_pair("startup.subscribed", times.subscribed),
+            std::make_pair("startup.mapped", times.mapped),
+            std::make_pair("startup.shown", times.shown),
+        };
+
+        std::cout << std::fixed << std::setprecision(1) << "Startup [ms]:";
+        for (const auto& milestone : milestones)
+        {
+            // events which did not arrive, e.g. because the window was closed, are left out
+            if (Clock::time_point() == milestone.second)
+                continue;
+
+            const double milliseconds = getMilliseconds(milestone.second - started);
+            std::cout << " " << (std::strchr(milestone.first, '.') + 1) << " " << milliseconds;
+            obj2ramses::Profiler::Get().addStage(milestone.first, milliseconds, 0u, 0u);
+        }
+        std::cout << std::endl;
+
+        if (Clock::time_point() != times.shown)
+            std::cout << "Time to first frame: " << getMilliseconds(times.shown - started) << " ms" << std::endl;
+    }
+
+    /**
+     * @brief Counts the flushes of the viewer loop and the scene changes they send.
+     *
+     * RAMSES does not report the size of a flush, so the changes made before it are counted
+     * instead: camera transform properties and node visibilities. Resources created by a reload
+     * are not included.
+     */
+    class FlushStatistics
+    {
+    public:
+        void addFrame()
+        {
+            ++m_frames;
+        }
+
+        void addFlush(size_t transformChanges, size_t visibilityChanges)
+        {
+            ++m_flushes;
+            m_transformChanges += transformChanges;
+            m_visibilityChanges += visibilityChanges;
+        }
+
+        void report(double milliseconds, uint64_t inputEvents) const
+        {
+            const double seconds = milliseconds / 1000.0;
+            const auto perSecond = [seconds](uint64_t count) { return seconds > 0.0 ? static_cast<double>(count) / seconds : 0.0; };
+            std::cout << std::fixed << std::setprecision(1) << "Flushed " << m_flushes << " of " << m_frames << " frames for " << inputEvents
+                      << " input event(s): " << perSecond(m_flushes) << " flushes/s with " << perSecond(m_transformChanges)
+                      << " transform and " << perSecond(m_visibilityChanges) << " visibility change(s)/s" << std::endl;
+
+            obj2ramses::Profiler::Get().addCounter("viewer.frames", m_frames);
+            obj2ramses::Profiler::Get().addCounter("viewer.flushes", m_flushes);
+            obj2ramses::Profiler::Get().addCounter("viewer.inputEvents", inputEvents);
+            obj2ramses::Profiler::Get().addCounter("viewer.transformChanges", m_transformChanges);
+            obj2ramses::Profiler::Get().addCounter("viewer.visibilityChanges", m_visibilityChanges);
+        }
+
+    private:
+        uint64_t m_frames = 0;
+        uint64_t m_flushes = 0;
+        uint64_t m_transformChanges = 0;
+        uint64_t m_visibilityChanges = 0;
+    };
+
+    /**
+     * @brief Writes the profile when main returns, on every exit path.
+     */
+    class ProfileReport
+    {
+    public:
+        explicit ProfileReport(const std::string& fileName)
+            : m_fileName(fileName)
+        {
+            if (!m_fileName.empty())
+                obj2ramses::Profiler::Get().enable();
+        }
+
+        ~ProfileReport()
+        {
+            if (!m_fileName.empty())
+                obj2ramses::Profiler::Get().writeReport(m_fileName);
+        }
+
+    private:
+        const std::string m_fileName;
+    };
+}
 
 int main(int argc, char* argv[])
 {
+    obj2ramses::ProgramOptions options;
+    if (!options.parse(argc, argv))
+        return 1;
+
+    ProfileReport profileReport(options.profileFile);
+    obj2ramses::ScopedTimer totalTimer("total");
+
+    obj2ramses::ScopedTimer setupTimer("setup");
     ramses::RamsesFrameworkConfig config(argc, argv);
     config.setRequestedRamsesShellType(ramses::ERamsesShellType_Console);  //needed for automated test of examples
     ramses::RamsesFramework framework(config);
     ramses::RamsesClient client("obj2ramses", framework);
+    setupTimer.stop();
 
     // Suppress ramses logs
     ramses_internal::GetRamsesLogger().setLogLevelForAppenderType(ramses_internal::ELogAppenderType::Console, ramses_internal::ELogLevel::Error);
 
+    if (options.isBatch())
+        return convertFiles(client, options) ? 0 : 1;
+
+    const std::string& inputFile = options.inputFiles.front();
+
+    if (options.headless)
+    {
+        // batch conversion: no renderer, no display, no connection, just import, validate and save
+        ramses::Scene* scene = client.createScene(SceneId, ramses::SceneConfig(), SceneName);
+        obj2ramses::ObjImporter objImporter(client, *scene, options.importOptions);
+
+        if (!objImporter.importFromFile(inputFile))
+        {
+            std::cerr << "Importing " << inputFile << " failed" << std::endl;
+            return 1;
+        }
+
+        if (nullptr == setupScene(*scene, objImporter) || !printScene(client, *scene, objImporter, options) || !checkMemoryBudget(objImporter, options, inputFile))
+            return 1;
+
+        SaveStatistics output;
+        if (!saveScene(client, *scene, objImporter, options, inputFile, output))
+            return 1;
+
+        client.destroy(*scene);
+        objImporter.destroyResources();
+        const bool reloaded = measureReload(client, output);
+        reportOutput(output);
+        return reloaded ? 0 : 1;
+    }
+
+    // time to first frame is measured from here
+    const Clock::time_point viewerStarted = Clock::now();
+
     // Create a renderer for visualization
-    // TODO: make renderer optional
     ramses::RendererConfig rendererConfig(argc, argv);
     ramses::RamsesRenderer renderer(framework, rendererConfig);
+    if (options.frameRate > 0.0f)
+        renderer.setMaximumFramerate(options.frameRate);
     renderer.startThread();
 
     ramses::DisplayConfig displayConfig;
-    uint32_t screenWidth = 1280U;
-    uint32_t screenHeight = 480U;
-    displayConfig.setWindowRectangle(0, 0, screenWidth, screenHeight);
+    displayConfig.setWindowRectangle(0, 0, ScreenWidth, ScreenHeight);
     //displayConfig.setPerspectiveProjection(19.f, 1200U/480U, 0.1f, 1500.f);
     const ramses::displayId_t display = renderer.createDisplay(displayConfig);
 
     framework.connect();
 
-    // TODO make scene id and name configurable over cmd line
-    ramses::sceneId_t sceneId = 123u;
-    const char* sceneName = "The Scene";
     ramses::SceneConfig sceneConfig;
-    ramses::Scene* scene = client.createScene(sceneId, sceneConfig, sceneName);
-
-    obj2ramses::ObjImporter objImporter(client, *scene);
-    objImporter.importFromFile("res/suzanne.obj");
-
-    // every scene needs a render pass with camera
-    const char* CAMERA_NAME = "Default Camera";
+    ramses::Scene* scene = client.createScene(SceneId, sceneConfig, SceneName);
 
-    ramses::PerspectiveCamera* camera = scene->createPerspectiveCamera(CAMERA_NAME);
-    camera->setFrustum(19.f, static_cast<float>(screenWidth)/screenHeight, 0.1f, 1500.f);
-    camera->setViewport(0U, 0U, screenWidth, screenHeight);
-    ramses::RenderPass* renderPass = scene->createRenderPass("my render pass");
-    renderPass->setClearFlags(ramses::EClearFlags_None);
-    renderPass->setCamera(*camera);
-    camera->setTranslation(0, 0, 5);
-
-    ramses::RenderGroup* renderGroup = objImporter.getRamsesRenderGroup();
-    renderPass->addRenderGroup(*renderGroup);
-
-    ramses::status_t status = client.validate();
-
-    if (ramses::StatusOK != status)
+    obj2ramses::ObjImporter objImporter(client, *scene, options.importOptions);
+    if (!objImporter.importFromFile(inputFile))
     {
-        std::cout << "Validation test for imported scene failed: " << client.getValidationReport(ramses::EValidationSeverity_Info);
+        std::cerr << "Importing " << inputFile << " failed" << std::endl;
         return 1;
     }
 
-    // TODO make configurable
-    obj2ramses::SceneToText sceneToText(true);
-    std::ostringstream outputStream;
-    sceneToText.printToStream(*scene, client, outputStream);
-    std::cout << outputStream.str();
+    ramses::PerspectiveCamera* camera = setupScene(*scene, objImporter);
+    if (nullptr == camera || !printScene(client, *scene, objImporter, options))
+        return 1;
+    // the viewer shows scenes over budget anyway, to find out what is too big
+    checkMemoryBudget(objImporter, options, inputFile);
 
-    scene->publish();
-    scene->flush();
+    {
+        obj2ramses::ScopedTimer timer("scene.publish");
+        scene->publish();
+    }
+    {
+        obj2ramses::ScopedTimer timer("scene.flush");
+        scene->flush();
+    }
 
     // Needed for visual debugging tools
     renderer.setSkippingOfUnmodifiedBuffers(false);
 
     obj2ramses::SceneStateEventHandler eventHandler(renderer, *camera);
+    // both are rebuilt when the file is reloaded
+    std::unique_ptr<obj2ramses::LodSwitcher> lodSwitcher(new obj2ramses::LodSwitcher(objImporter.getMeshes()));
+    std::unique_ptr<obj2ramses::FrustumCuller> culler(new obj2ramses::FrustumCuller(objImporter.getMeshes(), objImporter.getMeshNodes()));
+    size_t lodSwitches = 0;
+    obj2ramses::CullStatistics lastCullStatistics;
 
-    eventHandler.waitForPublication(sceneId);
+    {
+        obj2ramses::ScopedTimer timer("renderer.waitForPublication");
+        eventHandler.waitForPublication(SceneId);
+    }
 
-    renderer.subscribeScene(sceneId);
-    renderer.flush();
-    eventHandler.waitForSubscription(sceneId);
+    {
+        obj2ramses::ScopedTimer timer("renderer.subscribe");
+        renderer.subscribeScene(SceneId);
+        renderer.flush();
+        eventHandler.waitForSubscription(SceneId);
+    }
 
-    renderer.mapScene(display, sceneId);
-    renderer.flush();
-    eventHandler.waitForMapped(sceneId);
+    {
+        obj2ramses::ScopedTimer timer("renderer.map");
+        renderer.mapScene(display, SceneId);
+        renderer.flush();
+        eventHandler.waitForMapped(SceneId);
+    }
 
-    renderer.showScene(sceneId);
-    renderer.flush();
+    {
+        obj2ramses::ScopedTimer timer("renderer.show");
+        renderer.showScene(SceneId);
+        renderer.flush();
+        eventHandler.waitForShown(SceneId);
+    }
+    reportStartupTimes(eventHandler.getStartupTimes(), viewerStarted);
 
+    std::unique_ptr<obj2ramses::FileWatcher> watcher;
+    if (options.watch)
+    {
+        watcher.reset(new obj2ramses::FileWatcher(inputFile));
+        std::cout << "Watching " << inputFile << " for changes" << std::endl;
+    }
+
+    // the file is imported again on a background thread, the scene is only touched between two frames
+    obj2ramses::ImportOptions reloadOptions = options.importOptions;
+    reloadOptions.loadMaterials = false;
+    // the editor may truncate the file while it is parsed, a mapping would then raise SIGBUS
+    reloadOptions.mapFile = false;
+    std::unique_ptr<obj2ramses::ObjImporter> reloadedImporter;
+    std::future<bool> reloadImported;
+    Clock::time_point reloadDetected;
+    bool reloadPending = false;
+    size_t reloadCount = 0;
+
+    obj2ramses::FramePacer framePacer(options.frameRate);
+    FlushStatistics flushStatistics;
+    const Clock::time_point loopStarted = Clock::now();
     while (!eventHandler.windowWasClosed())
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(15));
+        framePacer.waitForNextFrame();
+        flushStatistics.addFrame();
+
+        // all input of the frame moves the camera once
         renderer.dispatchEvents(eventHandler);
-        scene->flush();
+        const size_t transformChanges = eventHandler.applyCameraInput();
+
+        // a save during a running import is picked up once that import is done
+        if (watcher && !reloadImported.valid() && (watcher->poll() || reloadPending))
+        {
+            reloadPending = false;
+            reloadDetected = Clock::now();
+            reloadedImporter.reset(new obj2ramses::ObjImporter(client, *scene, reloadOptions));
+            obj2ramses::ObjImporter& importer = *reloadedImporter;
+            reloadImported = std::async(std::launch::async, [&importer, &inputFile]() { return importer.importFromFile(inputFile); });
+        }
+        else if (watcher && reloadImported.valid() && watcher->poll())
+        {
+            reloadPending = true;
+        }
+
+        bool reloaded = false;
+        obj2ramses::ReloadStatistics reloadStatistics;
+        double reloadImportMs = 0.0;
+        Clock::time_point reloadUpdateStarted;
+        if (reloadImported.valid() && std::future_status::ready == reloadImported.wait_for(std::chrono::seconds(0)))
+        {
+            reloadUpdateStarted = Clock::now();
+            reloadImportMs = getMilliseconds(reloadUpdateStarted - reloadDetected);
+            const bool imported = reloadImported.get();
+            if (imported && reloadedImporter->getMeshes().empty())
+            {
+                // e.g. read between an editor truncating the file and writing it
+                std::cerr << "Reloading " << inputFile << " gave no meshes, keeping the previous version" << std::endl;
+            }
+            else if (imported)
+            {
+                reloadStatistics = objImporter.reload(*reloadedImporter);
+                lodSwitcher.reset(new obj2ramses::LodSwitcher(objImporter.getMeshes()));
+                culler.reset(new obj2ramses::FrustumCuller(objImporter.getMeshes(), objImporter.getMeshNodes()));
+                lastCullStatistics = obj2ramses::CullStatistics();
+                reloaded = true;
+                ++reloadCount;
+            }
+            else
+            {
+                std::cerr << "Reloading " << inputFile << " failed, keeping the previous version" << std::endl;
+            }
+            reloadedImporter.reset();
+        }
+
+        const size_t switchedMeshes = lodSwitcher->update(*camera);
+        lodSwitches += switchedMeshes;
+
+        obj2ramses::ScopedTimer cullTimer("viewer.cull");
+        const bool culled = culler->update(*camera, *lodSwitcher, 0 != switchedMeshes);
+        cullTimer.stop();
+        const obj2ramses::CullStatistics& cullStatistics = culler->getStatistics();
+        if (culled && (cullStatistics.visibleMeshes != lastCullStatistics.visibleMeshes || cullStatistics.culledMeshes != lastCullStatistics.culledMeshes))
+        {
+            std::cout << "Culling: " << cullStatistics.visibleMeshes << " visible, " << cullStatistics.culledMeshes << " culled mesh(es) in "
+                      << cullStatistics.milliseconds << " ms" << std::endl;
+            lastCullStatistics = cullStatistics;
+        }
+
+        // every flush is a transaction the renderer has to apply, only send one if something changed
+        const size_t visibilityChanges = culled ? cullStatistics.changedMeshes : 0u;
+        if (0 != transformChanges || 0 != visibilityChanges || reloaded)
+        {
+            scene->flush();
+            flushStatistics.addFlush(transformChanges, visibilityChanges);
+        }
+
+        if (reloaded)
+        {
+            const Clock::time_point flushed = Clock::now();
+            std::cout << std::fixed << std::setprecision(1) << "Reloaded " << inputFile << " in " << getMilliseconds(flushed - reloadDetected)
+                      << " ms (import " << reloadImportMs << " ms, scene update " << getMilliseconds(flushed - reloadUpdateStarted) << " ms): "
+                      << reloadStatistics.keptMeshes << " mesh(es) kept, " << reloadStatistics.createdMeshes << " created, "
+                      << reloadStatistics.removedMeshes << " removed, " << reloadStatistics.createdArrays << " array(s) created, "
+                      << reloadStatistics.destroyedArrays << " destroyed" << std::endl;
+        }
     }
 
+    flushStatistics.report(getMilliseconds(Clock::now() - loopStarted), eventHandler.getInputEventCount());
+    if (lodSwitcher->hasLevels())
+        obj2ramses::Profiler::Get().addCounter("viewer.lodSwitches", lodSwitches);
+    if (watcher)
+        obj2ramses::Profiler::Get().addCounter("viewer.reloads", reloadCount);
+    obj2ramses::Profiler::Get().addCounter("viewer.lateFrames", framePacer.getLateFrameCount());
+
     return 0;
 }
@@ -0,0 +1,74 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "Test.h"
+#include "MemoryArena.h"
+
+#include <cstdint>
+
+using namespace obj2ramses;
+
+TEST(MemoryArena_AlignsAllocations)
+{
+    MemoryArena arena(256u);
+    for (size_t alignment : { 1u, 2u, 4u, 8u, 16u })
+    {
+        arena.allocate(3u, 1u);
+        const uintptr_t address = reinterpret_cast<uintptr_t>(arena.allocate(8u, alignment));
+        EXPECT_EQ(address % alignment, 0u);
+    }
+}
+
+TEST(MemoryArena_TakesBackTheLastAllocationOnly)
+{
+    MemoryArena arena(256u);
+    void* first = arena.allocate(16u, 8u);
+    void* second = arena.allocate(16u, 8u);
+    EXPECT_EQ(arena.getUsedBytes(), 32u);
+
+    // not the most recent one, stays until reset
+    arena.deallocate(first, 16u);
+    EXPECT_EQ(arena.getUsedBytes(), 32u);
+
+    arena.deallocate(second, 16u);
+    EXPECT_EQ(arena.getUsedBytes(), 16u);
+    // the space is handed out again
+    EXPECT_TRUE(arena.allocate(16u, 8u) == second);
+}
+
+TEST(MemoryArena_GivesLargeAllocationsABlockOfTheirOwn)
+{
+    MemoryArena arena(256u);
+    arena.allocate(16u, 8u);
+    arena.allocate(1000u, 8u);
+    EXPECT_EQ(arena.getUsedBytes(), 1016u);
+    EXPECT_TRUE(arena.getCapacity() >= 1256u);
+}
+
+TEST(MemoryArena_KeepsOneBlockOfThePreviousSizeAfterReset)
+{
+    MemoryArena arena(256u);
+    for (size_t i = 0; i < 10; ++i)
+        arena.allocate(100u, 8u);
+    EXPECT_TRUE(arena.getCapacity() > 256u);
+
+    arena.reset();
+    EXPECT_EQ(arena.getUsedBytes(), 0u);
+
+    // the first block of the next import holds everything the previous one needed
+    arena.allocate(1u, 1u);
+    const size_t capacity = arena.getCapacity();
+    EXPECT_TRUE(capacity >= 1000u);
+    for (size_t i = 0; i < 9; ++i)
+        arena.allocate(100u, 8u);
+    EXPECT_EQ(arena.getCapacity(), capacity);
+
+    arena.release();
+    EXPECT_EQ(arena.getCapacity(), 0u);
+    EXPECT_EQ(arena.getUsedBytes(), 0u);
+}
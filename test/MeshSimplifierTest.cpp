@@ -0,0 +1,229 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "Test.h"
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace obj2ramses;
+
+namespace
+{
+    unsigned addVertex(ObjGeometry::indexed_mesh& mesh, float x, float y, float z)
+    {
+        mesh.positions.push_back(x);
+        mesh.positions.push_back(y);
+        mesh.positions.push_back(z);
+        return static_cast<unsigned>(mesh.vertex_count() - 1);
+    }
+
+    /* closed sphere around the origin with outward facing triangles, radius bumpy if requested */
+    ObjGeometry::indexed_mesh createSphere(unsigned subdivisions, bool bumpy)
+    {
+        ObjGeometry::indexed_mesh mesh;
+        const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+        const float icosahedron[12][3] = {
+            { -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 },
+            { 0, -1, t }, { 0, 1, t }, { 0, -1, -t }, { 0, 1, -t },
+            { t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 } };
+        for (const auto& vertex : icosahedron)
+            addVertex(mesh, vertex[0], vertex[1], vertex[2]);
+        mesh.indices = {
+            0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+            3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1 };
+
+        for (unsigned level = 0; level < subdivisions; ++level)
+        {
+            std::map<std::pair<unsigned, unsigned>, unsigned> midpoints;
+            auto getMidpoint = [&](unsigned a, unsigned b)
+            {
+                const auto key = std::make_pair(std::min(a, b), std::max(a, b));
+                auto found = midpoints.find(key);
+                if (found != midpoints.end())
+                    return found->second;
+                const float* p = &mesh.positions[3 * a];
+                const float* q = &mesh.positions[3 * b];
+                const unsigned vertex = addVertex(mesh, (p[0] + q[0]) / 2, (p[1] + q[1]) / 2, (p[2] + q[2]) / 2);
+                midpoints[key] = vertex;
+                return vertex;
+            };
+
+            std::vector<unsigned> indices;
+            for (size_t i = 0; i < mesh.indices.size(); i += 3)
+            {
+                const unsigned a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+                const unsigned ab = getMidpoint(a, b), bc = getMidpoint(b, c), ca = getMidpoint(c, a);
+                indices.insert(indices.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+            }
+            mesh.indices.swap(indices);
+        }
+
+        for (size_t vertex = 0; vertex < mesh.vertex_count(); ++vertex)
+        {
+            float* p = &mesh.positions[3 * vertex];
+            const float length = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            const float radius = bumpy ? 1.0f + 0.05f * std::sin(7.0f * p[0] / length) * std::sin(5.0f * p[1] / length) : 1.0f;
+            for (size_t k = 0; k < 3; ++k)
+                p[k] *= radius / length;
+        }
+        return mesh;
+    }
+
+    /* square grid in the z = 0 plane facing +z, corners 0 to size */
+    ObjGeometry::indexed_mesh createGrid(unsigned size)
+    {
+        ObjGeometry::indexed_mesh mesh;
+        for (unsigned y = 0; y <= size; ++y)
+            for (unsigned x = 0; x <= size; ++x)
+                addVertex(mesh, static_cast<float>(x), static_cast<float>(y), 0.0f);
+
+        for (unsigned y = 0; y < size; ++y)
+        {
+            for (unsigned x = 0; x < size; ++x)
+            {
+                const unsigned a = y * (size + 1) + x;
+                const unsigned b = a + 1;
+                const unsigned c = a + size + 2;
+                const unsigned d = a + size + 1;
+                mesh.indices.insert(mesh.indices.end(), { a, b, c, a, c, d });
+            }
+        }
+        return mesh;
+    }
+
+    std::array<float, 3> getNormal(const ObjGeometry::indexed_mesh& mesh, size_t triangle)
+    {
+        const float* a = &mesh.positions[3 * mesh.indices[3 * triangle]];
+        const float* b = &mesh.positions[3 * mesh.indices[3 * triangle + 1]];
+        const float* c = &mesh.positions[3 * mesh.indices[3 * triangle + 2]];
+        const float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        const float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        return {{ ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] }};
+    }
+
+    /* triangles using a vertex twice or the same vertices as another triangle */
+    size_t countDegenerateOrDuplicateTriangles(const ObjGeometry::indexed_mesh& mesh)
+    {
+        size_t count = 0;
+        std::set<std::array<unsigned, 3>> triangles;
+        for (size_t i = 0; i < mesh.indices.size(); i += 3)
+        {
+            std::array<unsigned, 3> corners = {{ mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2] }};
+            std::sort(corners.begin(), corners.end());
+            if (corners[0] == corners[1] || corners[1] == corners[2] || !triangles.insert(corners).second)
+                ++count;
+        }
+        return count;
+    }
+
+    /* edges not shared by exactly two triangles, a closed surface has none */
+    size_t countOpenEdges(const ObjGeometry::indexed_mesh& mesh)
+    {
+        std::map<std::pair<unsigned, unsigned>, size_t> edgeTriangles;
+        for (size_t i = 0; i < mesh.indices.size(); i += 3)
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const unsigned a = mesh.indices[i + corner];
+                const unsigned b = mesh.indices[i + (corner + 1) % 3];
+                ++edgeTriangles[std::make_pair(std::min(a, b), std::max(a, b))];
+            }
+
+        size_t count = 0;
+        for (const auto& edge : edgeTriangles)
+            if (2 != edge.second)
+                ++count;
+        return count;
+    }
+
+    /* triangles of a mesh around the origin which face inwards */
+    size_t countInvertedTriangles(const ObjGeometry::indexed_mesh& mesh)
+    {
+        size_t count = 0;
+        for (size_t triangle = 0; triangle < mesh.indices.size() / 3; ++triangle)
+        {
+            const std::array<float, 3> normal = getNormal(mesh, triangle);
+            float centroid[3] = { 0.0f, 0.0f, 0.0f };
+            for (size_t corner = 0; corner < 3; ++corner)
+                for (size_t k = 0; k < 3; ++k)
+                    centroid[k] += mesh.positions[3 * mesh.indices[3 * triangle + corner] + k];
+            if (normal[0] * centroid[0] + normal[1] * centroid[1] + normal[2] * centroid[2] <= 0.0f)
+                ++count;
+        }
+        return count;
+    }
+}
+
+TEST(MeshSimplifier_KeepsSphereClosedAndOriented)
+{
+    for (bool bumpy : { false, true })
+    {
+        const ObjGeometry::indexed_mesh sphere = createSphere(5, bumpy);
+        EXPECT_EQ(countInvertedTriangles(sphere), 0u);
+
+        MeshSimplifier simplifier;
+        ObjGeometry::indexed_mesh out;
+        const size_t targetTriangles = sphere.indices.size() / 3 / 10;
+        const SimplifyStatistics statistics = simplifier.simplify(sphere, targetTriangles, 1.0f, out);
+
+        EXPECT_TRUE(statistics.triangleCount <= targetTriangles);
+        EXPECT_EQ(statistics.triangleCount, out.indices.size() / 3);
+        EXPECT_EQ(countDegenerateOrDuplicateTriangles(out), 0u);
+        EXPECT_EQ(countOpenEdges(out), 0u);
+        EXPECT_EQ(countInvertedTriangles(out), 0u);
+    }
+}
+
+TEST(MeshSimplifier_KeepsSphereValidDownToFewTriangles)
+{
+    const ObjGeometry::indexed_mesh sphere = createSphere(3, true);
+
+    MeshSimplifier simplifier;
+    ObjGeometry::indexed_mesh out;
+    simplifier.simplify(sphere, 1u, 1.0f, out);
+
+    EXPECT_TRUE(out.indices.size() / 3 >= 4u);
+    EXPECT_EQ(countDegenerateOrDuplicateTriangles(out), 0u);
+    EXPECT_EQ(countOpenEdges(out), 0u);
+    EXPECT_EQ(countInvertedTriangles(out), 0u);
+}
+
+TEST(MeshSimplifier_CollapsesFlatGridWithoutError)
+{
+    const ObjGeometry::indexed_mesh grid = createGrid(32);
+
+    MeshSimplifier simplifier;
+    ObjGeometry::indexed_mesh out;
+    const SimplifyStatistics statistics = simplifier.simplify(grid, 1u, 0.0f, out);
+
+    // the border vertices stay, the inside can be collapsed away without any error
+    EXPECT_TRUE(statistics.triangleCount < grid.indices.size() / 3 / 4);
+    EXPECT_EQ(statistics.error, 0.0f);
+    EXPECT_EQ(countDegenerateOrDuplicateTriangles(out), 0u);
+    for (size_t triangle = 0; triangle < out.indices.size() / 3; ++triangle)
+        EXPECT_TRUE(getNormal(out, triangle)[2] > 0.0f);
+}
+
+TEST(MeshSimplifier_StopsAtErrorLimit)
+{
+    const ObjGeometry::indexed_mesh sphere = createSphere(4, false);
+
+    MeshSimplifier simplifier;
+    ObjGeometry::indexed_mesh out;
+    const SimplifyStatistics statistics = simplifier.simplify(sphere, 1u, 0.01f, out);
+
+    EXPECT_TRUE(statistics.error <= 0.01f);
+    EXPECT_TRUE(statistics.triangleCount > 100u);
+    EXPECT_EQ(countInvertedTriangles(out), 0u);
+}
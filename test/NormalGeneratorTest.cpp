@@ -0,0 +1,117 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "Test.h"
+#include "NormalGenerator.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace obj2ramses;
+using ObjGeometry::invalid_index;
+
+namespace
+{
+    void addFace(ObjGeometry::mesh_data& mesh, const std::vector<unsigned>& vertices)
+    {
+        for (unsigned vertex : vertices)
+        {
+            mesh.faces.v.push_back(vertex);
+            mesh.faces.vt.push_back(invalid_index);
+            mesh.faces.vn.push_back(invalid_index);
+        }
+        mesh.faces.add_face();
+    }
+
+    /* unit cube with outward facing quads */
+    ObjGeometry::mesh_data createCube()
+    {
+        ObjGeometry::mesh_data mesh;
+        for (unsigned i = 0; i < 8; ++i)
+            mesh.vertices.push_back({ static_cast<float>(i & 1u), static_cast<float>((i >> 1) & 1u), static_cast<float>((i >> 2) & 1u) });
+        addFace(mesh, { 0, 2, 3, 1 });
+        addFace(mesh, { 4, 5, 7, 6 });
+        addFace(mesh, { 0, 1, 5, 4 });
+        addFace(mesh, { 2, 6, 7, 3 });
+        addFace(mesh, { 0, 4, 6, 2 });
+        addFace(mesh, { 1, 3, 7, 5 });
+        return mesh;
+    }
+
+    bool isNear(const ObjGeometry::vertex_normal_3f& normal, float x, float y, float z)
+    {
+        const float Tolerance = 1e-5f;
+        return std::fabs(normal.x - x) < Tolerance && std::fabs(normal.y - y) < Tolerance && std::fabs(normal.z - z) < Tolerance;
+    }
+}
+
+TEST(NormalGenerator_SmoothsAllFacesWithoutCreaseAngle)
+{
+    ObjGeometry::mesh_data mesh = createCube();
+    NormalGenerator generator(ENormalWeighting_Area, 180.0f, 1u);
+    const NormalStatistics statistics = generator.generate(mesh);
+
+    EXPECT_EQ(statistics.vertexCount, 8u);
+    EXPECT_EQ(statistics.normalCount, 8u);
+    // every corner gets the diagonal of the cube through its position
+    const float d = 1.0f / std::sqrt(3.0f);
+    for (size_t corner = 0; corner < mesh.faces.corner_count(); ++corner)
+    {
+        const ObjGeometry::vertex3f& position = mesh.vertices[mesh.faces.v[corner]];
+        const ObjGeometry::vertex_normal_3f& normal = mesh.normals[mesh.faces.vn[corner]];
+        EXPECT_TRUE(isNear(normal, (2.0f * position.x - 1.0f) * d, (2.0f * position.y - 1.0f) * d, (2.0f * position.z - 1.0f) * d));
+    }
+}
+
+TEST(NormalGenerator_KeepsEdgesAboveCreaseAngleSharp)
+{
+    ObjGeometry::mesh_data mesh = createCube();
+    NormalGenerator generator(ENormalWeighting_Angle, 60.0f, 1u);
+    const NormalStatistics statistics = generator.generate(mesh);
+
+    // the faces meet at 90 degrees, each corner keeps the normal of its own face
+    EXPECT_EQ(statistics.normalCount, 24u);
+    for (size_t face = 0; face < mesh.faces.size(); ++face)
+    {
+        const ObjGeometry::vertex_normal_3f& first = mesh.normals[mesh.faces.vn[mesh.faces.offsets[face]]];
+        EXPECT_TRUE(std::fabs(first.x) + std::fabs(first.y) + std::fabs(first.z) > 0.99999f);
+        for (unsigned corner = mesh.faces.offsets[face]; corner < mesh.faces.offsets[face + 1]; ++corner)
+            EXPECT_TRUE(isNear(mesh.normals[mesh.faces.vn[corner]], first.x, first.y, first.z));
+    }
+}
+
+TEST(NormalGenerator_GivesTheSameResultOnAnyNumberOfThreads)
+{
+    // a bumpy grid with enough positions to be split across the threads
+    const unsigned size = 64;
+    ObjGeometry::mesh_data single;
+    for (unsigned y = 0; y <= size; ++y)
+        for (unsigned x = 0; x <= size; ++x)
+            single.vertices.push_back({ static_cast<float>(x), static_cast<float>(y), std::sin(0.3f * x) * std::cos(0.2f * y) });
+    for (unsigned y = 0; y < size; ++y)
+        for (unsigned x = 0; x < size; ++x)
+        {
+            const unsigned a = y * (size + 1) + x;
+            addFace(single, { a, a + 1, a + size + 2 });
+            addFace(single, { a, a + size + 2, a + size + 1 });
+        }
+    ObjGeometry::mesh_data threaded = single;
+
+    NormalGenerator(ENormalWeighting_Angle, 30.0f, 1u).generate(single);
+    NormalGenerator(ENormalWeighting_Angle, 30.0f, 4u).generate(threaded);
+
+    EXPECT_EQ(single.normals.size(), threaded.normals.size());
+    bool equal = single.faces.corner_count() == threaded.faces.corner_count();
+    for (size_t corner = 0; equal && corner < single.faces.corner_count(); ++corner)
+    {
+        const ObjGeometry::vertex_normal_3f& a = single.normals[single.faces.vn[corner]];
+        const ObjGeometry::vertex_normal_3f& b = threaded.normals[threaded.faces.vn[corner]];
+        equal = a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+    EXPECT_TRUE(equal);
+}
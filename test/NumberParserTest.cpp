@@ -0,0 +1,165 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "Test.h"
+#include "NumberParser.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+using namespace obj2ramses;
+
+namespace
+{
+    ParseResult parseFloat(const std::string& text, float& value)
+    {
+        return NumberParser::parseFloat(text.data(), text.data() + text.size(), value);
+    }
+
+    /* parses text completely and compares the bits with strtof, which the parser replaced */
+    bool matchesStrtof(const std::string& text)
+    {
+        float value = 0.0f;
+        const ParseResult result = parseFloat(text, value);
+        const float expected = std::strtof(text.c_str(), nullptr);
+        return EParseError_None == result.error && text.data() + text.size() == result.ptr && 0 == std::memcmp(&value, &expected, sizeof(value));
+    }
+}
+
+TEST(NumberParser_ParsesSimpleFloats)
+{
+    float value = 0.0f;
+    EXPECT_EQ(parseFloat("1.5", value).error, EParseError_None);
+    EXPECT_EQ(value, 1.5f);
+    EXPECT_EQ(parseFloat("-0.25", value).error, EParseError_None);
+    EXPECT_EQ(value, -0.25f);
+    EXPECT_EQ(parseFloat("+3e2", value).error, EParseError_None);
+    EXPECT_EQ(value, 300.0f);
+    EXPECT_EQ(parseFloat(".5", value).error, EParseError_None);
+    EXPECT_EQ(value, 0.5f);
+    EXPECT_EQ(parseFloat("7.", value).error, EParseError_None);
+    EXPECT_EQ(value, 7.0f);
+}
+
+TEST(NumberParser_StopsAfterTheNumber)
+{
+    const std::string text = "1.5abc";
+    float value = 0.0f;
+    const ParseResult result = parseFloat(text, value);
+    EXPECT_EQ(result.error, EParseError_None);
+    EXPECT_EQ(result.ptr - text.data(), 3);
+
+    // an exponent without digits does not belong to the number
+    const std::string withoutExponent = "2e+";
+    EXPECT_EQ(parseFloat(withoutExponent, value).ptr - withoutExponent.data(), 1);
+    EXPECT_EQ(value, 2.0f);
+}
+
+TEST(NumberParser_RejectsTextWithoutNumber)
+{
+    float value = 42.0f;
+    for (const char* text : { "", " 1", "-", ".", "e5", "abc" })
+    {
+        const std::string input(text);
+        const ParseResult result = parseFloat(input, value);
+        EXPECT_EQ(result.error, EParseError_InvalidArgument);
+        EXPECT_TRUE(input.data() == result.ptr);
+    }
+    EXPECT_EQ(value, 42.0f);
+}
+
+TEST(NumberParser_ParsesSpecialValues)
+{
+    float value = 0.0f;
+    EXPECT_EQ(parseFloat("inf", value).error, EParseError_None);
+    EXPECT_TRUE(std::isinf(value) && value > 0.0f);
+    EXPECT_EQ(parseFloat("-Infinity", value).error, EParseError_None);
+    EXPECT_TRUE(std::isinf(value) && value < 0.0f);
+    EXPECT_EQ(parseFloat("NaN", value).error, EParseError_None);
+    EXPECT_TRUE(std::isnan(value));
+    EXPECT_EQ(parseFloat("-0", value).error, EParseError_None);
+    EXPECT_TRUE(0.0f == value && std::signbit(value));
+}
+
+TEST(NumberParser_OutOfRangeFloatsBehaveLikeStrtof)
+{
+    for (const char* text : { "1e39", "-1e39", "3.5e38", "1e400", "1e-50", "-1e-50", "1e-40", "1.17549435e-38", "3.40282357e38",
+                              "123456789012345678901234567890e20", "0.000000000000000000000000000000000000000000000001" })
+        EXPECT_TRUE(matchesStrtof(text));
+}
+
+TEST(NumberParser_RoundsLikeStrtof)
+{
+    // the fast path and the slow path near their boundaries, and halfway cases between two floats
+    for (const char* text : { "0.1", "16777217", "16777216.5", "9007199254740993", "1e22", "1e23", "1e-22", "1e-23",
+                              "1234567890123456789", "12345678901234567890", "0.30000001192092896", "3.4028235e38",
+                              "1.00000005960464477539062500000000001", "33554431", "4.9406564584124654e-324" })
+        EXPECT_TRUE(matchesStrtof(text));
+
+    // random numbers of different lengths and exponents, always the same sequence
+    std::mt19937 random(12345u);
+    std::uniform_int_distribution<int> digitCount(1, 25);
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::uniform_int_distribution<int> exponent(-45, 39);
+    size_t mismatches = 0;
+    for (int i = 0; i < 20000; ++i)
+    {
+        std::string text = (0 == i % 2) ? "-" : "";
+        const int digits = digitCount(random);
+        const int point = digitCount(random) % (digits + 1);
+        for (int d = 0; d < digits; ++d)
+        {
+            if (d == point)
+                text += '.';
+            text += static_cast<char>('0' + digit(random));
+        }
+        if (0 == i % 3)
+            text += "e" + std::to_string(exponent(random));
+
+        if (!matchesStrtof(text))
+            ++mismatches;
+    }
+    EXPECT_EQ(mismatches, 0u);
+}
+
+TEST(NumberParser_ParsesUnsigned)
+{
+    const std::string text = "4294967295/";
+    uint32_t value = 0;
+    const ParseResult result = NumberParser::parseUnsigned(text.data(), text.data() + text.size(), value);
+    EXPECT_EQ(result.error, EParseError_None);
+    EXPECT_EQ(value, 4294967295u);
+    EXPECT_EQ(result.ptr - text.data(), 10);
+
+    const std::string tooLarge = "4294967296";
+    value = 7u;
+    EXPECT_EQ(NumberParser::parseUnsigned(tooLarge.data(), tooLarge.data() + tooLarge.size(), value).error, EParseError_OutOfRange);
+    EXPECT_EQ(value, 7u);
+
+    const std::string negative = "-1";
+    EXPECT_EQ(NumberParser::parseUnsigned(negative.data(), negative.data() + negative.size(), value).error, EParseError_InvalidArgument);
+}
+
+TEST(NumberParser_ScansDigitRunsOfAnyLength)
+{
+    // runs shorter and longer than the 16 byte blocks, ending at every position of a block
+    for (size_t length = 0; length < 40; ++length)
+    {
+        const std::string text = std::string(length, '7') + " 1";
+        EXPECT_EQ(NumberParser::scanDigits(text.data(), text.data() + text.size()), length);
+        EXPECT_EQ(NumberParser::scanDigits(text.data(), text.data() + length), length);
+    }
+    // bytes which only differ from digits in the upper bits
+    const std::string text = "12\xb3" "4";
+    EXPECT_EQ(NumberParser::scanDigits(text.data(), text.data() + text.size()), 2u);
+}
@@ -0,0 +1,59 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#ifndef OBJ2RAMSES_TEST
+#define OBJ2RAMSES_TEST
+
+#include <sstream>
+#include <string>
+
+namespace obj2ramses
+{
+    /**
+     * @brief Minimal test registry, so the tests need nothing besides the core library.
+     *
+     * TEST(name) defines a test case which registers itself before main runs. Failed
+     * expectations are reported with file and line and let the test executable fail, the
+     * test case continues after them.
+     */
+    namespace Test
+    {
+        typedef void (*TestFunction)();
+
+        struct Registration
+        {
+            Registration(const char* name, TestFunction function);
+        };
+
+        void fail(const char* file, int line, const std::string& message);
+
+        template <typename A, typename B>
+        void expectEqual(const A& actual, const B& expected, const char* expression, const char* file, int line)
+        {
+            if (actual == expected)
+                return;
+
+            std::ostringstream message;
+            message << expression << ": " << actual << " != " << expected;
+            fail(file, line, message.str());
+        }
+    }
+}
+
+#define TEST(name) \
+    static void name(); \
+    static const obj2ramses::Test::Registration name##Registration(#name, &name); \
+    static void name()
+
+#define EXPECT_TRUE(condition) \
+    do { if (!(condition)) obj2ramses::Test::fail(__FILE__, __LINE__, #condition); } while (false)
+
+#define EXPECT_EQ(actual, expected) \
+    obj2ramses::Test::expectEqual((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,70 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "Test.h"
+
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace obj2ramses
+{
+    namespace Test
+    {
+        namespace
+        {
+            std::vector<std::pair<const char*, TestFunction>>& getTests()
+            {
+                // constructed on first use, the registrations run during static initialization
+                static std::vector<std::pair<const char*, TestFunction>> tests;
+                return tests;
+            }
+
+            size_t FailureCount = 0;
+        }
+
+        Registration::Registration(const char* name, TestFunction function)
+        {
+            getTests().push_back(std::make_pair(name, function));
+        }
+
+        void fail(const char* file, int line, const std::string& message)
+        {
+            ++FailureCount;
+            std::cerr << file << ":" << line << ": " << message << std::endl;
+        }
+    }
+}
+
+/* runs all tests, or only those whose name contains the first argument */
+int main(int argc, char* argv[])
+{
+    using namespace obj2ramses::Test;
+    const char* filter = (argc > 1) ? argv[1] : "";
+
+    size_t failedTests = 0;
+    size_t runTests = 0;
+    for (const auto& test : getTests())
+    {
+        if (nullptr == std::strstr(test.first, filter))
+            continue;
+
+        const size_t failuresBefore = FailureCount;
+        test.second();
+        ++runTests;
+
+        const bool passed = FailureCount == failuresBefore;
+        if (!passed)
+            ++failedTests;
+        std::cout << (passed ? "[  OK  ] " : "[FAILED] ") << test.first << std::endl;
+    }
+
+    std::cout << runTests - failedTests << " of " << runTests << " tests passed" << std::endl;
+    return 0 == failedTests ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+//  -------------------------------------------------------------------------
+//  Copyright (C) 2019 BMW AG
+//  -------------------------------------------------------------------------
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at https://mozilla.org/MPL/2.0/.
+//  -------------------------------------------------------------------------
+
+#include "Test.h"
+#include "VertexWelder.h"
+
+#include <set>
+#include <tuple>
+#include <vector>
+
+using namespace obj2ramses;
+using ObjGeometry::invalid_index;
+
+namespace
+{
+    /* corners as (v, vt, vn), vt and vn may be invalid_index */
+    typedef std::tuple<unsigned, unsigned, unsigned> Corner;
+
+    void addFace(ObjGeometry::mesh_data& mesh, const std::vector<Corner>& corners)
+    {
+        for (const auto& corner : corners)
+        {
+            mesh.faces.v.push_back(std::get<0>(corner));
+            mesh.faces.vt.push_back(std::get<1>(corner));
+            mesh.faces.vn.push_back(std::get<2>(corner));
+        }
+        mesh.faces.add_face();
+    }
+
+    /* positions (i, 2i, 3i), texture coordinates (i, -i) and normals (0, 0, i) */
+    ObjGeometry::mesh_data createAttributes(unsigned count)
+    {
+        ObjGeometry::mesh_data mesh;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            const float value = static_cast<float>(i);
+            mesh.vertices.push_back({ value, 2.0f * value, 3.0f * value });
+            ObjGeometry::tex_coord_3f texCoord;
+            texCoord.u = value;
+            texCoord.v = -value;
+            mesh.tex_coords.push_back(texCoord);
+            mesh.normals.push_back({ 0.0f, 0.0f, value });
+        }
+        return mesh;
+    }
+
+    std::vector<VertexWelder::FaceRange> allFaces(const ObjGeometry::mesh_data& mesh)
+    {
+        return { VertexWelder::FaceRange(0u, mesh.faces.size()) };
+    }
+
+    /* every triangle corner of out has the attributes of the corresponding OBJ corner */
+    bool matchesCorners(const ObjGeometry::indexed_mesh& out, const std::vector<Corner>& triangleCorners)
+    {
+        if (out.indices.size() != triangleCorners.size())
+            return false;
+
+        for (size_t i = 0; i < triangleCorners.size(); ++i)
+        {
+            const unsigned vertex = out.indices[i];
+            const float v = static_cast<float>(std::get<0>(triangleCorners[i]));
+            const unsigned vt = std::get<1>(triangleCorners[i]);
+            const unsigned vn = std::get<2>(triangleCorners[i]);
+            const float u = (invalid_index == vt) ? 0.0f : static_cast<float>(vt);
+            const float n = (invalid_index == vn) ? 0.0f : static_cast<float>(vn);
+            if (out.positions[3 * vertex] != v || out.positions[3 * vertex + 1] != 2.0f * v || out.positions[3 * vertex + 2] != 3.0f * v ||
+                out.tex_coords[2 * vertex] != u || out.tex_coords[2 * vertex + 1] != -u || out.normals[3 * vertex + 2] != n)
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST(VertexWelder_WeldsEqualTriplesOnly)
+{
+    ObjGeometry::mesh_data mesh = createAttributes(4);
+    addFace(mesh, { Corner(0, 0, 0), Corner(1, 1, 1), Corner(2, 2, 2) });
+    // shares the corner (0, 0, 0), but (2, 2, 3) differs from (2, 2, 2) in the normal only
+    addFace(mesh, { Corner(0, 0, 0), Corner(2, 2, 3), Corner(3, 3, 3) });
+
+    VertexWelder welder;
+    ObjGeometry::indexed_mesh out;
+    const WeldStatistics statistics = welder.weld(mesh, allFaces(mesh), out);
+
+    EXPECT_EQ(statistics.cornerCount, 6u);
+    EXPECT_EQ(statistics.vertexCount, 5u);
+    EXPECT_EQ(out.vertex_count(), 5u);
+    EXPECT_TRUE(matchesCorners(out, { Corner(0, 0, 0), Corner(1, 1, 1), Corner(2, 2, 2), Corner(0, 0, 0), Corner(2, 2, 3), Corner(3, 3, 3) }));
+}
+
+TEST(VertexWelder_TriangulatesPolygonsAsFans)
+{
+    ObjGeometry::mesh_data mesh = createAttributes(5);
+    addFace(mesh, { Corner(0, 0, 0), Corner(1, 1, 1), Corner(2, 2, 2), Corner(3, 3, 3), Corner(4, 4, 4) });
+
+    VertexWelder welder;
+    ObjGeometry::indexed_mesh out;
+    welder.weld(mesh, allFaces(mesh), out);
+
+    const std::vector<unsigned> expected = { 0, 1, 2, 0, 2, 3, 0, 3, 4 };
+    EXPECT_TRUE(expected == out.indices);
+}
+
+TEST(VertexWelder_FillsMissingAttributesWithZero)
+{
+    ObjGeometry::mesh_data mesh = createAttributes(3);
+    addFace(mesh, { Corner(0, invalid_index, 1), Corner(1, 1, invalid_index), Corner(2, 2, 2) });
+
+    VertexWelder welder;
+    ObjGeometry::indexed_mesh out;
+    welder.weld(mesh, allFaces(mesh), out);
+
+    EXPECT_TRUE(matchesCorners(out, { Corner(0, invalid_index, 1), Corner(1, 1, invalid_index), Corner(2, 2, 2) }));
+}
+
+TEST(VertexWelder_WeldsAcrossRangesOfOneSubMesh)
+{
+    // faces 0 and 2 belong to one sub-mesh and share an edge, face 1 belongs to another
+    ObjGeometry::mesh_data mesh = createAttributes(5);
+    addFace(mesh, { Corner(0, 0, 0), Corner(1, 1, 1), Corner(2, 2, 2) });
+    addFace(mesh, { Corner(3, 3, 3), Corner(4, 4, 4), Corner(0, 0, 0) });
+    addFace(mesh, { Corner(2, 2, 2), Corner(1, 1, 1), Corner(4, 4, 4) });
+
+    VertexWelder welder;
+    ObjGeometry::indexed_mesh out;
+    const WeldStatistics statistics = welder.weld(mesh, { VertexWelder::FaceRange(0u, 1u), VertexWelder::FaceRange(2u, 3u) }, out);
+
+    EXPECT_EQ(statistics.cornerCount, 6u);
+    EXPECT_EQ(out.vertex_count(), 4u);
+    EXPECT_TRUE(matchesCorners(out, { Corner(0, 0, 0), Corner(1, 1, 1), Corner(2, 2, 2), Corner(2, 2, 2), Corner(1, 1, 1), Corner(4, 4, 4) }));
+}
+
+TEST(VertexWelder_AppendsToExistingVertices)
+{
+    ObjGeometry::mesh_data mesh = createAttributes(3);
+    addFace(mesh, { Corner(0, 0, 0), Corner(1, 1, 1), Corner(2, 2, 2) });
+
+    VertexWelder welder;
+    ObjGeometry::indexed_mesh out;
+    welder.weld(mesh, allFaces(mesh), out);
+    // the welder is reused, its table must not remember the vertices of the first call
+    welder.weld(mesh, allFaces(mesh), out);
+
+    EXPECT_EQ(out.vertex_count(), 6u);
+    const std::vector<unsigned> expected = { 0, 1, 2, 3, 4, 5 };
+    EXPECT_TRUE(expected == out.indices);
+}
+
+TEST(VertexWelder_KeepsLargeMeshesIntact)
+{
+    // enough unique vertices to grow the table several times, in many small ranges
+    const unsigned gridSize = 100;
+    ObjGeometry::mesh_data mesh = createAttributes(gridSize * gridSize);
+    std::vector<VertexWelder::FaceRange> ranges;
+    std::vector<Corner> triangleCorners;
+    for (unsigned y = 0; y + 1 < gridSize; ++y)
+    {
+        for (unsigned x = 0; x + 1 < gridSize; ++x)
+        {
+            const unsigned a = y * gridSize + x;
+            const unsigned b = a + 1;
+            const unsigned c = a + gridSize + 1;
+            const unsigned d = a + gridSize;
+            ranges.push_back(VertexWelder::FaceRange(mesh.faces.size(), mesh.faces.size() + 1));
+            addFace(mesh, { Corner(a, a, a), Corner(b, b, b), Corner(c, c, c), Corner(d, d, d) });
+            for (unsigned corner : { a, b, c, a, c, d })
+                triangleCorners.push_back(Corner(corner, corner, corner));
+        }
+    }
+
+    VertexWelder welder;
+    ObjGeometry::indexed_mesh out;
+    const WeldStatistics statistics = welder.weld(mesh, ranges, out);
+
+    EXPECT_EQ(statistics.vertexCount, static_cast<size_t>(gridSize * gridSize));
+    EXPECT_EQ(out.vertex_count(), static_cast<size_t>(gridSize * gridSize));
+    EXPECT_TRUE(matchesCorners(out, triangleCorners));
+
+    // no position appears twice
+    std::set<float> positions;
+    for (size_t vertex = 0; vertex < out.vertex_count(); ++vertex)
+        positions.insert(out.positions[3 * vertex]);
+    EXPECT_EQ(positions.size(), out.vertex_count());
+}